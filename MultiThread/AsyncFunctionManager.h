@@ -2,78 +2,269 @@
 
 #include <thread>
 #include <functional>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <future>
 #include <stdexcept>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class TaskCounter
+ * @brief AsyncFunctionManager::Submitで投入したタスクの完了を数えるカウンタ。
+ *      futureの代わりに使う。投入のたびに増え、タスクが終わるたびに減る。
+ */
+class TaskCounter final {
+public:
+    TaskCounter() = default;
+    TaskCounter(const TaskCounter&) = delete;
+    TaskCounter& operator=(const TaskCounter&) = delete;
+
+    /**
+     * @brief 投入したタスクが全て完了したかどうかを確認する。
+     * @return 全て完了していればtrue。
+     */
+    inline bool IsDone() const noexcept {
+        // 最後のタスクが通知を終えるまでは完了とみなさない。完了後はカウンタを破棄してよい
+        return m_Count.load(std::memory_order_acquire) == 0 &&
+            m_NotifyingCount.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * @brief 投入したタスクが全て完了するまで待つ。
+     */
+    inline void Wait() const noexcept {
+        std::uint32_t count = m_Count.load(std::memory_order_acquire);
+        while (count != 0) {
+            m_Count.wait(count, std::memory_order_acquire);
+            count = m_Count.load(std::memory_order_acquire);
+        }
+        // 最後のタスクが通知を終えるまでは、カウンタを破棄されないように待つ
+        while (m_NotifyingCount.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    friend class AsyncFunctionManager;
+
+    /**
+     * @brief 完了していないタスクを増やす。
+     */
+    inline void Add(const std::uint32_t _count) noexcept {
+        m_Count.fetch_add(_count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief タスクが1つ完了したことを記録する。最後の1つであれば待機中のスレッドを起こす。
+     */
+    inline void Done() noexcept {
+        m_NotifyingCount.fetch_add(1, std::memory_order_relaxed);
+        if (m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_Count.notify_all();
+        }
+        m_NotifyingCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    //! 完了していないタスクの数
+    std::atomic<std::uint32_t> m_Count = 0;
+    //! Doneの途中のスレッドの数。0になるまでカウンタを破棄できない
+    std::atomic<std::uint32_t> m_NotifyingCount = 0;
+};
 
 /**
  * @class AsyncFunctionManager
- * @brief 񓯊֐ǗÃXbhŎs}l[WNXB
+ * @brief 非同期関数を管理し、複数のスレッドで実行するマネージャクラス。
+ *      タスクは固定サイズのノードに関数オブジェクトを直接構築してキューに繋ぐ。
+ *      ノードは使い回すので、SubmitとParallelForは定常状態でヒープを確保しない。
  */
 class AsyncFunctionManager final {
 public:
+    //! タスクのノードに直接格納できる関数オブジェクトの最大サイズ[byte]
+    static constexpr std::size_t cTaskStorageSize = 48;
+
     /**
-     * @brief RXgN^B
-     * @param _inUseThreadNum gpXbhBftHg̓n[hEFÃRAB
-     * @throws std::invalid_argument gpXbh0̏ꍇɃX[OB
+     * @brief コンストラクタ。
+     * @param _inUseThreadNum 使用するスレッド数。デフォルトはハードウェアのコア数から、
+     *      待機中にタスクを実行する呼び出し元のスレッドの分を引いた数。
+     * @throws std::invalid_argument 使用するスレッド数が0の場合にスローされる例外。
      */
-    inline AsyncFunctionManager(std::size_t _inUseThreadNum = std::thread::hardware_concurrency()) {
-        // Xbh̐[v񂵂āAeXbhRun֐sB
+    inline AsyncFunctionManager(std::size_t _inUseThreadNum = GetDefaultThreadNum()) {
+        // スレッドの数だけループを回して、各スレッドでRun関数を実行する。
         for (std::size_t i = 0; i < _inUseThreadNum; ++i) {
             m_Threads.emplace_back([this] { this->Run(); });
         }
     }
 
     /**
-     * @brief ev[go֐B񓯊Ɋ֐sB
-     * @param _inFunc s֐B
-     * @param _inArgs s֐̈B
-     * @return ֐̎sʂҋ@邽߂futureIuWFNgB
+     * @brief テンプレートメンバ関数。非同期に関数を実行する。
+     * @param _inFunc 実行する関数。
+     * @param _inArgs 実行する関数の引数。
+     * @return 関数の実行結果を待機するためのfutureオブジェクト。
      */
     template <typename Func, typename... Args>
     auto Execute(Func&& _inFunc, Args&&... _inArgs) 
         -> std::future<std::invoke_result_t<Func, Args...>> {
         using ReturnType = std::invoke_result_t<Func, Args...>;
 
-        // ֐pbP[W^XNɕϊAL|C^ŃbvB
+        // 関数をパッケージタスクに変換し、それを共有ポインタでラップする。
         auto task = std::make_shared<std::packaged_task<ReturnType()>>(
             std::bind(std::forward<Func>(_inFunc), std::forward<Args>(_inArgs)...)
         );
 
-        // pbP[W^XNfuture擾B
+        // パッケージタスクからfutureを取得する。
         std::future<ReturnType> result = task->get_future();
         {
             std::lock_guard<std::mutex> lock(m_QueueMutex);
-            // Vbg_EɃ^XNs悤ƂꍇAO𓊂B
+            // シャットダウン中にタスクが実行されようとした場合、例外を投げる。
             if (m_bShutdown) {
                 throw std::runtime_error("Cannot execute tasks after shutdown.");
             }
-            // ^XNL[ɐV^XNǉB
-            m_TaskQueue.emplace([task]() { (*task)(); });
+            // タスクキューに新しいタスクを追加。
+            PushTask(AllocateTask([task = std::move(task)]() { (*task)(); }, nullptr));
         }
-        // V^XNǉꂽ̂ŁAҋ@̃XbhɒʒmB
+        // 新しいタスクが追加されたので、待機中のスレッドに通知する。
         m_Condition.notify_one();
 
         return result;
     }
 
     /**
-     * @brief 񓯊֐}l[W̃Vbg_EB
-     *      SẴXbhIASẴ^XNB
+     * @brief 関数を非同期に実行する。futureを作らず、完了はカウンタで数える。
+     * @param _func 実行する関数。引数なしで呼び出せ、サイズがcTaskStorageSize以下であること。
+     *      例外を投げてはいけない。
+     * @param _counter 完了を数えるカウンタ。タスクが終わるまで破棄しないこと。
+     * @throws std::runtime_error シャットダウン後に呼び出した場合にスローされる例外。
+     */
+    template <typename Func>
+    void Submit(Func&& _func, TaskCounter& _counter) {
+        _counter.Add(1);
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            if (m_bShutdown) {
+                _counter.Done();
+                throw std::runtime_error("Cannot execute tasks after shutdown.");
+            }
+            PushTask(AllocateTask(std::forward<Func>(_func), &_counter));
+        }
+        m_Condition.notify_one();
+    }
+
+    /**
+     * @brief 0から_count-1までの番号ごとに関数を並列に実行し、全て完了するまで待つ。
+     * @param _count 実行する数。
+     * @param _grain 1つのタスクにまとめる番号の数。0の場合は1として扱う。
+     * @param _func 実行する関数。番号(std::size_t)を受け取る。例外を投げてはいけない。
+     * @note 範囲ごとのタスクは1度のロックでまとめてキューに繋ぐ。
+     *      呼び出し元のスレッドも完了を待つ間にキューのタスクを実行するので、
+     *      ワーカーのタスクの中から入れ子で呼び出してもスレッドが足りなくならない。
+     */
+    template <typename Func>
+    void ParallelFor(const std::size_t _count, std::size_t _grain, Func&& _func) {
+        if (_count == 0) {
+            return;
+        }
+        if (_grain == 0) {
+            _grain = 1;
+        }
+        // 1つの範囲に収まる場合はタスクにせずその場で実行する
+        if (_count <= _grain || m_Threads.empty()) {
+            for (std::size_t i = 0; i < _count; ++i) {
+                _func(i);
+            }
+            return;
+        }
+
+        const std::size_t taskCount = (_count + _grain - 1) / _grain;
+        TaskCounter counter;
+        counter.Add(static_cast<std::uint32_t>(taskCount));
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            if (m_bShutdown) {
+                throw std::runtime_error("Cannot execute tasks after shutdown.");
+            }
+            for (std::size_t begin = 0; begin < _count; begin += _grain) {
+                const std::size_t end = (std::min)(begin + _grain, _count);
+                PushTask(AllocateTask([pFunc = &_func, begin, end]() {
+                    for (std::size_t i = begin; i < end; ++i) {
+                        (*pFunc)(i);
+                    }
+                }, &counter));
+            }
+        }
+        if (taskCount == 1) {
+            m_Condition.notify_one();
+        } else {
+            m_Condition.notify_all();
+        }
+
+        Wait(counter);
+    }
+
+    /**
+     * @brief カウンタのタスクが全て完了するまで、キューのタスクを呼び出し元のスレッドで実行しながら待つ。
+     * @param _counter 完了を待つカウンタ。
+     * @note 実行するタスクはカウンタのものに限らない。キューが空のまましばらく経った場合は、
+     *      残りが他のスレッドで実行中とみなして眠る。
+     */
+    inline void Wait(TaskCounter& _counter) {
+        std::uint32_t idleCount = 0;
+        while (!_counter.IsDone()) {
+            if (TryRunPendingTask()) {
+                idleCount = 0;
+                continue;
+            }
+            if (++idleCount < cWaitSpinCount) {
+                std::this_thread::yield();
+                continue;
+            }
+            _counter.Wait();
+            return;
+        }
+    }
+
+    /**
+     * @brief キューからタスクを1つ取り出し、呼び出し元のスレッドで実行する。
+     * @return タスクを実行した場合はtrue、キューが空だった場合はfalseを返す。
+     */
+    inline bool TryRunPendingTask() {
+        Task* pTask = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            pTask = PopTask();
+        }
+        if (!pTask) {
+            return false;
+        }
+
+        RunTask(pTask);
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            FreeTask(pTask);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 非同期関数マネージャのシャットダウン。
+     *      全てのスレッドを終了し、全てのタスクを完了させる。
      */
     inline void Shutdown() {
         {
             std::lock_guard<std::mutex> lock(m_QueueMutex);
-            // Vbg_EtOtrueɐݒB
+            // シャットダウンフラグをtrueに設定。
             m_bShutdown = true;
         }
-        // ׂẴXbhڊo߂悤ɒʒmB
+        // すべてのスレッドが目覚めるように通知する。
         m_Condition.notify_all();
-        // ׂẴXbhÎ҂B
+        // すべてのスレッドが終了するのを待つ。
         for (auto& thread : m_Threads) {
             if (thread.joinable()) {
                 thread.join();
@@ -82,20 +273,20 @@ public:
     }
 
     /**
-     * @brief ׂẴ^XNǂmFB
-     * @return ׂẴ^XNĂtrueAłȂfalseԂB
+     * @brief すべてのタスクが完了したかどうかを確認する。
+     * @return すべてのタスクが完了していればtrue、そうでなければfalseを返す。
      */
     inline bool IsAllTasksCompleted() const {
         std::lock_guard<std::mutex> lock(m_QueueMutex);
-        // ^XNL[󂩂ǂԂB
-        return m_TaskQueue.empty();
+        // タスクキューが空かどうかを返す。
+        return m_pQueueHead == nullptr;
     }
     
     /**
-    * @brief SẴ^XN܂ő҂B
+    * @brief 全てのタスクが完了するまで待つ。
     */
     inline void WaitForAllTasksToComplete() {
-        // ׂẴXbhÎ҂B
+        // すべてのスレッドが終了するのを待つ。
         for (auto& thread : m_Threads) {
                 thread.join();
         }
@@ -103,40 +294,162 @@ public:
 
 private:
     /**
-     * @brief Xbhs֐B
-     *      ^XNL[^XNoAsB
+     * @struct Task
+     * @brief キューに繋ぐタスクのノード。関数オブジェクトを内部の領域に直接構築する。
+     */
+    struct Task {
+        //! 関数オブジェクトを構築する領域
+        alignas(std::max_align_t) std::byte m_Storage[cTaskStorageSize];
+        //! 関数オブジェクトを実行して破棄する関数
+        void (*m_pInvoke)(Task&) = nullptr;
+        //! 完了を数えるカウンタ。ない場合はnullptr
+        TaskCounter* m_pCounter = nullptr;
+        //! キューまたは空きリストの次のノード
+        Task* m_pNext = nullptr;
+    };
+
+    //! ノードが足りなくなったときにまとめて確保する数
+    static constexpr std::size_t cTaskBlockSize = 256;
+    //! Waitでキューが空のときに、眠る前に見直す回数
+    static constexpr std::uint32_t cWaitSpinCount = 64;
+
+    /**
+     * @brief 既定のワーカースレッド数を取得する。待機中の呼び出し元のスレッドもタスクを実行するので1つ減らす。
+     */
+    static std::size_t GetDefaultThreadNum() {
+        const std::size_t coreNum = std::thread::hardware_concurrency();
+        return coreNum > 1 ? coreNum - 1 : 1;
+    }
+
+    /**
+     * @brief 空きリストからノードを取り出し、関数オブジェクトを構築する。m_QueueMutexを取った状態で呼ぶこと。
+     * @param _func 格納する関数オブジェクト。
+     * @param _pCounter 完了を数えるカウンタ。
+     * @return 構築したノード。
+     */
+    template <typename Func>
+    Task* AllocateTask(Func&& _func, TaskCounter* _pCounter) {
+        using FuncT = std::decay_t<Func>;
+        static_assert(sizeof(FuncT) <= cTaskStorageSize && alignof(FuncT) <= alignof(std::max_align_t),
+            "Task function object is too large. Capture by reference or pointer.");
+
+        if (!m_pFreeTasks) {
+            m_TaskBlocks.push_back(std::make_unique<Task[]>(cTaskBlockSize));
+            Task* pBlock = m_TaskBlocks.back().get();
+            for (std::size_t i = 0; i < cTaskBlockSize; ++i) {
+                pBlock[i].m_pNext = i + 1 < cTaskBlockSize ? &pBlock[i + 1] : nullptr;
+            }
+            m_pFreeTasks = pBlock;
+        }
+
+        Task* pTask = m_pFreeTasks;
+        m_pFreeTasks = pTask->m_pNext;
+
+        ::new (static_cast<void*>(pTask->m_Storage)) FuncT(std::forward<Func>(_func));
+        pTask->m_pInvoke = [](Task& _task) {
+            FuncT& func = *std::launder(reinterpret_cast<FuncT*>(_task.m_Storage));
+            func();
+            func.~FuncT();
+        };
+        pTask->m_pCounter = _pCounter;
+        pTask->m_pNext = nullptr;
+        return pTask;
+    }
+
+    /**
+     * @brief ノードをキューの末尾に繋ぐ。m_QueueMutexを取った状態で呼ぶこと。
+     */
+    inline void PushTask(Task* _pTask) noexcept {
+        if (m_pQueueTail) {
+            m_pQueueTail->m_pNext = _pTask;
+        } else {
+            m_pQueueHead = _pTask;
+        }
+        m_pQueueTail = _pTask;
+    }
+
+    /**
+     * @brief キューの先頭からノードを取り出す。m_QueueMutexを取った状態で呼ぶこと。
+     * @return 取り出したノード。キューが空の場合はnullptr。
+     */
+    inline Task* PopTask() noexcept {
+        Task* pTask = m_pQueueHead;
+        if (pTask) {
+            m_pQueueHead = pTask->m_pNext;
+            if (!m_pQueueHead) {
+                m_pQueueTail = nullptr;
+            }
+        }
+        return pTask;
+    }
+
+    /**
+     * @brief 実行を終えたノードを空きリストへ戻す。m_QueueMutexを取った状態で呼ぶこと。
+     */
+    inline void FreeTask(Task* _pTask) noexcept {
+        _pTask->m_pNext = m_pFreeTasks;
+        m_pFreeTasks = _pTask;
+    }
+
+    /**
+     * @brief ノードのタスクを実行し、カウンタに完了を記録する。
+     */
+    static inline void RunTask(Task* _pTask) {
+        TaskCounter* pCounter = _pTask->m_pCounter;
+        _pTask->m_pInvoke(*_pTask);
+        if (pCounter) {
+            pCounter->Done();
+        }
+    }
+
+    /**
+     * @brief スレッドが実行する関数。
+     *      タスクキューからタスクを取り出し、実行する。
      */
     inline void Run() {
+        Task* pFinished = nullptr;
         while (true) {
-            std::function<void()> task;
+            Task* pTask = nullptr;
             {
                 std::unique_lock<std::mutex> lock(m_QueueMutex);
-                // V^XNǉ邩AVbg_EtOtrueɂȂ܂őҋ@B
-                m_Condition.wait(lock, [this] { return m_bShutdown || !m_TaskQueue.empty(); });
+                // 実行を終えたノードは次を取り出すついでに空きリストへ戻す。
+                if (pFinished) {
+                    FreeTask(pFinished);
+                    pFinished = nullptr;
+                }
+
+                // 新しいタスクが追加されるか、シャットダウンフラグがtrueになるまで待機。
+                m_Condition.wait(lock, [this] { return m_bShutdown || m_pQueueHead != nullptr; });
 
-                // Vbg_EĂă^XNL[Ȃ烋[v𔲂B
-                if (m_bShutdown && m_TaskQueue.empty()) {
+                // シャットダウンしていてタスクキューが空ならループを抜ける。
+                if (m_bShutdown && m_pQueueHead == nullptr) {
                     return;
                 }
 
-                // L[玟̃^XNoB
-                task = std::move(m_TaskQueue.front());
-                m_TaskQueue.pop();
+                // キューから次のタスクを取り出す。
+                pTask = PopTask();
             }
 
-            // ^XNsB
-            task();
+            // タスクを実行する。
+            RunTask(pTask);
+            pFinished = pTask;
         }
     }
 
-    //! spXbh
+    //! 実行用スレッド
     std::vector<std::thread> m_Threads;
-    //! Vbg_EtO
+    //! シャットダウンフラグ
     std::atomic<bool> m_bShutdown;
-    //! ^XNL[ی삷~[ebNX
+    //! タスクキューを保護するミューテックス
     mutable std::mutex m_QueueMutex;
-    //! s҂̃^XNL[
-    std::queue<std::function<void()>> m_TaskQueue;
-    //! ^XN̒ǉҋ@ϐ
+    //! 実行待ちのタスクキューの先頭
+    Task* m_pQueueHead = nullptr;
+    //! 実行待ちのタスクキューの末尾
+    Task* m_pQueueTail = nullptr;
+    //! 使われていないノードのリスト
+    Task* m_pFreeTasks = nullptr;
+    //! 確保したノードのブロック
+    std::vector<std::unique_ptr<Task[]>> m_TaskBlocks;
+    //! タスクの追加を待機する条件変数
     std::condition_variable m_Condition;
 };
\ No newline at end of file
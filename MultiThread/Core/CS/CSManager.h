@@ -98,7 +98,7 @@ namespace CS
 		public:
 			void Update() override
 			{
-				// 擾
+				// 取得
 				TestComponent0* pTest0 = m_OwnerPtr->GetComponent<TestComponent0>().lock().get();
 				TestComponent1* pTest1 = m_OwnerPtr->GetComponent<TestComponent1>().lock().get();
 				TestComponent2* pTest2 = m_OwnerPtr->GetComponent<TestComponent2>().lock().get();
@@ -110,7 +110,7 @@ namespace CS
 				TestComponent8* pTest8 = m_OwnerPtr->GetComponent<TestComponent8>().lock().get();
 				TestComponent9* pTest9 = m_OwnerPtr->GetComponent<TestComponent9>().lock().get();
 			
-				// 
+				// 処理
 				this->value =
 					pTest0->value +
 					pTest1->value +
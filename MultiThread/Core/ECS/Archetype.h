@@ -1,209 +1,422 @@
 #pragma once
 
-#include <memory>
-#include <typeinfo>
-#include <bitset>
-#include <map>
+#include <array>
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <type_traits>
 
 #include "Common/Id.h"
+#include "Entity.h"
 #include "Utilities/TypeInfo.h"
+#include "ComponentFunctions.h"
+#include "ComponentRegistry.h"
+#include "IComponentData.h"
 
 namespace ECS
 {
 	/**
 	* @struct Archetype
-	* @brief ECSA[LeN`ɂA[L^Cv\NXB
+	* @brief ECSアーキテクチャにおけるアーキタイプを表すクラス。
+	* @note コンポーネントは型IDの昇順に並べて保持する。型IDはコンパイル時定数なので、
+	*		 型リストが固定のアーキタイプはconstexprで構築でき、オフセット等も定数になる。
+	*		 チャンクでは列の先頭が(sizeof(Entity) + オフセット) * 最大数になるので、
+	*		 sizeof(Entity) + オフセットが型のアライメントの倍数になるようにオフセットを詰め物で揃える。
 	*/
 	struct Archetype
 	{
+	public:
+		//! シグネチャのマスクのワード数。
+		static constexpr std::size_t cSignatureWordSize = 2;
+
 	public:
 		/**
-		* @brief RXgN^B
+		* @brief コンストラクタ。
 		*/
-		Archetype()
-			: m_Signature(0)
-			, m_ArchetypeSize(0)
+		constexpr Archetype()
+			: m_Signature{}
+			, m_ComponentIds{}
+			, m_ComponentMemorySizes{}
+			, m_ComponentAlignments{}
+			, m_ComponentFunctions{}
+			, m_ComponentMemoryOffsets{}
 			, m_ArchetypeMemorySize(0)
+			, m_ArchetypeSize(0)
 		{}
 
 		/**
-		* @brief Rs[RXgN^B
-		* @param _other Rs[A[L^CvB
+		* @brief コピーコンストラクタ。
+		* @param _other コピーするアーキタイプ。
+		*/
+		constexpr Archetype(const Archetype& _other) = default;
+
+		/**
+		* @brief 指定した型リストからアーキタイプを作成します。
+		* @tparam CompTs アーキタイプに含めるコンポーネントの型。
+		* @return Archetype 作成したアーキタイプ。
 		*/
-		Archetype(const Archetype& _other)
+		template <typename... CompTs>
+		static constexpr Archetype Create()
 		{
-			m_Signature = _other.m_Signature;
-			m_ComponentMemorySize = _other.m_ComponentMemorySize;
-			m_ArchetypeMemorySize = _other.m_ArchetypeMemorySize;
-			m_ArchetypeSize = _other.m_ArchetypeSize;
+			Archetype result;
+			(result.AddType<CompTs>(), ...);
+			return result;
 		}
 
 		/**
-		* @brief ̃R|[lg^CvA[L^Cvɒǉ܂B
-		* @tparam CompT ǉR|[lǧ^B
-		* @return A[L^Cvgւ̎QƁB
+		* @brief 特定のコンポーネントタイプをアーキタイプに追加します。
+		* @tparam CompT 追加するコンポーネントの型。疎な集合に格納する型は追加しない。
+		* @return アーキタイプ自身への参照。
+		* @note 型はComponentRegistryに登録される。アドレスを取るだけなのでconstexprのまま使える。
 		*/
 		template <typename CompT>
-		inline const Archetype& AddType()
+		inline constexpr const Archetype& AddType()
+		{
+			if constexpr (SparseComponent<CompT>)
+				return *this;
+			else
+			{
+				static_cast<void>(&ComponentRegistry::cRegistered<CompT>);
+				return AddType(TypeManager::TypeInfo<CompT>::GetID(), sizeof(CompT), alignof(CompT),
+					ComponentFunctions::Get<CompT>());
+			}
+		}
+
+		/**
+		* @brief 型IDとメモリサイズを指定してコンポーネントタイプを追加します。
+		* @param _id 追加するコンポーネントの型ID。
+		* @param _size 追加するコンポーネントのメモリサイズ。
+		* @param _alignment 追加するコンポーネントのアライメント。2の累乗でcMaxComponentAlignment以下。
+		* @param _pFunctions コンポーネントの関数テーブル。トリビアルにコピー可能な場合はnullptr。
+		* @return アーキタイプ自身への参照。
+		*/
+		inline constexpr const Archetype& AddType(const TypeId _id, const std::size_t _size,
+			const std::size_t _alignment, const ComponentFunctions* _pFunctions = nullptr)
 		{
-			std::size_t compId = TypeManager::TypeInfo<CompT>::GetID();
-			if (!m_Signature.test(compId))
+			const std::size_t index = FindIndex(_id);
+			if (index < m_ArchetypeSize && m_ComponentIds[index] == _id)
+				return *this;
+
+			if (m_ArchetypeSize == cMaxComponentSize || !IsValidAlignment(_alignment))
+				std::abort();
+
+			// 挿入位置より後ろを1つずらす
+			for (std::size_t i = m_ArchetypeSize; i > index; i--)
 			{
-				m_Signature.set(compId);
-				m_ComponentMemorySize[compId] = sizeof(CompT);
-				m_ArchetypeMemorySize += sizeof(CompT);
-				m_ArchetypeSize++;
+				m_ComponentIds[i] = m_ComponentIds[i - 1];
+				m_ComponentMemorySizes[i] = m_ComponentMemorySizes[i - 1];
+				m_ComponentAlignments[i] = m_ComponentAlignments[i - 1];
+				m_ComponentFunctions[i] = m_ComponentFunctions[i - 1];
 			}
+			m_ComponentIds[index] = _id;
+			m_ComponentMemorySizes[index] = _size;
+			m_ComponentAlignments[index] = _alignment;
+			m_ComponentFunctions[index] = _pFunctions;
+			m_ArchetypeSize++;
+
+			UpdateLayout();
 			return *this;
 		}
 
 		/**
-		* @brief ̃R|[lg^CvA[L^Cv珜O܂B
-		* @tparam CompT OR|[lǧ^B
-		* @return A[L^Cvgւ̎QƁB
+		* @brief 特定のコンポーネントタイプをアーキタイプから除外します。
+		* @tparam CompT 除外するコンポーネントの型。
+		* @return アーキタイプ自身への参照。
 		*/
 		template <typename CompT>
-		inline const Archetype& RemoveType()
+		inline constexpr const Archetype& RemoveType()
 		{
-			std::size_t compId = TypeManager::TypeInfo<CompT>::GetID();
-			if (m_Signature.test(compId))
+			return RemoveType(TypeManager::TypeInfo<CompT>::GetID());
+		}
+
+		/**
+		* @brief 型IDを指定してコンポーネントタイプを除外します。
+		* @param _id 除外するコンポーネントの型ID。
+		* @return アーキタイプ自身への参照。
+		*/
+		inline constexpr const Archetype& RemoveType(const TypeId _id)
+		{
+			const std::size_t index = FindIndex(_id);
+			if (index < m_ArchetypeSize && m_ComponentIds[index] == _id)
 			{
-				m_Signature.reset(compId);
-				m_ComponentMemorySize.erase(compId);
-				m_ArchetypeMemorySize -= sizeof(CompT);
 				m_ArchetypeSize--;
+				for (std::size_t i = index; i < m_ArchetypeSize; i++)
+				{
+					m_ComponentIds[i] = m_ComponentIds[i + 1];
+					m_ComponentMemorySizes[i] = m_ComponentMemorySizes[i + 1];
+					m_ComponentAlignments[i] = m_ComponentAlignments[i + 1];
+					m_ComponentFunctions[i] = m_ComponentFunctions[i + 1];
+				}
+				m_ComponentIds[m_ArchetypeSize] = 0;
+				m_ComponentMemorySizes[m_ArchetypeSize] = 0;
+				m_ComponentAlignments[m_ArchetypeSize] = 0;
+				m_ComponentFunctions[m_ArchetypeSize] = nullptr;
+
+				UpdateLayout();
 			}
 			return *this;
 		}
 
 		/**
-		 * @brief ̃A[L^Cṽ݂A[L^CvɊ܂܂邩ǂ𔻒f܂B
-		 * @param _other rΏۂ̃A[L^CvB
-		 * @return bool ̃A[L^Cv܂܂ĂꍇtrueB
+		 * @brief 他のアーキタイプが現在のアーキタイプに含まれるかどうかを判断します。
+		 * @param _other 比較対象のアーキタイプ。
+		 * @return bool 他のアーキタイプが含まれている場合はtrue。
 		 */
-		inline const bool IsContain(const Archetype& _other) const noexcept
+		inline constexpr const bool IsContain(const Archetype& _other) const noexcept
 		{
-			return (m_Signature & _other.m_Signature) == _other.m_Signature;
+			// マスクで高速に弾いてから、型IDの列で厳密に判定する
+			for (std::size_t i = 0; i < cSignatureWordSize; i++)
+			{
+				if ((m_Signature[i] & _other.m_Signature[i]) != _other.m_Signature[i])
+					return false;
+			}
+			return std::includes(
+				m_ComponentIds.begin(), m_ComponentIds.begin() + m_ArchetypeSize,
+				_other.m_ComponentIds.begin(), _other.m_ComponentIds.begin() + _other.m_ArchetypeSize);
 		}
 
 		/**
-		 * @brief w肳ꂽR|[lg^CṽItZbg擾܂B
-		 * @tparam CompT ItZbg擾R|[lǧ^B
-		 * @return std::size_t w肳ꂽR|[lg̃ItZbgB
+		 * @brief 指定されたコンポーネントタイプを含むかどうかを判断します。
+		 * @tparam CompT 判定するコンポーネントの型。
+		 * @return bool 含まれている場合はtrue。
 		 */
 		template <typename CompT>
-		inline const std::size_t GetMemoryOffset()
+		inline constexpr const bool HasType() const noexcept
 		{
-			std::size_t result = 0;
-			std::size_t compId = TypeManager::TypeInfo<CompT>::GetID();
-			for (std::size_t i = 0; i < compId; i++)
-			{
-				if (m_Signature.test(i))
-				{
-					result += m_ComponentMemorySize[i];
-				}
-			}
-			return result;
+			return HasType(TypeManager::TypeInfo<CompT>::GetID());
 		}
 
 		/**
-		 * @brief w肳ꂽCfbNX܂ł̃ItZbg擾܂B
-		 * @param _index ItZbg擾CfbNXB
-		 * @return std::size_t w肳ꂽR|[lg̃ItZbgB
+		 * @brief 指定された型IDのコンポーネントを含むかどうかを判断します。
+		 * @param _id 判定するコンポーネントの型ID。
+		 * @return bool 含まれている場合はtrue。
 		 */
-		inline const std::size_t GetMemroyOffsetByIndex(std::size_t _index)
+		inline constexpr const bool HasType(const TypeId _id) const noexcept
 		{
-			if (_index == 0) return 0;
+			const std::size_t index = FindIndex(_id);
+			return index < m_ArchetypeSize && m_ComponentIds[index] == _id;
+		}
 
-			std::size_t result = 0;
-			auto it = m_ComponentMemorySize.begin();
-			for (std::size_t i = 0; i < _index; i++, ++it)
-			{
-				result += it->second;
-			}
-			return result;
+		/**
+		 * @brief 指定されたコンポーネントタイプのアーキタイプ内でのインデックスを取得します。
+		 * @tparam CompT インデックスを取得するコンポーネントの型。
+		 * @return std::size_t インデックス。含まれていない場合はGetArchetypeSize()。
+		 */
+		template <typename CompT>
+		inline constexpr const std::size_t GetComponentIndex() const noexcept
+		{
+			return HasType<CompT>() ?
+				FindIndex(TypeManager::TypeInfo<CompT>::GetID()) : m_ArchetypeSize;
+		}
+
+		/**
+		 * @brief 指定されたコンポーネントタイプのメモリオフセットを取得します。
+		 * @tparam CompT オフセットを取得するコンポーネントの型。
+		 * @return std::size_t 指定されたコンポーネントのメモリオフセット。
+		 */
+		template <typename CompT>
+		inline constexpr const std::size_t GetMemoryOffset() const noexcept
+		{
+			const std::size_t index = FindIndex(TypeManager::TypeInfo<CompT>::GetID());
+			return index < m_ArchetypeSize ? m_ComponentMemoryOffsets[index] : m_ArchetypeMemorySize;
 		}
 
 		/**
-		 * @brief w肳ꂽCfbNX̃TCY擾܂B
-		 * @param _index TCY擾CfbNXB
-		 * @return std::size_t w肳ꂽR|[lg̃TCYB
+		 * @brief 指定されたインデックスまでのメモリオフセットを取得します。
+		 * @param _index オフセットを取得するインデックス。
+		 * @return std::size_t 指定されたコンポーネントのメモリオフセット。
 		 */
-		inline const std::size_t GetMemorySizeByIndex(std::size_t _index)
+		inline constexpr const std::size_t GetMemroyOffsetByIndex(std::size_t _index) const noexcept
+		{
+			return _index < m_ArchetypeSize ? m_ComponentMemoryOffsets[_index] : m_ArchetypeMemorySize;
+		}
+
+		/**
+		 * @brief 指定されたインデックスのメモリサイズを取得します。
+		 * @param _index サイズを取得するインデックス。
+		 * @return std::size_t 指定されたコンポーネントのメモリサイズ。
+		 */
+		inline constexpr const std::size_t GetMemorySizeByIndex(std::size_t _index) const
 		{
 			if ((_index + 1) > m_ArchetypeSize)
 				std::abort();
 
-			auto it = std::next(m_ComponentMemorySize.begin(), _index);
-			return it->second;
+			return m_ComponentMemorySizes[_index];
 		}
 
 		/**
-		 * @brief w肳ꂽCfbNXID擾܂B
-		 * @param _index ID擾CfbNXB
-		 * @return std::size_t w肳ꂽR|[lgIDB
+		 * @brief 指定されたインデックスのアライメントを取得します。
+		 * @param _index アライメントを取得するインデックス。
+		 * @return std::size_t 指定されたコンポーネントのアライメント。
 		 */
-		inline const std::size_t GetComponentIdByIndex(std::size_t _index)
+		inline constexpr const std::size_t GetAlignmentByIndex(std::size_t _index) const
 		{
 			if ((_index + 1) > m_ArchetypeSize)
 				std::abort();
 
-			auto it = std::next(m_ComponentMemorySize.begin(), _index);
-			return it->first;
+			return m_ComponentAlignments[_index];
 		}
 
 		/**
-		* @brief A[L^CvɊ܂܂R|[lg̍vTCY擾B
-		* @return A[L^CvɊ܂܂R|[lg̍vTCYB
+		 * @brief 指定されたインデックスのIDを取得します。
+		 * @param _index IDを取得するインデックス。
+		 * @return TypeId 指定されたコンポーネントのID。
+		 */
+		inline constexpr const TypeId GetComponentIdByIndex(std::size_t _index) const
+		{
+			if ((_index + 1) > m_ArchetypeSize)
+				std::abort();
+
+			return m_ComponentIds[_index];
+		}
+
+		/**
+		 * @brief 指定されたインデックスのコンポーネントがトリビアルにコピー可能かを取得します。
+		 * @param _index 取得するインデックス。
+		 * @return bool トリビアルにコピー可能な場合はtrue。
+		 */
+		inline constexpr const bool IsTriviallyCopyableByIndex(std::size_t _index) const
+		{
+			if ((_index + 1) > m_ArchetypeSize)
+				std::abort();
+
+			return m_ComponentFunctions[_index] == nullptr;
+		}
+
+		/**
+		 * @brief 指定されたインデックスのコンポーネントの関数テーブルを取得します。
+		 * @param _index 取得するインデックス。
+		 * @return const ComponentFunctions* 関数テーブル。トリビアルにコピー可能な場合はnullptr。
+		 */
+		inline constexpr const ComponentFunctions* GetComponentFunctionsByIndex(std::size_t _index) const
+		{
+			if ((_index + 1) > m_ArchetypeSize)
+				std::abort();
+
+			return m_ComponentFunctions[_index];
+		}
+
+		/**
+		 * @brief 全てのコンポーネントがトリビアルにコピー可能かを取得します。
+		 * @return bool 全てトリビアルにコピー可能な場合はtrue。
+		 */
+		inline constexpr const bool IsTriviallyCopyable() const noexcept
+		{
+			for (std::size_t i = 0; i < m_ArchetypeSize; i++)
+			{
+				if (m_ComponentFunctions[i])
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		* @brief アーキタイプに含まれるコンポーネントの合計メモリサイズを取得する。
+		* @return アーキタイプに含まれるコンポーネントの合計メモリサイズ。アライメントの詰め物を含む。
 		*/
-		inline const std::size_t GetArchetypeMemorySize() const noexcept
+		inline constexpr const std::size_t GetArchetypeMemorySize() const noexcept
 		{
 			return m_ArchetypeMemorySize;
 		}
 
 		/**
-		* @brief A[L^CvɊ܂܂R|[lg擾B
-		* @return A[L^CvɊ܂܂R|[lgB
+		* @brief アーキタイプに含まれるコンポーネント数を取得する。
+		* @return アーキタイプに含まれるコンポーネント数。
 		*/
-		inline const std::size_t GetArchetypeSize() const noexcept
+		inline constexpr const std::size_t GetArchetypeSize() const noexcept
 		{
 			return m_ArchetypeSize;
 		}
 
 		/**
-		* @brief A[L^CṽVOl`擾B
-		* @return A[L^CṽVOl`B
+		* @brief アーキタイプのシグネチャのマスクを取得する。
+		* @return アーキタイプのシグネチャのマスク。型IDの下位ビットから作るため、一致判定には使えない。
 		*/
-		inline const std::bitset<cMaxComponentSize> GetSignature() const
+		inline constexpr const std::array<std::uint64_t, cSignatureWordSize>& GetSignature() const noexcept
 		{
 			return m_Signature;
 		}
 
 		/**
-		* @brief Zq̃I[o[[h
+		* @brief 代入演算子のオーバーロード
 		*/
-		Archetype& operator=(const Archetype& _other)
+		constexpr Archetype& operator=(const Archetype& _other) = default;
+
+		/**
+		* @brief 同じコンポーネント構成かどうかを判断します。
+		*/
+		constexpr bool operator==(const Archetype& _other) const noexcept
 		{
-			// g̏ꍇ͍sȂ
-			if (this == &_other)
-				return *this;
+			if (m_ArchetypeSize != _other.m_ArchetypeSize)
+				return false;
+			for (std::size_t i = 0; i < m_ArchetypeSize; i++)
+			{
+				if (m_ComponentIds[i] != _other.m_ComponentIds[i])
+					return false;
+			}
+			return true;
+		}
 
-			m_Signature = _other.m_Signature;
-			m_ComponentMemorySize = _other.m_ComponentMemorySize;
-			m_ArchetypeMemorySize = _other.m_ArchetypeMemorySize;
-			m_ArchetypeSize = _other.m_ArchetypeSize;
+		/**
+		* @brief アライメントとして使える値かを判断します。
+		* @param _alignment 判定するアライメント。
+		* @return bool 2の累乗でcMaxComponentAlignment以下の場合はtrue。
+		*/
+		static inline constexpr bool IsValidAlignment(const std::size_t _alignment) noexcept
+		{
+			return _alignment != 0 && (_alignment & (_alignment - 1)) == 0 && _alignment <= cMaxComponentAlignment;
+		}
 
-			return *this;
+	private:
+		/**
+		* @brief 型IDが格納されている(または挿入される)インデックスを二分探索します。
+		* @param _id 検索する型ID。
+		* @return std::size_t インデックス。
+		*/
+		inline constexpr std::size_t FindIndex(const TypeId _id) const noexcept
+		{
+			return static_cast<std::size_t>(std::lower_bound(
+				m_ComponentIds.begin(), m_ComponentIds.begin() + m_ArchetypeSize, _id)
+				- m_ComponentIds.begin());
 		}
+
+		/**
+		* @brief メモリオフセットとシグネチャのマスクを再計算します。
+		*/
+		inline constexpr void UpdateLayout() noexcept
+		{
+			// エンティティの列も含めた位置で揃えると、最大数を掛けた列の先頭も揃う
+			std::size_t offset = sizeof(Entity);
+			m_Signature = {};
+			for (std::size_t i = 0; i < m_ArchetypeSize; i++)
+			{
+				const std::size_t alignment = m_ComponentAlignments[i];
+				offset = (offset + alignment - 1) & ~(alignment - 1);
+				m_ComponentMemoryOffsets[i] = offset - sizeof(Entity);
+				offset += m_ComponentMemorySizes[i];
+
+				const std::size_t bit = m_ComponentIds[i] % (cSignatureWordSize * 64);
+				m_Signature[bit / 64] |= std::uint64_t(1) << (bit % 64);
+			}
+			m_ArchetypeMemorySize = offset - sizeof(Entity);
+		}
+
 	private:
-		//! R|[lg̎ނǐՂ邽߂̃rbgZbgB
-		std::bitset<cMaxComponentSize> m_Signature;
-		//! eR|[lg^CṽTCYi[}bvB
-		std::map<std::size_t, std::size_t> m_ComponentMemorySize;
-		//! A[L^CvɊ܂܂R|[lg̍vTCYB
+		//! 型IDから作るシグネチャのマスク。包含判定の高速な足切りに使う。
+		std::array<std::uint64_t, cSignatureWordSize> m_Signature;
+		//! 含まれるコンポーネントの型ID(昇順)。
+		std::array<TypeId, cMaxComponentSize> m_ComponentIds;
+		//! 各コンポーネントタイプのメモリサイズ。
+		std::array<std::size_t, cMaxComponentSize> m_ComponentMemorySizes;
+		//! 各コンポーネントタイプのアライメント。
+		std::array<std::size_t, cMaxComponentSize> m_ComponentAlignments;
+		//! 各コンポーネントタイプの関数テーブル。トリビアルにコピー可能な型はnullptr。
+		std::array<const ComponentFunctions*, cMaxComponentSize> m_ComponentFunctions;
+		//! 各コンポーネントタイプのメモリオフセット。アライメントの詰め物を含む。
+		std::array<std::size_t, cMaxComponentSize> m_ComponentMemoryOffsets;
+		//! アーキタイプに含まれるコンポーネントの合計メモリサイズ。アライメントの詰め物を含む。
 		std::size_t m_ArchetypeMemorySize = 0;
-		//! A[L^CvɊ܂܂R|[lg̎ސB
+		//! アーキタイプに含まれるコンポーネントの種類数。
 		std::size_t m_ArchetypeSize = 0;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+
+#include "Archetype.h"
+#include "ArchetypeTable.h"
+#include "Chunk.h"
+#include "../../ScalableReadWriteLock.h"
+
+namespace ECS
+{
+	class World;
+
+	/**
+	* @class ArchetypeLocks
+	* @brief アーキタイプごとの読み書きロックと、アーキタイプ表やエンティティの管理情報を守る構成ロック。
+	* @note 構成の変更(エンティティの作成、破棄、アーキタイプ間の移動)は構成ロックを読み取りで取り、
+	*		 行を動かすアーキタイプのロックを書き込みで取る。違うアーキタイプの行を動かす変更同士は
+	*		 並行できる。アーキタイプやチャンクの追加、エンティティの管理情報の拡張のように表や配列が
+	*		 動く場合だけ、構成ロックを書き込みで取り直す。読み取り専用のクエリは、対象の
+	*		 アーキタイプのロックを読み取りで取った後は構成ロックを手放すので、他のアーキタイプの
+	*		 構成の変更と並行して動ける。無効の間はロックを一切取らない。
+	*		 アーキタイプのロックはアーキタイプごとに1つずつ持ち、固定長のページに分けて初めて
+	*		 使うときに確保する。ページは動かさないので、ロックの追加と並行して他のロックを使える。
+	*/
+	class ArchetypeLocks
+	{
+	public:
+		using Statistics = ScalableReadWriteLock::Statistics;
+
+		ArchetypeLocks() = default;
+		ArchetypeLocks(const ArchetypeLocks&) = delete;
+		ArchetypeLocks& operator=(const ArchetypeLocks&) = delete;
+
+		/**
+		* @brief デストラクタ。確保したページを解放する。
+		*/
+		~ArchetypeLocks()
+		{
+			for (auto&& pPage : m_pPages)
+				delete[] pPage.load(std::memory_order_relaxed);
+		}
+
+		/**
+		* @brief ロックを有効にするかどうかを設定します。構成の変更やクエリが動いていない間に呼ぶこと。
+		* @param _bEnabled 有効にする場合はtrue。
+		*/
+		void SetEnabled(const bool _bEnabled) noexcept
+		{
+			m_bEnabled = _bEnabled;
+		}
+
+		/**
+		* @brief ロックが有効かどうかを取得します。
+		* @return bool 有効な場合はtrue。
+		*/
+		bool IsEnabled() const noexcept
+		{
+			return m_bEnabled;
+		}
+
+		/**
+		* @brief アーキタイプのロックの統計を取得します。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return Statistics 統計。まだロックを使っていないアーキタイプは0。
+		*/
+		Statistics GetStatistics(const ArchetypeTable::ArchetypeIndex _archetypeIndex) const
+		{
+			const std::size_t pageIndex = _archetypeIndex / cLocksPerPage;
+			const ScalableReadWriteLock* pPage =
+				pageIndex < cMaxPageCount ? m_pPages[pageIndex].load(std::memory_order_acquire) : nullptr;
+			return pPage ? pPage[_archetypeIndex % cLocksPerPage].GetStatistics() : Statistics();
+		}
+
+		/**
+		* @brief 全てのアーキタイプのロックの統計の合計を取得します。
+		* @return Statistics 統計。
+		*/
+		Statistics GetTotalStatistics() const
+		{
+			Statistics result;
+			for (auto&& pPage : m_pPages)
+			{
+				const ScalableReadWriteLock* pLocks = pPage.load(std::memory_order_acquire);
+				for (std::size_t i = 0; pLocks && i < cLocksPerPage; i++)
+					result += pLocks[i].GetStatistics();
+			}
+			return result;
+		}
+
+		/**
+		* @brief 構成ロックの統計を取得します。
+		* @return Statistics 統計。
+		*/
+		Statistics GetStructureStatistics() const
+		{
+			return m_StructureLock.GetStatistics();
+		}
+
+		/**
+		* @brief 構成の変更に付随する記録(再利用するインデックス、変更の記録、疎な集合)を守るロックを取ります。
+		* @return std::unique_lock<std::mutex> ロック。無効な場合と、構成ロックを書き込みで取っている
+		*		  スレッドからは何も取らない。
+		*/
+		std::unique_lock<std::mutex> LockBookkeeping()
+		{
+			if (!m_bEnabled || m_StructureOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+				return std::unique_lock<std::mutex>();
+			return std::unique_lock<std::mutex>(m_BookkeepingMutex);
+		}
+
+		/**
+		* @brief 全ての統計を0に戻します。
+		*/
+		void ResetStatistics()
+		{
+			for (auto&& pPage : m_pPages)
+			{
+				ScalableReadWriteLock* pLocks = pPage.load(std::memory_order_acquire);
+				for (std::size_t i = 0; pLocks && i < cLocksPerPage; i++)
+					pLocks[i].ResetStatistics();
+			}
+			m_StructureLock.ResetStatistics();
+		}
+
+	private:
+		friend class StructureWriteScope;
+		friend class StructureChangeScope;
+		friend class ArchetypeWriteScope;
+		friend class ArchetypeReadScope;
+
+		//! 1ページのロックの数。
+		static constexpr std::size_t cLocksPerPage = 64;
+		//! ページの最大数。アーキタイプの数はcLocksPerPage * cMaxPageCountまで。
+		static constexpr std::size_t cMaxPageCount = 1024;
+
+		/**
+		* @brief アーキタイプのロックを取得します。ページがなければ作る。ロックはインデックスの昇順に取る。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return ScalableReadWriteLock& ロック。破棄されるまで同じアドレスに残る。
+		*/
+		ScalableReadWriteLock& GetLock(const ArchetypeTable::ArchetypeIndex _archetypeIndex)
+		{
+			const std::size_t pageIndex = _archetypeIndex / cLocksPerPage;
+			if (pageIndex >= cMaxPageCount)
+				std::abort();
+
+			ScalableReadWriteLock* pPage = m_pPages[pageIndex].load(std::memory_order_acquire);
+			if (!pPage)
+			{
+				std::lock_guard<std::mutex> lock(m_PageMutex);
+				pPage = m_pPages[pageIndex].load(std::memory_order_relaxed);
+				if (!pPage)
+				{
+					pPage = new ScalableReadWriteLock[cLocksPerPage];
+					m_pPages[pageIndex].store(pPage, std::memory_order_release);
+				}
+			}
+			return pPage[_archetypeIndex % cLocksPerPage];
+		}
+
+	private:
+		//! アーキタイプのロックのページ。使われた範囲だけ確保する。
+		std::atomic<ScalableReadWriteLock*> m_pPages[cMaxPageCount] = {};
+		//! ページの確保を守るロック。
+		std::mutex m_PageMutex;
+		//! アーキタイプ表、チャンクの配列、エンティティの管理情報を守るロック。
+		ScalableReadWriteLock m_StructureLock;
+		//! 構成ロックを書き込みで取っているスレッド。構成の変更の入れ子で取り直さないために使う。
+		std::atomic<std::thread::id> m_StructureOwner;
+		//! 構成の変更に付随する記録を守るロック。
+		std::mutex m_BookkeepingMutex;
+		//! ロックが有効かどうか。
+		bool m_bEnabled = false;
+	};
+
+	/**
+	* @class StructureWriteScope
+	* @brief スコープの間、構成ロックを書き込みで取る。同じスレッドで入れ子になった場合は何もしない。
+	*/
+	class StructureWriteScope
+	{
+	public:
+		explicit StructureWriteScope(ArchetypeLocks& _locks)
+		{
+			if (!_locks.m_bEnabled ||
+				_locks.m_StructureOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+				return;
+
+			_locks.m_StructureLock.LockWrite();
+			_locks.m_StructureOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+			m_pLocks = &_locks;
+		}
+
+		~StructureWriteScope()
+		{
+			if (!m_pLocks)
+				return;
+			m_pLocks->m_StructureOwner.store(std::thread::id(), std::memory_order_relaxed);
+			m_pLocks->m_StructureLock.UnlockWrite();
+		}
+
+		StructureWriteScope(const StructureWriteScope&) = delete;
+		StructureWriteScope& operator=(const StructureWriteScope&) = delete;
+
+	private:
+		//! ロックを取った場合のロック表。
+		ArchetypeLocks* m_pLocks = nullptr;
+	};
+
+	/**
+	* @class StructureChangeScope
+	* @brief スコープの間、構成ロックを読み取りで取る。表や配列が動く変更の前にUpgradeで書き込みに取り直す。
+	* @note 同じスレッドが既に書き込みで取っている場合は何もせず、書き込みで取っている扱いになる。
+	*		 読み取りで取っている間は、他の構成の変更を呼び出さないこと。
+	*/
+	class StructureChangeScope
+	{
+	public:
+		explicit StructureChangeScope(ArchetypeLocks& _locks)
+		{
+			if (!_locks.m_bEnabled ||
+				_locks.m_StructureOwner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+				return;
+
+			_locks.m_StructureLock.LockRead();
+			m_pLocks = &_locks;
+		}
+
+		~StructureChangeScope()
+		{
+			if (!m_pLocks)
+				return;
+			if (!m_bWrite)
+			{
+				m_pLocks->m_StructureLock.UnlockRead();
+				return;
+			}
+			m_pLocks->m_StructureOwner.store(std::thread::id(), std::memory_order_relaxed);
+			m_pLocks->m_StructureLock.UnlockWrite();
+		}
+
+		StructureChangeScope(const StructureChangeScope&) = delete;
+		StructureChangeScope& operator=(const StructureChangeScope&) = delete;
+
+		/**
+		* @brief 構成ロックを読み取りで取っているかどうかを取得します。
+		* @return bool 読み取りで取っている場合はtrue。無効な場合と書き込みで取っている場合はfalse。
+		*/
+		bool IsShared() const noexcept
+		{
+			return m_pLocks && !m_bWrite;
+		}
+
+		/**
+		* @brief 構成ロックを書き込みで取り直します。
+		* @note 取り直す間に他の変更が入るので、読み取りで取っている間に引いた内容は引き直すこと。
+		*		 アーキタイプのロックを取ったまま呼ばないこと。
+		*/
+		void Upgrade()
+		{
+			if (!IsShared())
+				return;
+
+			m_pLocks->m_StructureLock.UnlockRead();
+			m_pLocks->m_StructureLock.LockWrite();
+			m_pLocks->m_StructureOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+			m_bWrite = true;
+		}
+
+	private:
+		//! ロックを取った場合のロック表。
+		ArchetypeLocks* m_pLocks = nullptr;
+		//! 書き込みで取り直したかどうか。
+		bool m_bWrite = false;
+	};
+
+	/**
+	* @class ArchetypeWriteScope
+	* @brief スコープの間、行を動かすアーキタイプのロックを書き込みで取る。
+	* @note 構成ロックを取っている間に使う。2つ指定した場合はインデックスの昇順に取る。
+	*/
+	class ArchetypeWriteScope
+	{
+	public:
+		ArchetypeWriteScope(ArchetypeLocks& _locks, ArchetypeTable::ArchetypeIndex _first,
+			ArchetypeTable::ArchetypeIndex _second = ArchetypeTable::cInvalidIndex)
+		{
+			if (!_locks.m_bEnabled)
+				return;
+
+			if (_second != ArchetypeTable::cInvalidIndex && _second < _first)
+				std::swap(_first, _second);
+
+			m_pFirst = &_locks.GetLock(_first);
+			m_pFirst->LockWrite();
+			if (_second != ArchetypeTable::cInvalidIndex && _second != _first)
+			{
+				m_pSecond = &_locks.GetLock(_second);
+				m_pSecond->LockWrite();
+			}
+		}
+
+		~ArchetypeWriteScope()
+		{
+			if (m_pSecond)
+				m_pSecond->UnlockWrite();
+			if (m_pFirst)
+				m_pFirst->UnlockWrite();
+		}
+
+		ArchetypeWriteScope(const ArchetypeWriteScope&) = delete;
+		ArchetypeWriteScope& operator=(const ArchetypeWriteScope&) = delete;
+
+	private:
+		//! 先に取ったロック。
+		ScalableReadWriteLock* m_pFirst = nullptr;
+		//! 後に取ったロック。
+		ScalableReadWriteLock* m_pSecond = nullptr;
+	};
+
+	/**
+	* @class ArchetypeReadScope
+	* @brief スコープの間、クエリに一致するアーキタイプのロックを読み取りで取り、そのチャンクを提供する。
+	* @note 一致するアーキタイプの構成は変わらないので、チャンクの読み書きは他のアーキタイプの
+	*		 構成の変更と並行して行える。エンティティから引く操作(GetComponentやComponentLookup)は
+	*		 管理情報を読むので、このスコープの中でも構成の変更と並行しては使えない。
+	*		 デッドロックを避けるため、スコープを入れ子にせず、スコープの中で対象のアーキタイプの
+	*		 構成を変えないこと(対象のアーキタイプへの移動も含む)。対象外のアーキタイプ同士の
+	*		 変更は、対象とロックを共有しないので行える。
+	*/
+	class ArchetypeReadScope
+	{
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _world 対象のワールド。
+		* @param _archetype クエリ。このアーキタイプを含むアーキタイプが対象になる。
+		*/
+		ArchetypeReadScope(World& _world, const Archetype& _archetype);
+
+		/**
+		* @brief コンストラクタ。対象のチャンクを既存の配列に取得する。
+		* @param _world 対象のワールド。
+		* @param _archetype クエリ。このアーキタイプを含むアーキタイプが対象になる。
+		* @param _chunkList 対象のチャンクを格納する配列。中身は置き換え、スコープの間は参照し続ける。
+		* @param _query 検索用のシグネチャの作業領域。
+		* @param _readLocks 読み取りで取ったロックを格納する配列。中身は置き換え、スコープの間は参照し続ける。
+		* @note 配列とシグネチャの容量は再利用するので、毎フレーム取っても確保が起きない。
+		*/
+		ArchetypeReadScope(World& _world, const Archetype& _archetype,
+			std::vector<Chunk*>& _chunkList, ArchetypeQuery& _query, std::vector<ScalableReadWriteLock*>& _readLocks);
+
+		~ArchetypeReadScope()
+		{
+			for (auto&& pLock : *m_pReadLocks)
+				pLock->UnlockRead();
+			m_pReadLocks->clear();
+		}
+
+		ArchetypeReadScope(const ArchetypeReadScope&) = delete;
+		ArchetypeReadScope& operator=(const ArchetypeReadScope&) = delete;
+
+		/**
+		* @brief 対象のチャンクのリストを取得します。
+		* @return const std::vector<Chunk*>& チャンクのリスト。
+		*/
+		const std::vector<Chunk*>& GetChunkList() const noexcept
+		{
+			return *m_pResult;
+		}
+
+	private:
+		/**
+		* @brief 対象のアーキタイプのロックを読み取りで取り、チャンクを集めます。
+		*/
+		void Acquire(World& _world, const Archetype& _archetype, ArchetypeQuery& _query);
+
+	private:
+		//! 配列を渡されなかった場合の、読み取りで取ったロック。
+		std::vector<ScalableReadWriteLock*> m_pReadLockList;
+		//! 読み取りで取ったロックを格納した配列。
+		std::vector<ScalableReadWriteLock*>* m_pReadLocks = &m_pReadLockList;
+		//! 配列を渡されなかった場合の対象のチャンク。
+		std::vector<Chunk*> m_pChunkList;
+		//! 対象のチャンクを格納した配列。
+		std::vector<Chunk*>* m_pResult = &m_pChunkList;
+	};
+}
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Archetype.h"
+
+namespace ECS
+{
+	/**
+	* @struct ArchetypeQuery
+	* @brief アーキタイプ検索用のシグネチャ。必要なワードだけを持つ疎な形式。
+	*/
+	struct ArchetypeQuery
+	{
+		//! (ワードのインデックス, そのワードで必要なビット)の配列。
+		std::vector<std::pair<std::uint32_t, std::uint64_t>> m_Words;
+		//! 未登録の型を含むかどうか。含む場合、一致するアーキタイプは存在しない。
+		bool m_bHasUnknownType = false;
+	};
+
+	/**
+	* @class ArchetypeTable
+	* @brief ワールド内の全アーキタイプと、それぞれに属するチャンクを管理するクラス。
+	* @note 型IDごとにワールド内で連番のインデックスを割り当て、シグネチャを
+	*		 64型ずつのワード列としてSoAで保持する。型の数に上限はない。
+	*		 アーキタイプの実体はIntern()でプログラム全体に1つずつ持ち、表とチャンクはそのポインタを持つ。
+	*		 表の複製やチャンクの複製でアーキタイプ自体は複製されない。
+	*/
+	class ArchetypeTable
+	{
+	public:
+		//! アーキタイプのインデックスの型。
+		using ArchetypeIndex = std::uint32_t;
+		//! 無効なアーキタイプのインデックス。
+		static constexpr ArchetypeIndex cInvalidIndex = ArchetypeIndex(-1);
+
+	public:
+		/**
+		* @brief 指定されたアーキタイプのインデックスを検索します。
+		* @param _archetype 検索するアーキタイプ。
+		* @return ArchetypeIndex アーキタイプのインデックス。存在しない場合はcInvalidIndex。
+		*/
+		inline ArchetypeIndex FindArchetype(const Archetype& _archetype) const
+		{
+			auto range = m_ArchetypeIndices.equal_range(HashArchetype(_archetype));
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (*m_Archetypes[it->second] == _archetype)
+					return it->second;
+			}
+			return cInvalidIndex;
+		}
+
+		/**
+		* @brief 指定されたアーキタイプのインデックスを取得、または登録します。
+		* @param _archetype 対象のアーキタイプ。
+		* @return ArchetypeIndex アーキタイプのインデックス。
+		*/
+		inline ArchetypeIndex GetOrCreateArchetype(const Archetype& _archetype)
+		{
+			ArchetypeIndex archetypeIndex = FindArchetype(_archetype);
+			if (archetypeIndex != cInvalidIndex)
+				return archetypeIndex;
+
+			archetypeIndex = static_cast<ArchetypeIndex>(m_Archetypes.size());
+			m_Archetypes.push_back(Intern(_archetype));
+			m_ArchetypeChunkIndices.emplace_back();
+			m_AddTransitions.emplace_back();
+			m_RemoveTransitions.emplace_back();
+			m_ArchetypeIndices.emplace(HashArchetype(_archetype), archetypeIndex);
+
+			// シグネチャの各ワード列に新しいアーキタイプの分を追加する
+			for (auto&& words : m_SignatureWords)
+				words.push_back(0);
+			for (std::size_t i = 0; i < _archetype.GetArchetypeSize(); i++)
+			{
+				const std::uint32_t typeIndex = RegisterType(_archetype.GetComponentIdByIndex(i));
+				m_SignatureWords[typeIndex / 64][archetypeIndex] |= std::uint64_t(1) << (typeIndex % 64);
+			}
+			return archetypeIndex;
+		}
+
+		/**
+		* @brief 型を1つ加えた、または除いたアーキタイプのインデックスを、記録済みの遷移から探します。
+		* @param _from 元のアーキタイプのインデックス。
+		* @param _id 加える、または除く型ID。
+		* @param _bAdd 加える場合はtrue。
+		* @return ArchetypeIndex 遷移先のインデックス。まだ記録していない場合はcInvalidIndex。
+		* @note 表を変えないので、構成ロックを読み取りで取っている間に呼べる。
+		*/
+		inline ArchetypeIndex FindTransition(const ArchetypeIndex _from, const TypeId _id, const bool _bAdd) const
+		{
+			const auto& transitions = (_bAdd ? m_AddTransitions : m_RemoveTransitions)[_from];
+			auto it = transitions.find(_id);
+			return it != transitions.end() ? it->second : cInvalidIndex;
+		}
+
+		/**
+		* @brief 型を1つ加えた、または除いたアーキタイプのインデックスを取得、または登録します。
+		* @tparam CompT 加える、または除くコンポーネントの型。
+		* @param _from 元のアーキタイプのインデックス。
+		* @param _bAdd 加える場合はtrue。
+		* @return ArchetypeIndex 遷移先のインデックス。
+		* @note 遷移は記録しておくので、アーキタイプを組み立てて探すのは遷移ごとに最初の1回だけになる。
+		*/
+		template <typename CompT>
+		inline ArchetypeIndex GetOrCreateTransition(const ArchetypeIndex _from, const bool _bAdd)
+		{
+			const TypeId id = TypeManager::TypeInfo<CompT>::GetID();
+			ArchetypeIndex to = FindTransition(_from, id, _bAdd);
+			if (to != cInvalidIndex)
+				return to;
+
+			Archetype archetype = *m_Archetypes[_from];
+			if (_bAdd)
+				archetype.AddType<CompT>();
+			else
+				archetype.RemoveType<CompT>();
+			to = GetOrCreateArchetype(archetype);
+			(_bAdd ? m_AddTransitions : m_RemoveTransitions)[_from].emplace(id, to);
+			return to;
+		}
+
+		/**
+		* @brief チャンクをアーキタイプに登録します。
+		* @param _archetypeIndex チャンクのアーキタイプのインデックス。
+		* @param _chunkIndex ワールド内でのチャンクのインデックス。
+		*/
+		inline void AddChunk(const ArchetypeIndex _archetypeIndex, const std::uint32_t _chunkIndex)
+		{
+			if (m_ChunkArchetypeIndices.size() <= _chunkIndex)
+				m_ChunkArchetypeIndices.resize(_chunkIndex + 1, cInvalidIndex);
+			m_ChunkArchetypeIndices[_chunkIndex] = _archetypeIndex;
+			m_ArchetypeChunkIndices[_archetypeIndex].push_back(_chunkIndex);
+		}
+
+		/**
+		* @brief アーキタイプを取得します。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return const Archetype& アーキタイプ。
+		*/
+		inline const Archetype& GetArchetype(const ArchetypeIndex _archetypeIndex) const
+		{
+			return *m_Archetypes[_archetypeIndex];
+		}
+
+		/**
+		* @brief アーキタイプに属するチャンクのインデックスの一覧を取得します。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return const std::vector<std::uint32_t>& チャンクのインデックスの一覧。
+		*/
+		inline const std::vector<std::uint32_t>& GetChunkIndices(const ArchetypeIndex _archetypeIndex) const
+		{
+			return m_ArchetypeChunkIndices[_archetypeIndex];
+		}
+
+		/**
+		* @brief チャンクが属するアーキタイプのインデックスを取得します。
+		* @param _chunkIndex ワールド内でのチャンクのインデックス。
+		* @return ArchetypeIndex アーキタイプのインデックス。
+		*/
+		inline ArchetypeIndex GetArchetypeIndexOfChunk(const std::uint32_t _chunkIndex) const
+		{
+			return m_ChunkArchetypeIndices[_chunkIndex];
+		}
+
+		/**
+		* @brief 登録されているアーキタイプの数を取得します。
+		* @return std::size_t アーキタイプの数。
+		*/
+		inline std::size_t GetArchetypeCount() const noexcept
+		{
+			return m_Archetypes.size();
+		}
+
+		/**
+		* @brief 登録されているコンポーネントの型の数を取得します。
+		* @return std::size_t 型の数。
+		*/
+		inline std::size_t GetTypeCount() const noexcept
+		{
+			return m_TypeIndices.size();
+		}
+
+		/**
+		* @brief アーキタイプから検索用のシグネチャを作成します。
+		* @param _archetype 必要なコンポーネントを持つアーキタイプ。
+		* @return ArchetypeQuery 検索用のシグネチャ。
+		*/
+		inline ArchetypeQuery CreateQuery(const Archetype& _archetype) const
+		{
+			ArchetypeQuery query;
+			CreateQuery(_archetype, query);
+			return query;
+		}
+
+		/**
+		* @brief アーキタイプから検索用のシグネチャを既存のシグネチャに作り直します。
+		* @param _archetype 必要なコンポーネントを持つアーキタイプ。
+		* @param _query 作り直すシグネチャ。容量は再利用する。
+		*/
+		inline void CreateQuery(const Archetype& _archetype, ArchetypeQuery& _query) const
+		{
+			_query.m_Words.clear();
+			_query.m_bHasUnknownType = false;
+			for (std::size_t i = 0; i < _archetype.GetArchetypeSize(); i++)
+			{
+				auto it = m_TypeIndices.find(_archetype.GetComponentIdByIndex(i));
+				if (it == m_TypeIndices.end())
+				{
+					_query.m_bHasUnknownType = true;
+					continue;
+				}
+
+				const std::uint32_t wordIndex = it->second / 64;
+				const std::uint64_t bit = std::uint64_t(1) << (it->second % 64);
+				auto word = std::find_if(_query.m_Words.begin(), _query.m_Words.end(),
+					[wordIndex](const auto& _word) { return _word.first == wordIndex; });
+				if (word == _query.m_Words.end())
+					_query.m_Words.emplace_back(wordIndex, bit);
+				else
+					word->second |= bit;
+			}
+		}
+
+		/**
+		* @brief シグネチャを満たす全てのアーキタイプに関数を実行します。
+		* @param _query 検索用のシグネチャ。
+		* @param _func 実行する関数。一致したアーキタイプのインデックスを受け取る。
+		* @note アーキタイプをcMatchBlockSize個ずつまとめ、ワード列をSIMDで一括判定する。
+		*/
+		template <typename Func>
+		inline void ForEachMatch(const ArchetypeQuery& _query, Func&& _func) const
+		{
+			if (_query.m_bHasUnknownType)
+				return;
+
+			alignas(32) std::uint64_t mismatch[cMatchBlockSize];
+			const std::size_t archetypeCount = m_Archetypes.size();
+			for (std::size_t base = 0; base < archetypeCount; base += cMatchBlockSize)
+			{
+				const std::size_t blockSize = (std::min)(cMatchBlockSize, archetypeCount - base);
+				std::fill_n(mismatch, blockSize, std::uint64_t(0));
+
+				for (auto&& [wordIndex, mask] : _query.m_Words)
+				{
+					AccumulateMismatch(m_SignatureWords[wordIndex].data() + base, mask, mismatch, blockSize);
+				}
+
+				for (std::size_t i = 0; i < blockSize; i++)
+				{
+					if (mismatch[i] == 0)
+						_func(static_cast<ArchetypeIndex>(base + i));
+				}
+			}
+		}
+
+		/**
+		* @brief アーキタイプの実体を取得します。同じ構成のアーキタイプは全てのワールドで1つの実体を共有する。
+		* @param _archetype 対象のアーキタイプ。
+		* @return const Archetype* 実体。プログラムの終了まで同じアドレスに残る。
+		* @note 型IDの列に加えて、サイズ、アライメント、関数テーブルも一致するものを同じとみなす。
+		*		 読み込んだデータから作った関数テーブルのないアーキタイプが、型から作ったものと混ざらないようにする。
+		*/
+		static const Archetype* Intern(const Archetype& _archetype)
+		{
+			static std::mutex mutex;
+			static std::deque<Archetype> archetypes;
+			static std::unordered_multimap<std::uint64_t, const Archetype*> indices;
+
+			const std::uint64_t hash = HashArchetype(_archetype);
+			std::lock_guard<std::mutex> lock(mutex);
+			auto range = indices.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (IsSameLayout(*it->second, _archetype))
+					return it->second;
+			}
+
+			const Archetype* pArchetype = &archetypes.emplace_back(_archetype);
+			indices.emplace(hash, pArchetype);
+			return pArchetype;
+		}
+
+	private:
+		/**
+		* @brief 2つのアーキタイプが同じメモリ配置と関数テーブルを持つかを判断します。
+		* @param _lhs 比較するアーキタイプ。
+		* @param _rhs 比較するアーキタイプ。
+		* @return bool 同じ場合はtrue。
+		*/
+		static inline bool IsSameLayout(const Archetype& _lhs, const Archetype& _rhs) noexcept
+		{
+			if (!(_lhs == _rhs))
+				return false;
+			for (std::size_t i = 0; i < _lhs.GetArchetypeSize(); i++)
+			{
+				if (_lhs.GetMemorySizeByIndex(i) != _rhs.GetMemorySizeByIndex(i) ||
+					_lhs.GetAlignmentByIndex(i) != _rhs.GetAlignmentByIndex(i) ||
+					_lhs.GetComponentFunctionsByIndex(i) != _rhs.GetComponentFunctionsByIndex(i))
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		* @brief 型をワールドに登録し、連番のインデックスを取得します。
+		* @param _id 登録する型ID。
+		* @return std::uint32_t 型のインデックス。
+		*/
+		inline std::uint32_t RegisterType(const TypeId _id)
+		{
+			auto result = m_TypeIndices.emplace(_id, static_cast<std::uint32_t>(m_TypeIndices.size()));
+			const std::uint32_t typeIndex = result.first->second;
+
+			// ワードが足りなければ、全アーキタイプ分を0で埋めたワード列を追加する
+			if (typeIndex / 64 >= m_SignatureWords.size())
+				m_SignatureWords.emplace_back(m_Archetypes.size(), std::uint64_t(0));
+			return typeIndex;
+		}
+
+		/**
+		* @brief ワード列の各要素について、必要なビットが欠けているかを累積します。
+		* @param _pWords アーキタイプごとのシグネチャのワード列。
+		* @param _mask 必要なビット。
+		* @param _pMismatch 欠けているビットの累積先。0のままなら一致。
+		* @param _size 判定するアーキタイプの数。
+		*/
+		static inline void AccumulateMismatch(
+			const std::uint64_t* _pWords, const std::uint64_t _mask,
+			std::uint64_t* _pMismatch, const std::size_t _size)
+		{
+			std::size_t i = 0;
+#if defined(__AVX2__)
+			const __m256i mask256 = _mm256_set1_epi64x(static_cast<long long>(_mask));
+			for (; i + 4 <= _size; i += 4)
+			{
+				const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pWords + i));
+				const __m256i mismatch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pMismatch + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(_pMismatch + i), _mm256_or_si256(
+					mismatch, _mm256_xor_si256(_mm256_and_si256(words, mask256), mask256)));
+			}
+#endif
+#if defined(_M_X64) || defined(__SSE2__)
+			const __m128i mask128 = _mm_set1_epi64x(static_cast<long long>(_mask));
+			for (; i + 2 <= _size; i += 2)
+			{
+				const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pWords + i));
+				const __m128i mismatch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pMismatch + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(_pMismatch + i), _mm_or_si128(
+					mismatch, _mm_xor_si128(_mm_and_si128(words, mask128), mask128)));
+			}
+#endif
+			for (; i < _size; i++)
+			{
+				_pMismatch[i] |= (_pWords[i] & _mask) ^ _mask;
+			}
+		}
+
+		/**
+		* @brief アーキタイプの型IDの列からハッシュ値を求めます。
+		* @param _archetype 対象のアーキタイプ。
+		* @return std::uint64_t ハッシュ値。
+		*/
+		static inline std::uint64_t HashArchetype(const Archetype& _archetype) noexcept
+		{
+			std::uint64_t hash = 14695981039346656037ull;
+			for (std::size_t i = 0; i < _archetype.GetArchetypeSize(); i++)
+			{
+				hash ^= _archetype.GetComponentIdByIndex(i);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+	private:
+		//! 一度に判定するアーキタイプの数。
+		static constexpr std::size_t cMatchBlockSize = 256;
+
+		//! 登録されているアーキタイプ。実体はIntern()が持つ。
+		std::vector<const Archetype*> m_Archetypes;
+		//! アーキタイプのハッシュ値からインデックスへの対応。
+		std::unordered_multimap<std::uint64_t, ArchetypeIndex> m_ArchetypeIndices;
+		//! アーキタイプごとの、型IDを加えたときの遷移先。
+		std::vector<std::unordered_map<TypeId, ArchetypeIndex>> m_AddTransitions;
+		//! アーキタイプごとの、型IDを除いたときの遷移先。
+		std::vector<std::unordered_map<TypeId, ArchetypeIndex>> m_RemoveTransitions;
+		//! アーキタイプごとのチャンクのインデックスの一覧。
+		std::vector<std::vector<std::uint32_t>> m_ArchetypeChunkIndices;
+		//! チャンクごとのアーキタイプのインデックス。
+		std::vector<ArchetypeIndex> m_ChunkArchetypeIndices;
+		//! 型IDからワールド内の型のインデックスへの対応。
+		std::unordered_map<TypeId, std::uint32_t> m_TypeIndices;
+		//! シグネチャのワード列。[ワード][アーキタイプ]の順に並べたSoA。
+		std::vector<std::vector<std::uint64_t>> m_SignatureWords;
+	};
+}
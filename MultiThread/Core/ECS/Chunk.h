@@ -1,56 +1,163 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <atomic>
+#include <mutex>
 #include <Windows.h>
 #include "IComponentData.h"
 #include "Entity.h"
 #include "Archetype.h"
+#include "ArchetypeTable.h"
 #include "ComponentArray.h"
+#include "ColumnCodec.h"
+#include "Common/ChangeVersion.h"
 
 
 namespace ECS
 {
 	/**
 	 * @class Chunk
-	 * @brief ECSɂGeBeBƂ̃R|[lgi[`N\NXB
+	 * @brief ECSにおけるエンティティとそのコンポーネントを格納するチャンクを表すクラス。
 	 */
 	class Chunk
 	{
+		friend class DeltaEncoder;
+		friend class DeltaDecoder;
+		friend class RenderState;
+
 	public:
 		/**
-		 * @brief RXgN^B
-		 * @param _archetype ̃`NɊ֘AtA[L^CvB
+		 * @brief コンストラクタ。
+		 * @param _archetype このチャンクに関連付けられるアーキタイプ。チャンクは共有の実体を指すので、一時オブジェクトでもよい。
 		 */
 		explicit Chunk(const Archetype& _archetype)
-			: m_Size(0), m_Archetype(_archetype)
+			: m_Size(0), m_pArchetype(ArchetypeTable::Intern(_archetype))
 		{
-			m_pBegin = std::shared_ptr<std::byte[]>(
-				static_cast<std::byte*>(_aligned_malloc(mc_Capacity, alignof(Entity))),
-				[](std::byte* ptr) { _aligned_free(ptr); });
-			m_MaxSize = mc_Capacity / (sizeof(Entity) + m_Archetype.GetArchetypeMemorySize());
+			SetBuffer(AllocateBuffer(), true);
+			m_MaxSize = CalculateMaxSize(*m_pArchetype);
+			m_bTriviallyCopyable = m_pArchetype->IsTriviallyCopyable();
+			m_ColumnVersions.assign(m_pArchetype->GetArchetypeSize() + 1, GlobalChangeVersion::Get());
+			m_StructureVersion = GlobalChangeVersion::Get();
 
 			if (!m_pBegin) {
-				// 蓖ĂɎsꍇ̏
-				MessageBox(nullptr, L"蓖Ďs", L"Error", MB_OK);
+				// メモリ割り当てに失敗した場合の処理
+				MessageBox(nullptr, L"メモリ割り当て失敗", L"Error", MB_OK);
 			}
 		}
 
+		/**
+		 * @brief 既存のメモリ領域を引き取ってチャンクを構築します。
+		 * @param _archetype このチャンクに関連付けられるアーキタイプ。
+		 * @param _pBuffer 引き取るメモリ領域。容量はGetCapacity()バイト以上必要。
+		 * @param _size 格納済みのエンティティ数。
+		 */
+		Chunk(const Archetype& _archetype, std::shared_ptr<std::byte[]> _pBuffer, const std::uint32_t _size)
+			: m_pArchetype(ArchetypeTable::Intern(_archetype)), m_Size(_size)
+		{
+			SetBuffer(std::move(_pBuffer), false);
+			m_MaxSize = CalculateMaxSize(*m_pArchetype);
+			m_bTriviallyCopyable = m_pArchetype->IsTriviallyCopyable();
+			if (m_Size > m_MaxSize)
+				std::abort();
+			m_ColumnVersions.assign(m_pArchetype->GetArchetypeSize() + 1, GlobalChangeVersion::Get());
+			m_StructureVersion = GlobalChangeVersion::Get();
+		}
+
+		/**
+		 * @brief コピーコンストラクタ。
+		 * @param _other 複製元のチャンク。
+		 * @note メモリ領域は複製せずに共有し、どちらかが書き込むときに複製する。
+		 */
 		Chunk(const Chunk& _other)
 		{
-			m_Archetype = _other.m_Archetype;
+			m_pArchetype = _other.m_pArchetype;
+			m_MaxSize = _other.m_MaxSize;
+			m_Size = _other.m_Size;
+			SetBuffer(_other.m_pBegin, false);
+			_other.m_bExclusive.store(false, std::memory_order_relaxed);
+			m_pCompressed = _other.m_pCompressed;
+			m_bResident.store(_other.m_bResident.load(std::memory_order_acquire), std::memory_order_relaxed);
+			m_RestoredVersion = _other.m_RestoredVersion;
+			m_ColumnVersions = _other.m_ColumnVersions;
+			m_StructureVersion = _other.m_StructureVersion;
+			m_bTriviallyCopyable = _other.m_bTriviallyCopyable;
+			m_SectionId = _other.m_SectionId;
+		}
+
+		/**
+		 * @brief ムーブコンストラクタ。
+		 * @param _other 移動元のチャンク。メモリ領域を手放し、空になる。アーキタイプは残る。
+		 * @note メモリ領域を共有していなければ、移した後も複製せずに書き込める。
+		 */
+		Chunk(Chunk&& _other) noexcept
+		{
+			m_pArchetype = _other.m_pArchetype;
+			m_MaxSize = _other.m_MaxSize;
+			m_Size = _other.m_Size;
+			SetBuffer(std::move(_other.m_pBegin), _other.m_bExclusive.load(std::memory_order_acquire));
+			m_pCompressed = std::move(_other.m_pCompressed);
+			m_bResident.store(_other.m_bResident.load(std::memory_order_acquire), std::memory_order_relaxed);
+			m_RestoredVersion = _other.m_RestoredVersion;
+			m_ColumnVersions = std::move(_other.m_ColumnVersions);
+			m_StructureVersion = _other.m_StructureVersion;
+			m_bTriviallyCopyable = _other.m_bTriviallyCopyable;
+			m_SectionId = _other.m_SectionId;
+
+			_other.SetBuffer(nullptr, false);
+			_other.m_bResident.store(true, std::memory_order_relaxed);
+			_other.m_Size = 0;
+		}
+
+		/**
+		 * @brief コピー代入演算子。
+		 * @param _other 複製元のチャンク。
+		 * @return Chunk& 自身。
+		 * @note メモリ領域は共有する。元のメモリ領域を最後に参照していた場合は、その行を破棄してから置き換える。
+		 */
+		Chunk& operator=(const Chunk& _other)
+		{
+			if (this == &_other)
+				return *this;
+			if (!m_bTriviallyCopyable && m_pBegin && m_pBegin.use_count() == 1)
+				DestroyComponents(0, m_Size);
+
+			m_pArchetype = _other.m_pArchetype;
 			m_MaxSize = _other.m_MaxSize;
 			m_Size = _other.m_Size;
-			m_pBegin = _other.m_pBegin;
+			SetBuffer(_other.m_pBegin, false);
+			_other.m_bExclusive.store(false, std::memory_order_relaxed);
+			m_pCompressed = _other.m_pCompressed;
+			m_bResident.store(_other.m_bResident.load(std::memory_order_acquire), std::memory_order_relaxed);
+			m_RestoredVersion = _other.m_RestoredVersion;
+			m_ColumnVersions = _other.m_ColumnVersions;
+			m_StructureVersion = _other.m_StructureVersion;
+			m_bTriviallyCopyable = _other.m_bTriviallyCopyable;
+			m_SectionId = _other.m_SectionId;
+			return *this;
+		}
+
+		/**
+		 * @brief デストラクタ。
+		 * @note メモリ領域を最後に参照しているチャンクが、トリビアルにコピーできないコンポーネントを破棄する。
+		 */
+		~Chunk()
+		{
+			if (!m_bTriviallyCopyable && m_pBegin && m_pBegin.use_count() == 1)
+				DestroyComponents(0, m_Size);
 		}
 
 		/**
-		 * @brief VGeBeB쐬A`Nɒǉ܂B
-		 * @param _chunkIndex GeBeB̃CfbNXB
-		 * @param _version GeBeB̃o[WB
-		 * @return 쐬ꂽ`NCfbNXB
+		 * @brief 新しいエンティティを作成し、チャンクに追加します。
+		 * @param _chunkIndex エンティティのインデックス。
+		 * @param _version エンティティのバージョン。
+		 * @return 作成されたチャンク内インデックス。
 		 */
 		std::uint32_t CreateEntity(const EntityIndex& _index, const EntityVersion& _version)
 		{
@@ -59,78 +166,108 @@ namespace ECS
 
 			const std::size_t indexOffset =
 				sizeof(Entity) * m_Size;
-			new (m_pBegin.get() + indexOffset) Entity(_index, _version);
+			new (GetMutableData() + indexOffset) Entity(_index, _version);
 
 			m_Size++;
+			MarkStructureChanged();
 			return m_Size - 1;
 		}
 
 		/**
-		 * @brief w肳ꂽCfbNX̃GeBeBj܂B
-		 * @param _chunkIndex jGeBeB̃`NCfbNXB
+		 * @brief 指定されたエンティティをまとめてチャンクの末尾に追加します。
+		 * @param _entities 追加するエンティティ。空きが足りない場合は異常終了する。
+		 * @return 先頭のエンティティのチャンク内インデックス。
+		 * @note コンポーネントの列は初期化しない。
+		 */
+		std::uint32_t CreateEntities(const Entity* _pEntities, const std::uint32_t _count)
+		{
+			if (_count > m_MaxSize - m_Size)
+				std::abort();
+
+			const std::uint32_t first = m_Size;
+			std::memcpy(GetMutableData() + sizeof(Entity) * first, _pEntities, sizeof(Entity) * _count);
+
+			m_Size += _count;
+			MarkStructureChanged();
+			return first;
+		}
+
+		/**
+		 * @brief 指定されたインデックスのエンティティを破棄します。
+		 * @param _chunkIndex 破棄するエンティティのチャンク内インデックス。
 		 */
 		void DestroyEntity(const std::size_t& _chunkIndex)
 		{
-			if (m_Size == 0)
+			if (_chunkIndex >= m_Size)
 				std::abort();
 
+			// 末尾のエンティティで穴を埋める
 			std::size_t sourceIndexOffset =
-				sizeof(Entity) * m_Size;
+				sizeof(Entity) * (m_Size - 1);
 			std::size_t destinationIndexOffset =
 				sizeof(Entity) * _chunkIndex;
 
 			void* sourceAddress = static_cast<void*>
-				(m_pBegin.get() + sourceIndexOffset);
+				(GetMutableData() + sourceIndexOffset);
 			void* destinationAddress = static_cast<void*>
-				(m_pBegin.get() + destinationIndexOffset);
+				(GetMutableData() + destinationIndexOffset);
 
 			memcpy(destinationAddress, sourceAddress, sizeof(Entity));
 
 			const std::size_t archetypeSize =
-				m_Archetype.GetArchetypeSize();
+				m_pArchetype->GetArchetypeSize();
 			for (std::size_t i = 0; i < archetypeSize; i++)
 			{
 				const std::size_t componentOffset =
-					(sizeof(Entity) + m_Archetype.GetMemroyOffsetByIndex(i)) * m_MaxSize;
+					CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize);
 				sourceIndexOffset =
-					m_Archetype.GetMemorySizeByIndex(i) * m_Size;
+					m_pArchetype->GetMemorySizeByIndex(i) * (m_Size - 1);
 				destinationIndexOffset =
-					m_Archetype.GetMemorySizeByIndex(i) * _chunkIndex;
+					m_pArchetype->GetMemorySizeByIndex(i) * _chunkIndex;
 
 				sourceAddress = static_cast<void*>
-					(m_pBegin.get() + componentOffset + sourceIndexOffset);
+					(GetMutableData() + componentOffset + sourceIndexOffset);
 				destinationAddress = static_cast<void*>
-					(m_pBegin.get() + componentOffset + destinationIndexOffset);
+					(GetMutableData() + componentOffset + destinationIndexOffset);
+
+				if (const ComponentFunctions* pFunctions = GetComponentFunctions(i))
+				{
+					pFunctions->m_pDestroy(static_cast<std::byte*>(destinationAddress), 1);
+					if (_chunkIndex != m_Size - 1)
+						pFunctions->m_pRelocate(static_cast<std::byte*>(destinationAddress),
+							static_cast<std::byte*>(sourceAddress), 1);
+					continue;
+				}
 
 				memcpy(destinationAddress, sourceAddress,
-					m_Archetype.GetMemorySizeByIndex(i));
+					m_pArchetype->GetMemorySizeByIndex(i));
 			}
 
 			m_Size--;
+			MarkStructureChanged();
 		}
 
 		/**
-		 * @brief GeBeB݂̃`Nʂ̃`NɈړ܂B
-		 * @param _chunkIndex ړGeBeB̃`NCfbNXB
-		 * @param _entity ړGeBeBB
-		 * @param _other ړ̃`NB
+		 * @brief エンティティを現在のチャンクから別のチャンクに移動します。
+		 * @param _chunkIndex 移動するエンティティのチャンク内インデックス。
+		 * @param _entity 移動するエンティティ。
+		 * @param _other 移動先のチャンク。
 		 */
 		void MoveEntity(std::size_t& _chunkIndex, Entity& _entity, Chunk& _other)
 		{
 			if (_chunkIndex >= m_Size)
 				std::abort();
 
-			if (m_Size == m_MaxSize && (m_MaxSize != 0))
+			if (_other.m_Size == _other.m_MaxSize)
 				std::abort();
 
 			EntityIndex oldChunkIndex = _chunkIndex;
 			EntityIndex newChunkIndex = _other.m_Size++;
 
-			std::size_t oldArchetypeSize = m_Archetype.GetArchetypeSize();
-			std::size_t newArchetypeSize = _other.m_Archetype.GetArchetypeSize();
+			std::size_t oldArchetypeSize = m_pArchetype->GetArchetypeSize();
+			std::size_t newArchetypeSize = _other.m_pArchetype->GetArchetypeSize();
 			std::size_t oldCompIndex = 0;
 			std::size_t newCompIndex = 0;
-			std::size_t moveCompCount = 0;
 
 			std::size_t sourceIndexOffset =
 				sizeof(Entity) * oldChunkIndex;
@@ -138,100 +275,118 @@ namespace ECS
 				sizeof(Entity) * newChunkIndex;
 
 			void* sourceAddress = static_cast<void*>
-				(m_pBegin.get() + sourceIndexOffset);
+				(GetMutableData() + sourceIndexOffset);
 			void* destinationAddress = static_cast<void*>
-				(_other.m_pBegin.get() + destinationIndexOffset);
+				(_other.GetMutableData() + destinationIndexOffset);
 
 			memcpy(destinationAddress, sourceAddress, sizeof(Entity));
 
 
-			for (newCompIndex = 0; newCompIndex < newArchetypeSize;)
+			// 両方とも型IDの昇順に並んでいるので、先頭から照合して共通のコンポーネントだけを移す。
+			// トリビアルにコピーできないものは、移動先にだけあれば構築し、移動元にだけあれば破棄する
+			while (oldCompIndex < oldArchetypeSize || newCompIndex < newArchetypeSize)
 			{
-				std::size_t oldCompId = m_Archetype.GetComponentIdByIndex(oldCompIndex);
-				std::size_t newCompId = _other.m_Archetype.GetComponentIdByIndex(newCompIndex);
-
-				while (1)
+				if (oldCompIndex == oldArchetypeSize || newCompIndex == newArchetypeSize)
 				{
-					if (oldCompId == newCompId)
-					{
-						const std::size_t sourceOffset =
-							(sizeof(Entity) + m_Archetype.GetMemroyOffsetByIndex(oldCompIndex)) * m_MaxSize;
-						const std::size_t destinationOffset =
-							(sizeof(Entity) + _other.m_Archetype.GetMemroyOffsetByIndex(newCompIndex)) * _other.m_MaxSize;
-						sourceIndexOffset =
-							m_Archetype.GetMemorySizeByIndex(oldCompIndex) * oldChunkIndex;
-						destinationIndexOffset =
-							_other.m_Archetype.GetMemorySizeByIndex(newCompIndex) * newChunkIndex;
-
-						sourceAddress = static_cast<void*>
-							(m_pBegin.get() + sourceOffset + sourceIndexOffset);
-						destinationAddress = static_cast<void*>
-							(_other.m_pBegin.get() + destinationOffset + destinationIndexOffset);
+					if (oldCompIndex < oldArchetypeSize)
+						DestroyComponents(oldCompIndex++, oldChunkIndex, 1);
+					else
+						_other.ConstructComponents(newCompIndex++, newChunkIndex, 1);
+					continue;
+				}
 
-						memcpy(destinationAddress, sourceAddress,
-							m_Archetype.GetMemorySizeByIndex(oldCompIndex));
+				const TypeId oldCompId = m_pArchetype->GetComponentIdByIndex(oldCompIndex);
+				const TypeId newCompId = _other.m_pArchetype->GetComponentIdByIndex(newCompIndex);
+
+				if (oldCompId == newCompId)
+				{
+					const std::size_t sourceOffset =
+						CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(oldCompIndex), m_MaxSize);
+					const std::size_t destinationOffset =
+						CalculateColumnOffset(_other.m_pArchetype->GetMemroyOffsetByIndex(newCompIndex), _other.m_MaxSize);
+					sourceIndexOffset =
+						m_pArchetype->GetMemorySizeByIndex(oldCompIndex) * oldChunkIndex;
+					destinationIndexOffset =
+						_other.m_pArchetype->GetMemorySizeByIndex(newCompIndex) * newChunkIndex;
 
+					sourceAddress = static_cast<void*>
+						(GetMutableData() + sourceOffset + sourceIndexOffset);
+					destinationAddress = static_cast<void*>
+						(_other.GetMutableData() + destinationOffset + destinationIndexOffset);
 
-						moveCompCount++;
-						newCompIndex++;
-						break;
-					}
-					else if (oldCompId < newCompId)
-					{
-						oldCompIndex++;
-						break;
-					}
+					if (const ComponentFunctions* pFunctions = GetComponentFunctions(oldCompIndex))
+						pFunctions->m_pRelocate(static_cast<std::byte*>(destinationAddress),
+							static_cast<std::byte*>(sourceAddress), 1);
 					else
-					{
-						newCompIndex++;
-						break;
-					}
-				}
+						memcpy(destinationAddress, sourceAddress,
+							m_pArchetype->GetMemorySizeByIndex(oldCompIndex));
 
-				if (moveCompCount == oldArchetypeSize) break;
+					oldCompIndex++;
+					newCompIndex++;
+				}
+				else if (oldCompId < newCompId)
+				{
+					DestroyComponents(oldCompIndex++, oldChunkIndex, 1);
+				}
+				else
+				{
+					_other.ConstructComponents(newCompIndex++, newChunkIndex, 1);
+				}
 			}
 
 			_chunkIndex = newChunkIndex;
 
+			// 末尾のエンティティで穴を埋める
 			sourceIndexOffset =
-				sizeof(Entity) * m_Size;
+				sizeof(Entity) * (m_Size - 1);
 			destinationIndexOffset =
 				sizeof(Entity) * oldChunkIndex;
 
 			sourceAddress = static_cast<void*>
-				(m_pBegin.get() + sourceIndexOffset);
+				(GetMutableData() + sourceIndexOffset);
 			destinationAddress = static_cast<void*>
-				(m_pBegin.get() + destinationIndexOffset);
+				(GetMutableData() + destinationIndexOffset);
 
 			memcpy(destinationAddress, sourceAddress, sizeof(Entity));
 
 			const std::size_t archetypeSize =
-				m_Archetype.GetArchetypeSize();
+				m_pArchetype->GetArchetypeSize();
 			for (std::size_t i = 0; i < archetypeSize; i++)
 			{
 				const std::size_t componentOffset =
-					(sizeof(Entity) + m_Archetype.GetMemroyOffsetByIndex(i)) * m_MaxSize;
+					CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize);
 				sourceIndexOffset =
-					m_Archetype.GetMemorySizeByIndex(i) * m_Size;
+					m_pArchetype->GetMemorySizeByIndex(i) * (m_Size - 1);
 				destinationIndexOffset =
-					m_Archetype.GetMemorySizeByIndex(i) * oldChunkIndex;
+					m_pArchetype->GetMemorySizeByIndex(i) * oldChunkIndex;
 
 				sourceAddress = static_cast<void*>
-					(m_pBegin.get() + componentOffset + sourceIndexOffset);
+					(GetMutableData() + componentOffset + sourceIndexOffset);
 				destinationAddress = static_cast<void*>
-					(m_pBegin.get() + componentOffset + destinationIndexOffset);
+					(GetMutableData() + componentOffset + destinationIndexOffset);
+
+				// 移動した行は移動元で破棄済みなので、末尾の行を移動して構築する
+				if (const ComponentFunctions* pFunctions = GetComponentFunctions(i))
+				{
+					if (oldChunkIndex != m_Size - 1)
+						pFunctions->m_pRelocate(static_cast<std::byte*>(destinationAddress),
+							static_cast<std::byte*>(sourceAddress), 1);
+					continue;
+				}
 
 				memcpy(destinationAddress, sourceAddress,
-					m_Archetype.GetMemorySizeByIndex(i));
+					m_pArchetype->GetMemorySizeByIndex(i));
 			}
 
 			m_Size--;
+			MarkStructureChanged();
+			_other.MarkStructureChanged();
 		}
 
 		/**
-		 * @brief w肳ꂽCfbNX̃GeBeBɃR|[lgf[^ݒ肵܂B
-		 * @param _chunkIndex R|[lgf[^ݒ肷GeBeB̃`NCfbNXB
-		 * @param _data ݒ肷R|[lgf[^B
+		 * @brief 指定されたインデックスのエンティティにコンポーネントデータを設定します。
+		 * @param _chunkIndex コンポーネントデータを設定するエンティティのチャンク内インデックス。
+		 * @param _data 設定するコンポーネントデータ。
 		 */
 		template <typename CompT>
 		void SetComponentData(const std::size_t& _chunkIndex, const CompT& _data)
@@ -240,16 +395,146 @@ namespace ECS
 				std::abort();
 
 			const std::size_t componentOffset =
-				(sizeof(Entity) + m_Archetype.GetMemoryOffset<CompT>()) * m_MaxSize;
+				CalculateColumnOffset(m_pArchetype->GetMemoryOffset<CompT>(), m_MaxSize);
 			const std::size_t indexOffset =
 				sizeof(CompT) * _chunkIndex;
-			std::memcpy(m_pBegin.get() + componentOffset
-				+ indexOffset, &_data, sizeof(CompT));
+			if constexpr (std::is_trivially_copyable_v<CompT>)
+				std::memcpy(GetMutableData() + componentOffset
+					+ indexOffset, &_data, sizeof(CompT));
+			else
+				*reinterpret_cast<CompT*>(GetMutableData() + componentOffset + indexOffset) = _data;
+			MarkComponentChanged<CompT>();
+		}
+
+		/**
+		 * @brief 指定範囲の行のコンポーネントを、別の行のコンポーネントの複製で埋めます。
+		 * @param _first 埋める範囲の先頭のチャンク内インデックス。
+		 * @param _count 埋める行数。
+		 * @param _source 複製元のチャンク。アーキタイプが一致している必要がある。
+		 * @param _sourceRow 複製元のチャンク内インデックス。
+		 * @note 列ごとに1要素を書き込んだ後、書き込み済みの範囲を倍々にコピーしていく。
+		 *		 埋める範囲は未構築の前提で、トリビアルにコピーできない列は複製を構築する。
+		 *		 変更の記録は行の追加時に済んでいる前提で行わない。
+		 */
+		void FillComponents(const std::uint32_t _first, const std::uint32_t _count,
+			const Chunk& _source, const std::uint32_t _sourceRow)
+		{
+			if (_first + _count > m_Size || _sourceRow >= _source.m_Size)
+				std::abort();
+
+			const std::size_t archetypeSize =
+				m_pArchetype->GetArchetypeSize();
+			for (std::size_t i = 0; i < archetypeSize; i++)
+			{
+				const std::size_t componentOffset =
+					CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize);
+				const std::size_t componentSize =
+					m_pArchetype->GetMemorySizeByIndex(i);
+
+				std::byte* destinationAddress =
+					GetMutableData() + componentOffset + componentSize * _first;
+
+				// トリビアルにコピーできないものは1行ずつ複製を構築する
+				if (const ComponentFunctions* pFunctions = GetComponentFunctions(i))
+				{
+					if (!pFunctions->m_pCopy)
+						std::abort();
+					const std::byte* sourceAddress =
+						_source.GetData() + componentOffset + componentSize * _sourceRow;
+					for (std::uint32_t row = 0; row < _count; row++)
+						pFunctions->m_pCopy(destinationAddress + componentSize * row, sourceAddress, 1);
+					continue;
+				}
+
+				std::memcpy(destinationAddress,
+					_source.GetData() + componentOffset + componentSize * _sourceRow, componentSize);
+
+				const std::size_t totalSize = componentSize * _count;
+				for (std::size_t filledSize = componentSize; filledSize < totalSize;)
+				{
+					const std::size_t copySize = (std::min)(filledSize, totalSize - filledSize);
+					std::memcpy(destinationAddress + filledSize, destinationAddress, copySize);
+					filledSize += copySize;
+				}
+			}
+		}
+
+		/**
+		 * @brief 指定範囲の行の、トリビアルにコピーできないコンポーネントを既定値で構築します。
+		 * @param _first 構築する範囲の先頭のチャンク内インデックス。
+		 * @param _count 構築する行数。
+		 * @note 行を追加しただけでは列は初期化されないので、値を書き込まない列に対して呼ぶ。
+		 *		 全てトリビアルにコピーできる場合は何もしない。
+		 */
+		void ConstructComponents(const std::uint32_t _first, const std::uint32_t _count)
+		{
+			if (m_bTriviallyCopyable)
+				return;
+
+			for (std::size_t i = 0; i < m_pArchetype->GetArchetypeSize(); i++)
+				ConstructComponents(i, _first, _count);
+		}
+
+		/**
+		 * @brief 同じアーキタイプのチャンクから行を集めて、新しいメモリ領域に並べ直します。
+		 * @param _pSourceBuffers 行ごとの複製元のメモリ領域。自身の並べ替え前の領域も指定できる。
+		 * @param _pSourceRows 行ごとの複製元のチャンク内インデックス。
+		 * @return std::shared_ptr<std::byte[]> 並べ替え前のメモリ領域。
+		 *		   他のチャンクの複製元になっている場合は、それらの並べ替えが終わるまで保持する。
+		 *		   トリビアルにコピーできないコンポーネントは移動済みなので、破棄は不要。
+		 * @note 行数は変わらない。列ごとに行を集めるので書き込み先は連続する。
+		 */
+		std::shared_ptr<std::byte[]> GatherRows(
+			const std::byte* const* _pSourceBuffers, const std::uint32_t* _pSourceRows)
+		{
+			EnsureResident();
+			std::shared_ptr<std::byte[]> pBuffer = AllocateBuffer();
+
+			Entity* pEntities = reinterpret_cast<Entity*>(pBuffer.get());
+			for (std::uint32_t i = 0; i < m_Size; i++)
+			{
+				std::memcpy(pEntities + i,
+					_pSourceBuffers[i] + sizeof(Entity) * _pSourceRows[i], sizeof(Entity));
+			}
+
+			const std::size_t archetypeSize =
+				m_pArchetype->GetArchetypeSize();
+			for (std::size_t column = 0; column < archetypeSize; column++)
+			{
+				const std::size_t componentOffset =
+					CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(column), m_MaxSize);
+				const std::size_t componentSize =
+					m_pArchetype->GetMemorySizeByIndex(column);
+				if (componentSize == 0)
+					continue;
+
+				std::byte* destinationAddress = pBuffer.get() + componentOffset;
+				if (const ComponentFunctions* pFunctions = GetComponentFunctions(column))
+				{
+					// 複製元の各行は1度しか集めないので、移動して構築してよい
+					for (std::uint32_t i = 0; i < m_Size; i++)
+					{
+						pFunctions->m_pRelocate(destinationAddress + componentSize * i,
+							const_cast<std::byte*>(_pSourceBuffers[i]) + componentOffset + componentSize * _pSourceRows[i], 1);
+					}
+					continue;
+				}
+				for (std::uint32_t i = 0; i < m_Size; i++)
+				{
+					std::memcpy(destinationAddress + componentSize * i,
+						_pSourceBuffers[i] + componentOffset + componentSize * _pSourceRows[i], componentSize);
+				}
+			}
+
+			std::shared_ptr<std::byte[]> pPrevious = std::move(m_pBegin);
+			SetBuffer(std::move(pBuffer), true);
+			MarkStructureChanged();
+			return pPrevious;
 		}
 
 		/**
-		 * @brief `NőTCYɒBĂ邩ǂ𔻒f܂B
-		 * @return bool `NőTCYɒBĂꍇtrueB
+		 * @brief チャンクが最大サイズに達しているかどうかを判断します。
+		 * @return bool チャンクが最大サイズに達している場合はtrue。
 		 */
 		const bool IsMax() const noexcept
 		{
@@ -257,37 +542,287 @@ namespace ECS
 		}
 
 		/**
-		 * @brief A[L^Cv擾܂B
-		 * @return Archetype& ֘AtꂽA[L^CvB
+		 * @brief アーキタイプを取得します。
+		 * @return const Archetype& 関連付けられたアーキタイプ。
 		 */
-		Archetype& GetArchetype()
+		const Archetype& GetArchetype() const noexcept
 		{
-			return m_Archetype;
+			return *m_pArchetype;
 		}
 
 		/**
-		* @brief w̃R|[lgXg擾܂B
-		* @return ComponentArray<CompT> w̌^̃R|[lgXgB
+		* @brief 指定のコンポーネントリストを取得します。
+		* @return ComponentArray<CompT> 指定の型のコンポーネントリスト。
 		*/
 		template <typename CompT>
 		ComponentArray<CompT> GetComponentList()
 		{
-			Archetype arche;
-			arche.AddType<CompT>();
-			if (!m_Archetype.IsContain(arche))
+			if (!m_pArchetype->HasType<CompT>())
 				std::abort();
 
 			using TType = std::remove_const_t<std::remove_reference_t<CompT>>;
 
+			// constでない型で取得した場合は書き込まれるものとして扱い、共有しているメモリ領域は複製する
+			std::byte* pBegin = nullptr;
+			if constexpr (!std::is_const_v<std::remove_reference_t<CompT>>)
+			{
+				MarkComponentChanged<TType>();
+				pBegin = GetMutableData();
+			}
+			else
+			{
+				pBegin = GetData();
+			}
+
 			auto offset =
-				(sizeof(Entity) + m_Archetype.GetMemoryOffset<CompT>()) * m_MaxSize;
+				CalculateColumnOffset(m_pArchetype->GetMemoryOffset<CompT>(), m_MaxSize);
 
-			return ComponentArray<CompT>(reinterpret_cast<TType*>(m_pBegin.get() + (std::size_t)offset), m_Size);
+			return ComponentArray<CompT>(reinterpret_cast<TType*>(pBegin + (std::size_t)offset), m_Size);
+		}
+
+		/**
+		 * @brief 指定されたインデックスのエンティティを取得します。
+		 * @param _chunkIndex チャンク内インデックス。
+		 * @return const Entity& エンティティ。
+		 */
+		const Entity& GetEntity(const std::size_t _chunkIndex) const
+		{
+			if (_chunkIndex >= m_Size)
+				std::abort();
+
+			return reinterpret_cast<const Entity*>(GetData())[_chunkIndex];
+		}
+
+		/**
+		 * @brief チャンクの構成(エンティティの追加、削除、移動)が最後に変更されたバージョンを取得します。
+		 * @return ChangeVersion 変更バージョン。
+		 */
+		ChangeVersion GetStructureVersion() const noexcept
+		{
+			return m_StructureVersion;
+		}
+
+		/**
+		 * @brief 列が最後に書き込まれたバージョンを取得します。
+		 * @param _columnIndex 列のインデックス。0がEntityの列で、以降はアーキタイプ内のコンポーネント順。
+		 * @return ChangeVersion 変更バージョン。
+		 */
+		ChangeVersion GetColumnVersion(const std::size_t _columnIndex) const
+		{
+			// ComponentLookupからは複数のスレッドが同じ列の記録を読み書きするので、不可分に読む
+			return std::atomic_ref<ChangeVersion>(const_cast<ChangeVersion&>(m_ColumnVersions[_columnIndex]))
+				.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief 指定されたコンポーネントの列が書き込まれたことを記録します。
+		 * @tparam CompT 書き込まれたコンポーネントの型。
+		 */
+		template <typename CompT>
+		void MarkComponentChanged()
+		{
+			MarkColumnChanged(m_pArchetype->GetComponentIndex<CompT>() + 1);
+		}
+
+		/**
+		 * @brief チャンクが属するセクションを取得します。
+		 * @return SectionId セクションの識別ID。どのセクションにも属さない場合は0。
+		 */
+		SectionId GetSectionId() const noexcept
+		{
+			return m_SectionId;
+		}
+
+		/**
+		 * @brief チャンクが属するセクションを設定します。
+		 * @param _sectionId セクションの識別ID。0でどのセクションにも属さない。
+		 * @note セクションに属するチャンクには、新しいエンティティを追加しない。
+		 */
+		void SetSectionId(const SectionId _sectionId) noexcept
+		{
+			m_SectionId = _sectionId;
+		}
+
+		/**
+		 * @brief 列が書き込まれたことを記録します。
+		 * @param _columnIndex 列のインデックス。0がEntityの列で、以降はアーキタイプ内のコンポーネント順。
+		 */
+		void MarkColumnChanged(const std::size_t _columnIndex)
+		{
+			std::atomic_ref<ChangeVersion>(m_ColumnVersions[_columnIndex])
+				.store(GlobalChangeVersion::Get(), std::memory_order_relaxed);
 		}
 
 		/**
-		 * @brief `ÑGeBeB擾܂B
-		 * @return std::uint32_t `ÑGeBeBB
+		 * @brief チャンクの構成が変わったことを記録します。行が動くので全ての列も変更扱いにする。
+		 */
+		void MarkStructureChanged()
+		{
+			const ChangeVersion version = GlobalChangeVersion::Get();
+			m_StructureVersion = version;
+			for (auto&& columnVersion : m_ColumnVersions)
+				columnVersion = version;
+		}
+
+		/**
+		 * @brief 列を圧縮し、メモリ領域を解放します。
+		 * @return bool 圧縮した場合はtrue。
+		 * @note 全てトリビアルにコピーできるチャンクで、メモリ領域を他のチャンクと共有していない場合だけ圧縮する。
+		 *		 WorldForkやRollbackRingが保持しているチャンクは、圧縮しても分岐側がメモリ領域を
+		 *		 持ったままで解放にならないので圧縮しない。書き込んで複製した後は対象になる。
+		 *		 格納済みの行だけを列ごとに圧縮するので、空いている行の分も縮む。
+		 *		 圧縮後にメモリ領域に触れると、その場で展開する。他のスレッドが触れている間に呼ばないこと。
+		 */
+		bool Compress()
+		{
+			if (!m_bResident.load(std::memory_order_relaxed) || !m_bTriviallyCopyable || m_pBegin.use_count() != 1)
+				return false;
+
+			auto pCompressed = std::make_shared<std::vector<std::byte>>();
+			const std::byte* pBegin = m_pBegin.get();
+			ColumnCodec::Encode(pBegin, m_Size, sizeof(Entity), *pCompressed);
+			for (std::size_t i = 0; i < m_pArchetype->GetArchetypeSize(); i++)
+			{
+				const std::size_t componentSize = m_pArchetype->GetMemorySizeByIndex(i);
+				if (componentSize == 0)
+					continue;
+				ColumnCodec::Encode(pBegin + CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize),
+					m_Size, componentSize, *pCompressed);
+			}
+
+			// 縮まない場合はそのまま残す
+			if (pCompressed->size() >= mc_Capacity)
+				return false;
+
+			pCompressed->shrink_to_fit();
+			m_pCompressed = std::move(pCompressed);
+			SetBuffer(nullptr, false);
+			m_bResident.store(false, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief 圧縮されている場合は展開します。
+		 */
+		void Decompress() const
+		{
+			EnsureResident();
+		}
+
+		/**
+		 * @brief 圧縮されているかどうかを取得します。
+		 * @return bool 圧縮されている場合はtrue。
+		 */
+		bool IsCompressed() const noexcept
+		{
+			return !m_bResident.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief 圧縮後のサイズを取得します。
+		 * @return std::size_t 圧縮後のサイズ[byte]。圧縮されていない場合は0。
+		 */
+		std::size_t GetCompressedSize() const noexcept
+		{
+			return IsCompressed() ? m_pCompressed->capacity() : 0;
+		}
+
+		/**
+		 * @brief 最後に書き込まれたか、展開されたバージョンを取得します。
+		 * @return ChangeVersion 変更バージョン。
+		 * @note 読み取りだけの参照は記録しないが、圧縮中に触れると展開した時点が残る。
+		 */
+		ChangeVersion GetLastTouchedVersion() const noexcept
+		{
+			ChangeVersion version = (std::max)(m_StructureVersion, m_RestoredVersion);
+			for (auto&& columnVersion : m_ColumnVersions)
+				version = (std::max)(version, columnVersion);
+			return version;
+		}
+
+		/**
+		 * @brief チャンクのメモリ領域の先頭を、書き込み用に取得します。
+		 * @return std::byte* チャンクのメモリ領域の先頭。
+		 * @note 直接書き込んだ場合は、変更の記録は呼び出し側で行う。
+		 *		 他のチャンクとメモリ領域を共有している場合は、複製してから返す。
+		 */
+		std::byte* GetBuffer() noexcept
+		{
+			return GetMutableData();
+		}
+
+		/**
+		 * @brief チャンクのメモリ領域の先頭を取得します。
+		 * @return const std::byte* チャンクのメモリ領域の先頭。
+		 */
+		const std::byte* GetBuffer() const noexcept
+		{
+			return GetData();
+		}
+
+		/**
+		 * @brief チャンクのメモリ領域の内容を、圧縮されていても展開せずに読み取ります。
+		 * @param _pScratch 圧縮されている場合に展開する作業領域。チャンクの容量以上の大きさが必要。
+		 * @return const std::byte* 展開済みの場合はチャンクのメモリ領域、圧縮されている場合は_pScratch。
+		 * @note チャンクは圧縮されたまま残る。格納済みでない行の内容は不定。
+		 */
+		const std::byte* PeekBuffer(std::byte* _pScratch) const
+		{
+			if (m_bResident.load(std::memory_order_acquire))
+				return m_pData.load(std::memory_order_acquire);
+
+			std::lock_guard<std::mutex> lock(GetRestoreMutex());
+			if (m_bResident.load(std::memory_order_relaxed))
+				return m_pData.load(std::memory_order_relaxed);
+
+			DecodeColumns(_pScratch);
+			return _pScratch;
+		}
+
+		/**
+		 * @brief チャンクの容量を取得します。
+		 * @return std::uint32_t チャンクの容量[byte]。
+		 */
+		static constexpr std::uint32_t GetCapacity() noexcept
+		{
+			return mc_Capacity;
+		}
+
+		/**
+		 * @brief アーキタイプから1チャンクに格納できるエンティティ数を求めます。
+		 * @param _archetype 対象のアーキタイプ。
+		 * @return std::uint32_t 1チャンクに格納できるエンティティ数。
+		 */
+		static constexpr std::uint32_t CalculateMaxSize(const Archetype& _archetype) noexcept
+		{
+			return static_cast<std::uint32_t>(
+				mc_Capacity / (sizeof(Entity) + _archetype.GetArchetypeMemorySize()));
+		}
+
+		/**
+		 * @brief チャンクの先頭からコンポーネントの列までのオフセットを求めます。
+		 * @param _memoryOffset アーキタイプ内でのコンポーネントのメモリオフセット。
+		 * @param _maxSize チャンクの最大サイズ。
+		 * @return std::size_t コンポーネントの列までのオフセット。
+		 */
+		static constexpr std::size_t CalculateColumnOffset(
+			const std::size_t _memoryOffset, const std::uint32_t _maxSize) noexcept
+		{
+			return (sizeof(Entity) + _memoryOffset) * _maxSize;
+		}
+
+		/**
+		 * @brief チャンクに格納できるエンティティ数を取得します。
+		 * @return std::uint32_t チャンクの最大サイズ。
+		 */
+		const std::uint32_t GetMaxSize() const noexcept
+		{
+			return m_MaxSize;
+		}
+
+		/**
+		 * @brief チャンク内のエンティティ数を取得します。
+		 * @return std::uint32_t チャンク内のエンティティ数。
 		 */
 		const std::uint32_t GetSize() const noexcept
 		{
@@ -296,8 +831,216 @@ namespace ECS
 
 	private:
 		/**
-		 * @brief `N󂩂ǂ𔻒f܂B
-		 * @return bool `N̏ꍇtrueB
+		 * @brief コンポーネントの関数テーブルを取得します。
+		 * @param _componentIndex アーキタイプ内でのコンポーネントのインデックス。
+		 * @return const ComponentFunctions* 関数テーブル。トリビアルにコピー可能な場合はnullptr。
+		 * @note 全てトリビアルにコピー可能なチャンクではテーブルを引かずにmemcpyの経路に進む。
+		 */
+		const ComponentFunctions* GetComponentFunctions(const std::size_t _componentIndex) const
+		{
+			return m_bTriviallyCopyable ? nullptr : m_pArchetype->GetComponentFunctionsByIndex(_componentIndex);
+		}
+
+		/**
+		 * @brief 列の指定範囲の行を既定値で構築します。トリビアルにコピーできる列では何もしない。
+		 * @param _componentIndex アーキタイプ内でのコンポーネントのインデックス。
+		 * @param _first 構築する範囲の先頭のチャンク内インデックス。
+		 * @param _count 構築する行数。
+		 */
+		void ConstructComponents(const std::size_t _componentIndex, const std::uint32_t _first, const std::uint32_t _count)
+		{
+			const ComponentFunctions* pFunctions = GetComponentFunctions(_componentIndex);
+			if (!pFunctions)
+				return;
+			if (!pFunctions->m_pConstruct)
+				std::abort();
+
+			const std::size_t componentSize = m_pArchetype->GetMemorySizeByIndex(_componentIndex);
+			pFunctions->m_pConstruct(GetMutableData() +
+				CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(_componentIndex), m_MaxSize) +
+				componentSize * _first, _count);
+		}
+
+		/**
+		 * @brief 列の指定範囲の行を破棄します。トリビアルにコピーできる列では何もしない。
+		 * @param _componentIndex アーキタイプ内でのコンポーネントのインデックス。
+		 * @param _first 破棄する範囲の先頭のチャンク内インデックス。
+		 * @param _count 破棄する行数。
+		 */
+		void DestroyComponents(const std::size_t _componentIndex, const std::uint32_t _first, const std::uint32_t _count)
+		{
+			const ComponentFunctions* pFunctions = GetComponentFunctions(_componentIndex);
+			if (!pFunctions)
+				return;
+
+			const std::size_t componentSize = m_pArchetype->GetMemorySizeByIndex(_componentIndex);
+			pFunctions->m_pDestroy(GetMutableData() +
+				CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(_componentIndex), m_MaxSize) +
+				componentSize * _first, _count);
+		}
+
+		/**
+		 * @brief 指定範囲の行の、トリビアルにコピーできないコンポーネントを全て破棄します。
+		 * @param _first 破棄する範囲の先頭のチャンク内インデックス。
+		 * @param _count 破棄する行数。
+		 */
+		void DestroyComponents(const std::uint32_t _first, const std::uint32_t _count)
+		{
+			for (std::size_t i = 0; i < m_pArchetype->GetArchetypeSize(); i++)
+				DestroyComponents(i, _first, _count);
+		}
+
+		/**
+		 * @brief メモリ領域の先頭を取得します。圧縮されている場合は展開する。
+		 * @return std::byte* メモリ領域の先頭。
+		 */
+		std::byte* GetData() const
+		{
+			EnsureResident();
+			return m_pData.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief 書き込み用にメモリ領域の先頭を取得します。
+		 * @return std::byte* メモリ領域の先頭。
+		 * @note 他のチャンクとメモリ領域を共有している場合は、書き込む前に複製して共有をやめる。
+		 *		 同じチャンクの別の列に並列に書き込むスレッドがあっても、複製は排他して1度だけ行う。
+		 *		 複製前に読み取りで取得した先頭は、共有元が残っている間は同じ内容のまま読める。
+		 */
+		std::byte* GetMutableData()
+		{
+			EnsureResident();
+			if (!m_bExclusive.load(std::memory_order_acquire))
+			{
+				std::lock_guard<std::mutex> lock(GetRestoreMutex());
+				if (!m_bExclusive.load(std::memory_order_relaxed))
+				{
+					if (m_pBegin.use_count() > 1)
+						CloneBuffer();
+					else
+						m_bExclusive.store(true, std::memory_order_release);
+				}
+			}
+			return m_pData.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief 共有しているメモリ領域を複製し、このチャンクだけのものにします。
+		 * @note 共有元は他のチャンクが参照したまま残る。GetRestoreMutex()を取得して呼ぶ。
+		 */
+		void CloneBuffer()
+		{
+			std::shared_ptr<std::byte[]> pBuffer = AllocateBuffer();
+			if (m_bTriviallyCopyable)
+			{
+				std::memcpy(pBuffer.get(), m_pBegin.get(), mc_Capacity);
+				SetBuffer(std::move(pBuffer), true);
+				return;
+			}
+
+			// トリビアルにコピーできないものは、格納済みの行だけ複製を構築する
+			std::memcpy(pBuffer.get(), m_pBegin.get(), sizeof(Entity) * m_Size);
+			for (std::size_t i = 0; i < m_pArchetype->GetArchetypeSize(); i++)
+			{
+				const std::size_t componentOffset =
+					CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize);
+				const std::size_t componentSize = m_pArchetype->GetMemorySizeByIndex(i);
+				if (const ComponentFunctions* pFunctions = GetComponentFunctions(i))
+				{
+					if (!pFunctions->m_pCopy)
+						std::abort();
+					pFunctions->m_pCopy(pBuffer.get() + componentOffset, m_pBegin.get() + componentOffset, m_Size);
+					continue;
+				}
+				std::memcpy(pBuffer.get() + componentOffset, m_pBegin.get() + componentOffset, componentSize * m_Size);
+			}
+			SetBuffer(std::move(pBuffer), true);
+		}
+
+		/**
+		 * @brief 圧縮されている場合は展開します。
+		 * @note 複数のスレッドから同時に触れられても、展開は1度だけ行う。
+		 */
+		void EnsureResident() const
+		{
+			if (m_bResident.load(std::memory_order_acquire))
+				return;
+
+			std::lock_guard<std::mutex> lock(GetRestoreMutex());
+			if (m_bResident.load(std::memory_order_relaxed))
+				return;
+
+			std::shared_ptr<std::byte[]> pBuffer = AllocateBuffer();
+			DecodeColumns(pBuffer.get());
+
+			SetBuffer(std::move(pBuffer), true);
+			m_pCompressed.reset();
+			m_RestoredVersion = GlobalChangeVersion::Get();
+			m_bResident.store(true, std::memory_order_release);
+		}
+
+		/**
+		 * @brief メモリ領域を置き換えます。
+		 * @param _pBuffer 新しいメモリ領域。
+		 * @param _bExclusive 他のチャンクとメモリ領域を共有していない場合はtrue。
+		 */
+		void SetBuffer(std::shared_ptr<std::byte[]> _pBuffer, const bool _bExclusive) const
+		{
+			m_pBegin = std::move(_pBuffer);
+			m_pData.store(m_pBegin.get(), std::memory_order_release);
+			m_bExclusive.store(_bExclusive, std::memory_order_release);
+		}
+
+		/**
+		 * @brief 圧縮した列を指定のメモリ領域に展開します。
+		 * @param _pDestination 展開先。チャンクの容量以上の大きさが必要。
+		 * @note 展開の排他はGetRestoreMutex()で呼び出し側が行う。
+		 */
+		void DecodeColumns(std::byte* _pDestination) const
+		{
+			const std::byte* pInput = m_pCompressed->data();
+			const std::byte* const pInputEnd = pInput + m_pCompressed->size();
+			const auto decode = [&](std::byte* _pColumn, const std::size_t _elementSize)
+				{
+					const std::size_t readSize = ColumnCodec::Decode(pInput, pInputEnd - pInput, _pColumn, m_Size, _elementSize);
+					if (readSize == 0)
+						std::abort();
+					pInput += readSize;
+				};
+
+			decode(_pDestination, sizeof(Entity));
+			for (std::size_t i = 0; i < m_pArchetype->GetArchetypeSize(); i++)
+			{
+				const std::size_t componentSize = m_pArchetype->GetMemorySizeByIndex(i);
+				if (componentSize != 0)
+					decode(_pDestination + CalculateColumnOffset(m_pArchetype->GetMemroyOffsetByIndex(i), m_MaxSize), componentSize);
+			}
+		}
+
+		/**
+		 * @brief 展開と複製の排他に使うミューテックスを取得します。
+		 * @return std::mutex& チャンクのアドレスで選んだミューテックス。他のチャンクと共用することがある。
+		 */
+		std::mutex& GetRestoreMutex() const noexcept
+		{
+			static std::mutex restoreMutexes[mc_RestoreMutexCount];
+			return restoreMutexes[(reinterpret_cast<std::uintptr_t>(this) / alignof(Chunk)) % mc_RestoreMutexCount];
+		}
+
+		/**
+		 * @brief チャンクのメモリ領域を確保します。
+		 * @return std::shared_ptr<std::byte[]> 確保したメモリ領域。
+		 */
+		static std::shared_ptr<std::byte[]> AllocateBuffer()
+		{
+			return std::shared_ptr<std::byte[]>(
+				static_cast<std::byte*>(_aligned_malloc(mc_Capacity, cMaxComponentAlignment)),
+				[](std::byte* ptr) { _aligned_free(ptr); });
+		}
+
+		/**
+		 * @brief チャンクが空かどうかを判断します。
+		 * @return bool チャンクが空の場合はtrue。
 		 */
 		const bool IsEmpty() const noexcept
 		{
@@ -305,15 +1048,38 @@ namespace ECS
 		}
 
 	private:
-		//! ̃`NɊ֘AtA[L^CvB
-		Archetype m_Archetype;
-		//! `Ñf[^i[|C^B
-		std::shared_ptr<std::byte[]> m_pBegin = nullptr;
-		//! `ÑGeBeBB
+		//! このチャンクに関連付けられるアーキタイプ。ArchetypeTable::Intern()の実体を指す。
+		const Archetype* m_pArchetype = nullptr;
+		//! チャンクのデータを格納するポインタ。圧縮中はnullptr。
+		mutable std::shared_ptr<std::byte[]> m_pBegin = nullptr;
+		//! m_pBeginの先頭。複製と並行して読み取れるように、先頭の取得はこちらから行う。
+		mutable std::atomic<std::byte*> m_pData = nullptr;
+		//! メモリ領域を他のチャンクと共有していないことが分かっているかどうか。
+		mutable std::atomic<bool> m_bExclusive = false;
+		//! 圧縮した列。展開したら解放する。
+		mutable std::shared_ptr<const std::vector<std::byte>> m_pCompressed;
+		//! メモリ領域が展開されているかどうか。
+		mutable std::atomic<bool> m_bResident = true;
+		//! 最後に展開した変更バージョン。
+		mutable ChangeVersion m_RestoredVersion = 0;
+		//! チャンク内のエンティティ数。
 		std::uint32_t m_Size;
-		//! `N̍őTCYB
+		//! チャンクの最大サイズ。
 		std::uint32_t m_MaxSize;
-		//! `N̗eʁB
+		//! 各列が最後に書き込まれた変更バージョン。先頭はEntityの列。
+		std::vector<ChangeVersion> m_ColumnVersions;
+		//! チャンクの構成が最後に変更された変更バージョン。
+		ChangeVersion m_StructureVersion = 0;
+		//! 全てのコンポーネントがトリビアルにコピー可能かどうか。falseの場合だけ関数テーブルを引く。
+		bool m_bTriviallyCopyable = true;
+		//! 属するセクションの識別ID。0はどのセクションにも属さない。
+		SectionId m_SectionId = 0;
+		//! チャンクの容量。
 		static constexpr std::uint32_t mc_Capacity = 4096*4;
+		//! 展開を直列化するロックの数。チャンクのアドレスで振り分ける。
+		static constexpr std::size_t mc_RestoreMutexCount = 64;
 	};
-}
\ No newline at end of file
+
+	//! ワールドのチャンクの配列。追加しても既存のチャンクへの参照は無効にならない。
+	using ChunkList = std::deque<Chunk>;
+}
@@ -0,0 +1,228 @@
+#include "ColumnCodec.h"
+
+#include <cstring>
+#include <algorithm>
+
+namespace ECS
+{
+	namespace
+	{
+		/**
+		* @brief 4バイトを読み込みます。
+		* @param _p 読み込む位置。
+		* @return std::uint32_t 読み込んだ値。
+		*/
+		inline std::uint32_t Read32(const std::uint8_t* _p) noexcept
+		{
+			std::uint32_t value;
+			std::memcpy(&value, _p, sizeof(value));
+			return value;
+		}
+
+		/**
+		* @brief 長さの15以上の部分を、255ずつ区切って書き込みます。
+		* @param _length 書き込む長さ。15を引いた残り。
+		* @param _output 出力先。
+		*/
+		inline void WriteExtraLength(std::size_t _length, std::vector<std::byte>& _output)
+		{
+			for (; _length >= 255; _length -= 255)
+				_output.push_back(std::byte(255));
+			_output.push_back(static_cast<std::byte>(_length));
+		}
+
+		/**
+		* @brief 長さの15以上の部分を読み込みます。
+		* @param _pInput 読み込む位置。読んだ分だけ進める。
+		* @param _pEnd 入力の終端。
+		* @param _length 読み込んだ分を足す長さ。
+		* @return bool 終端を越えずに読めた場合はtrue。
+		*/
+		inline bool ReadExtraLength(const std::uint8_t*& _pInput, const std::uint8_t* _pEnd, std::size_t& _length)
+		{
+			std::uint8_t value = 0;
+			do
+			{
+				if (_pInput == _pEnd)
+					return false;
+				value = *_pInput++;
+				_length += value;
+			} while (value == 255);
+			return true;
+		}
+	}
+
+	void ColumnCodec::Encode(const std::byte* _pData, const std::size_t _count, const std::size_t _elementSize,
+		std::vector<std::byte>& _output)
+	{
+		const std::size_t size = _count * _elementSize;
+
+		// 要素のi番目のバイトを集めて並べる
+		thread_local std::vector<std::uint8_t> shuffled;
+		shuffled.resize(size);
+		const std::uint8_t* pSource = reinterpret_cast<const std::uint8_t*>(_pData);
+		for (std::size_t byteIndex = 0; byteIndex < _elementSize; byteIndex++)
+		{
+			std::uint8_t* pDestination = shuffled.data() + byteIndex * _count;
+			for (std::size_t i = 0; i < _count; i++)
+				pDestination[i] = pSource[i * _elementSize + byteIndex];
+		}
+
+		// 先頭に形式とサイズを置く。縮まなければ並べ替えたまま格納する
+		const std::size_t headerOffset = _output.size();
+		_output.resize(headerOffset + 1 + sizeof(std::uint32_t));
+		Compress(shuffled.data(), size, _output);
+
+		std::uint8_t mode = mc_Compressed;
+		std::uint32_t payloadSize = static_cast<std::uint32_t>(_output.size() - headerOffset - 1 - sizeof(std::uint32_t));
+		if (payloadSize >= size)
+		{
+			mode = mc_Stored;
+			payloadSize = static_cast<std::uint32_t>(size);
+			_output.resize(headerOffset + 1 + sizeof(std::uint32_t) + size);
+			std::memcpy(_output.data() + headerOffset + 1 + sizeof(std::uint32_t), shuffled.data(), size);
+		}
+		_output[headerOffset] = static_cast<std::byte>(mode);
+		std::memcpy(_output.data() + headerOffset + 1, &payloadSize, sizeof(payloadSize));
+	}
+
+	std::size_t ColumnCodec::Decode(const std::byte* _pInput, const std::size_t _inputSize,
+		std::byte* _pData, const std::size_t _count, const std::size_t _elementSize)
+	{
+		constexpr std::size_t headerSize = 1 + sizeof(std::uint32_t);
+		if (_inputSize < headerSize)
+			return 0;
+
+		const std::uint8_t mode = static_cast<std::uint8_t>(_pInput[0]);
+		std::uint32_t payloadSize = 0;
+		std::memcpy(&payloadSize, _pInput + 1, sizeof(payloadSize));
+		if (payloadSize > _inputSize - headerSize)
+			return 0;
+
+		const std::size_t size = _count * _elementSize;
+		const std::uint8_t* pPayload = reinterpret_cast<const std::uint8_t*>(_pInput + headerSize);
+		thread_local std::vector<std::uint8_t> shuffled;
+		shuffled.resize(size);
+		if (mode == mc_Stored)
+		{
+			if (payloadSize != size)
+				return 0;
+			std::memcpy(shuffled.data(), pPayload, size);
+		}
+		else if (mode != mc_Compressed || !Decompress(pPayload, payloadSize, shuffled.data(), size))
+		{
+			return 0;
+		}
+
+		// バイト位置ごとの並びを要素の並びに戻す
+		std::uint8_t* pDestination = reinterpret_cast<std::uint8_t*>(_pData);
+		for (std::size_t byteIndex = 0; byteIndex < _elementSize; byteIndex++)
+		{
+			const std::uint8_t* pSource = shuffled.data() + byteIndex * _count;
+			for (std::size_t i = 0; i < _count; i++)
+				pDestination[i * _elementSize + byteIndex] = pSource[i];
+		}
+		return headerSize + payloadSize;
+	}
+
+	void ColumnCodec::Compress(const std::uint8_t* _pInput, const std::size_t _size, std::vector<std::byte>& _output)
+	{
+		// 位置+1を入れる。0は空き
+		std::uint32_t table[std::size_t(1) << mc_HashBits] = {};
+
+		// 1つの区切りは、トークンの上位4ビットがリテラル長、下位4ビットが一致長-mc_MinMatch。
+		// どちらも15以上は後ろに255ずつ続ける。リテラルの後に2バイトの距離を置き、最後の区切りはリテラルだけで終わる
+		const auto emit = [&_output, _pInput](const std::size_t _anchor, const std::size_t _literalLength,
+			const std::size_t _offset, const std::size_t _matchLength)
+			{
+				const std::size_t matchCode = _matchLength >= mc_MinMatch ? _matchLength - mc_MinMatch : 0;
+				_output.push_back(static_cast<std::byte>(
+					((std::min)(_literalLength, std::size_t(15)) << 4) | (std::min)(matchCode, std::size_t(15))));
+				if (_literalLength >= 15)
+					WriteExtraLength(_literalLength - 15, _output);
+				const std::byte* pLiterals = reinterpret_cast<const std::byte*>(_pInput + _anchor);
+				_output.insert(_output.end(), pLiterals, pLiterals + _literalLength);
+				if (_matchLength == 0)
+					return;
+
+				_output.push_back(static_cast<std::byte>(_offset & 0xFF));
+				_output.push_back(static_cast<std::byte>(_offset >> 8));
+				if (matchCode >= 15)
+					WriteExtraLength(matchCode - 15, _output);
+			};
+
+		std::size_t anchor = 0;
+		std::size_t i = 0;
+		while (i + mc_MinMatch <= _size)
+		{
+			const std::uint32_t value = Read32(_pInput + i);
+			const std::uint32_t hash = (value * 2654435761u) >> (32 - mc_HashBits);
+			const std::uint32_t candidate = table[hash];
+			table[hash] = static_cast<std::uint32_t>(i + 1);
+
+			if (candidate == 0 || i - (candidate - 1) > 0xFFFF || Read32(_pInput + candidate - 1) != value)
+			{
+				i++;
+				continue;
+			}
+
+			const std::size_t matchPosition = candidate - 1;
+			std::size_t matchLength = mc_MinMatch;
+			while (i + matchLength < _size && _pInput[matchPosition + matchLength] == _pInput[i + matchLength])
+				matchLength++;
+
+			emit(anchor, i - anchor, i - matchPosition, matchLength);
+			i += matchLength;
+			anchor = i;
+		}
+		emit(anchor, _size - anchor, 0, 0);
+	}
+
+	bool ColumnCodec::Decompress(const std::uint8_t* _pInput, const std::size_t _inputSize,
+		std::uint8_t* _pOutput, const std::size_t _outputSize)
+	{
+		const std::uint8_t* pInput = _pInput;
+		const std::uint8_t* const pInputEnd = _pInput + _inputSize;
+		std::uint8_t* pOutput = _pOutput;
+		std::uint8_t* const pOutputEnd = _pOutput + _outputSize;
+
+		while (pInput < pInputEnd)
+		{
+			const std::uint8_t token = *pInput++;
+
+			std::size_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadExtraLength(pInput, pInputEnd, literalLength))
+				return false;
+			if (literalLength > std::size_t(pInputEnd - pInput) || literalLength > std::size_t(pOutputEnd - pOutput))
+				return false;
+			std::memcpy(pOutput, pInput, literalLength);
+			pInput += literalLength;
+			pOutput += literalLength;
+
+			// 最後の区切りはリテラルだけ
+			if (pInput == pInputEnd)
+				break;
+
+			if (pInputEnd - pInput < 2)
+				return false;
+			const std::size_t offset = std::size_t(pInput[0]) | (std::size_t(pInput[1]) << 8);
+			pInput += 2;
+			if (offset == 0 || offset > std::size_t(pOutput - _pOutput))
+				return false;
+
+			std::size_t matchLength = token & 0x0F;
+			if (matchLength == 15 && !ReadExtraLength(pInput, pInputEnd, matchLength))
+				return false;
+			matchLength += mc_MinMatch;
+			if (matchLength > std::size_t(pOutputEnd - pOutput))
+				return false;
+
+			// 距離より長い一致は自身の書き込み結果を繰り返すので、1バイトずつ写す
+			const std::uint8_t* pMatch = pOutput - offset;
+			for (std::size_t i = 0; i < matchLength; i++)
+				pOutput[i] = pMatch[i];
+			pOutput += matchLength;
+		}
+		return pOutput == pOutputEnd;
+	}
+}
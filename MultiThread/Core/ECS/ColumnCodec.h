@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace ECS
+{
+	/**
+	* @class ColumnCodec
+	* @brief チャンクの列を圧縮、展開するクラス。
+	* @note 列の要素をバイト位置ごとに並べ替えてから、LZ77系の軽量な符号で圧縮する。
+	*		 同じ値や近い値が並ぶ列では、上位のバイトが0や同じ値の連続になるので縮みやすい。
+	*		 展開は圧縮と同じ要素サイズと要素数で行う。
+	*/
+	class ColumnCodec
+	{
+	public:
+		/**
+		* @brief 列を圧縮し、出力の末尾に追加します。
+		* @param _pData 列の先頭。
+		* @param _count 要素数。
+		* @param _elementSize 1要素のサイズ[byte]。
+		* @param _output 出力先。
+		*/
+		static void Encode(const std::byte* _pData, const std::size_t _count, const std::size_t _elementSize,
+			std::vector<std::byte>& _output);
+
+		/**
+		* @brief Encodeで圧縮した列を展開します。
+		* @param _pInput 圧縮した列の先頭。
+		* @param _inputSize 読み込める最大のサイズ[byte]。
+		* @param _pData 展開先。_count * _elementSizeバイト以上必要。
+		* @param _count 要素数。
+		* @param _elementSize 1要素のサイズ[byte]。
+		* @return std::size_t 読み込んだサイズ[byte]。壊れている場合は0。
+		*/
+		static std::size_t Decode(const std::byte* _pInput, const std::size_t _inputSize,
+			std::byte* _pData, const std::size_t _count, const std::size_t _elementSize);
+
+	private:
+		/**
+		* @brief バイト列をLZ77系の符号で圧縮し、出力の末尾に追加します。
+		* @param _pInput 入力の先頭。
+		* @param _size 入力のサイズ[byte]。65536バイト以下である必要がある。
+		* @param _output 出力先。
+		*/
+		static void Compress(const std::uint8_t* _pInput, const std::size_t _size, std::vector<std::byte>& _output);
+
+		/**
+		* @brief Compressで圧縮したバイト列を展開します。
+		* @param _pInput 圧縮したバイト列の先頭。
+		* @param _inputSize 圧縮したバイト列のサイズ[byte]。
+		* @param _pOutput 展開先。
+		* @param _outputSize 展開後のサイズ[byte]。
+		* @return bool 展開後のサイズがちょうど一致した場合はtrue。
+		*/
+		static bool Decompress(const std::uint8_t* _pInput, const std::size_t _inputSize,
+			std::uint8_t* _pOutput, const std::size_t _outputSize);
+
+	private:
+		//! 一致として扱う最小の長さ[byte]。
+		static constexpr std::size_t mc_MinMatch = 4;
+		//! 一致を探すハッシュ表のビット数。
+		static constexpr std::uint32_t mc_HashBits = 12;
+		//! 圧縮しないで格納したことを表す先頭の値。
+		static constexpr std::uint8_t mc_Stored = 0;
+		//! 圧縮して格納したことを表す先頭の値。
+		static constexpr std::uint8_t mc_Compressed = 1;
+	};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//! 変更バージョンの型。値が大きいほど新しい。
+using ChangeVersion = std::uint32_t;
+
+/**
+* @class GlobalChangeVersion
+* @brief チャンクや列への書き込みに付ける変更バージョンを管理するクラス。
+* @note 全ワールドで共通の単調増加する値なので、ワールド間でチャンクを移しても比較できる。
+*/
+class GlobalChangeVersion
+{
+public:
+	/**
+	* @brief 現在の変更バージョンを取得する。
+	* @return ChangeVersion 現在の変更バージョン。
+	*/
+	static inline ChangeVersion Get() noexcept
+	{
+		return m_Version.load(std::memory_order_relaxed);
+	}
+
+	/**
+	* @brief 変更バージョンを進める。
+	* @return ChangeVersion 進める前の変更バージョン。これ以前の書き込みは全てこの値以下になる。
+	*/
+	static inline ChangeVersion Advance() noexcept
+	{
+		return m_Version.fetch_add(1, std::memory_order_relaxed);
+	}
+
+private:
+	//! 現在の変更バージョン。
+	static inline std::atomic<ChangeVersion> m_Version = 1;
+};
@@ -1,22 +1,26 @@
 #pragma once
 
-#include <cstdint>  // intn
+#include <cstdint>  // int系統
 #include <cstdlib>  // std::size_t
 
-//! R|[lg̎ނ̍ő吔B
+//! 1つのアーキタイプが持てるコンポーネントの種類の最大数。
 constexpr std::size_t cMaxComponentSize = 128;
+//! コンポーネントの型に許すアライメントの最大値。チャンクのメモリ領域はこの境界で確保する。
+constexpr std::size_t cMaxComponentAlignment = 64;
 
-//! GeBeB̊ǗCfbNX̌^B
+//! エンティティの管理インデックスの型。
 using EntityIndex = std::uint32_t;
-//! GeBeB̊Ǘo[W̌^B
+//! エンティティの管理バージョンの型。
 using EntityVersion = std::uint32_t;
-//! GeBeB̎IĎ^B
+//! エンティティの識別IDの型。
 using EntityIdentifier = std::uint64_t;
+//! ワールドに取り込んだセクションの識別IDの型。0はどのセクションにも属さない。
+using SectionId = std::uint32_t;
 
 /**
-* @brief IDɃCfbNXݒ肷B
-* @param _identifier CfbNXKpGeBeB̎IDB
-* @param _index ݒ肷CfbNXlB
+* @brief 識別IDにインデックスを設定する。
+* @param _identifier インデックスを適用するエンティティの識別ID。
+* @param _index 設定するインデックス値。
 */
 static inline void SetIndex(EntityIdentifier& _identifier, EntityIndex _index)
 {
@@ -25,9 +29,9 @@ static inline void SetIndex(EntityIdentifier& _identifier, EntityIndex _index)
 }
 
 /**
-* @brief IDɃo[Wݒ肷B
-* @param _identifier& o[WKpGeBeB̎IDB
-* @param _version ݒ肷o[WlB
+* @brief 識別IDにバージョンを設定する。
+* @param _identifier& バージョンを適用するエンティティの識別ID。
+* @param _version 設定するバージョン値。
 */
 static inline void SetVersion(EntityIdentifier& _identifier, EntityVersion _version)
 {
@@ -36,9 +40,9 @@ static inline void SetVersion(EntityIdentifier& _identifier, EntityVersion _vers
 }
 
 /**
-* @brief IDCfbNX擾B
-* @param _identifier GeBeB̎IDB
-* @return GeBeB̃CfbNXB
+* @brief 識別IDからインデックスを取得する。
+* @param _identifier エンティティの識別ID。
+* @return エンティティのインデックス。
 */
 static inline EntityIndex GetIndex(const EntityIdentifier& _identifier)
 {
@@ -46,9 +50,9 @@ static inline EntityIndex GetIndex(const EntityIdentifier& _identifier)
 }
 
 /**
-* @brief IDo[W擾B
-* @param _identifier GeBeB̎IDB
-* @return GeBeB̃o[WB
+* @brief 識別IDからバージョンを取得する。
+* @param _identifier エンティティの識別ID。
+* @return エンティティのバージョン。
 */
 static inline EntityVersion GetVersion(const EntityIdentifier& _identifier)
 {
@@ -7,17 +7,17 @@ namespace ECS
 
 	/**
 	* @class ComponentArray
-	* @brief R|[lg̔zǗNXłB
-	* @tparam CompT zɊi[R|[lǧ^B
+	* @brief コンポーネントの配列を管理するクラスです。
+	* @tparam CompT 配列に格納されるコンポーネントの型。
 	*/
 	template <typename CompT>
 	class ComponentArray
 	{
 	public:
 		/**
-		* @brief RXgN^B
-		* @param _pBegin R|[lgz̊Jn|C^B
-		* @param _size z̃TCYB
+		* @brief コンストラクタ。
+		* @param _pBegin コンポーネント配列の開始ポインタ。
+		* @param _size 配列のサイズ。
 		*/
 		ComponentArray(CompT* _pBegin, const std::size_t _size)
 		{
@@ -26,9 +26,9 @@ namespace ECS
 		}
 
 		/**
-		* @brief w肳ꂽCfbNX̃R|[lgւ̎QƂԂ܂B
-		* @param _index 擾R|[lg̃CfbNXB
-		* @return w肳ꂽCfbNX̃R|[lgւ̎QƁB
+		* @brief 指定されたインデックスのコンポーネントへの参照を返します。
+		* @param _index 取得したいコンポーネントのインデックス。
+		* @return 指定されたインデックスのコンポーネントへの参照。
 		*/
 		inline CompT& operator[](const int _index)
 		{
@@ -39,8 +39,8 @@ namespace ECS
 		}
 
 		/**
-		* @brief z̊Jn|C^Ԃ܂B
-		* @return R|[lgz̊Jn|C^B
+		* @brief 配列の開始ポインタを返します。
+		* @return コンポーネント配列の開始ポインタ。
 		*/
 		inline CompT* Begin()
 		{
@@ -48,8 +48,8 @@ namespace ECS
 		}
 
 		/**
-		* @brief z̏I|C^Ԃ܂B
-		* @return R|[lgz̏I|C^B
+		* @brief 配列の終了ポインタを返します。
+		* @return コンポーネント配列の終了ポインタ。
 		*/
 		inline CompT* End()
 		{
@@ -57,9 +57,9 @@ namespace ECS
 		}
 
 	private:
-		//! z̊Jn|C^B
+		//! 配列の開始ポインタ。
 		CompT* m_pBegin = nullptr;
-		//! z̃TCYB
+		//! 配列のサイズ。
 		std::size_t m_Size = 0;
 	};
 }
\ No newline at end of file
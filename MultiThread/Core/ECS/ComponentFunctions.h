@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ECS
+{
+	/**
+	* @struct ComponentFunctions
+	* @brief トリビアルにコピーできないコンポーネントを、型を消したまま扱うための関数テーブル。
+	* @note トリビアルにコピーできる型はテーブルを持たず(nullptr)、チャンクはmemcpyでまとめて扱う。
+	*		 各関数は連続した_count個の要素をまとめて処理する。
+	*/
+	struct ComponentFunctions
+	{
+		//! 既定値で構築する。既定コンストラクタを持たない型ではnullptr。
+		void (*m_pConstruct)(std::byte* _pDestination, std::size_t _count);
+		//! 複製を構築する。コピーできない型ではnullptr。
+		void (*m_pCopy)(std::byte* _pDestination, const std::byte* _pSource, std::size_t _count);
+		//! 移動して構築し、移動元を破棄する。
+		void (*m_pRelocate)(std::byte* _pDestination, std::byte* _pSource, std::size_t _count);
+		//! 破棄する。
+		void (*m_pDestroy)(std::byte* _pTarget, std::size_t _count);
+
+		/**
+		* @brief 型の関数テーブルを取得します。
+		* @tparam CompT 対象のコンポーネントの型。
+		* @return const ComponentFunctions* 関数テーブル。トリビアルにコピーできる型はnullptr。
+		*/
+		template <typename CompT>
+		static constexpr const ComponentFunctions* Get() noexcept;
+	};
+
+	/**
+	* @struct ComponentFunctionTable
+	* @brief 型ごとの関数テーブルの実体。
+	* @tparam CompT 対象のコンポーネントの型。
+	*/
+	template <typename CompT>
+	struct ComponentFunctionTable
+	{
+		static_assert(std::is_nothrow_move_constructible_v<CompT>,
+			"Non-trivial components must be nothrow move constructible.");
+
+		/**
+		* @brief 既定値で構築します。
+		*/
+		static void Construct(std::byte* _pDestination, const std::size_t _count)
+		{
+			std::uninitialized_value_construct_n(reinterpret_cast<CompT*>(_pDestination), _count);
+		}
+
+		/**
+		* @brief 複製を構築します。
+		*/
+		static void Copy(std::byte* _pDestination, const std::byte* _pSource, const std::size_t _count)
+		{
+			std::uninitialized_copy_n(reinterpret_cast<const CompT*>(_pSource), _count,
+				reinterpret_cast<CompT*>(_pDestination));
+		}
+
+		/**
+		* @brief 移動して構築し、移動元を破棄します。
+		*/
+		static void Relocate(std::byte* _pDestination, std::byte* _pSource, const std::size_t _count)
+		{
+			CompT* pDestination = reinterpret_cast<CompT*>(_pDestination);
+			CompT* pSource = reinterpret_cast<CompT*>(_pSource);
+			for (std::size_t i = 0; i < _count; i++)
+			{
+				new (pDestination + i) CompT(std::move(pSource[i]));
+				pSource[i].~CompT();
+			}
+		}
+
+		/**
+		* @brief 破棄します。
+		*/
+		static void Destroy(std::byte* _pTarget, const std::size_t _count)
+		{
+			std::destroy_n(reinterpret_cast<CompT*>(_pTarget), _count);
+		}
+
+		//! 関数テーブル。構築できない操作は、関数本体を実体化しないようにnullptrにする。
+		static constexpr ComponentFunctions cFunctions = {
+			[]() -> decltype(&Construct) {
+				if constexpr (std::is_default_constructible_v<CompT>) return &Construct; else return nullptr; }(),
+			[]() -> decltype(&Copy) {
+				if constexpr (std::is_copy_constructible_v<CompT>) return &Copy; else return nullptr; }(),
+			&Relocate,
+			&Destroy };
+	};
+
+	template <typename CompT>
+	constexpr const ComponentFunctions* ComponentFunctions::Get() noexcept
+	{
+		using TType = std::remove_cvref_t<CompT>;
+		if constexpr (std::is_trivially_copyable_v<TType>)
+			return nullptr;
+		else
+			return &ComponentFunctionTable<TType>::cFunctions;
+	}
+}
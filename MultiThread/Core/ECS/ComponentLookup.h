@@ -0,0 +1,292 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+
+#include "Entity.h"
+#include "Chunk.h"
+#include "ArchetypeTable.h"
+#include "World.h"
+#include "EntityManager.h"
+
+namespace ECS
+{
+	/**
+	* @class ComponentLookup
+	* @brief エンティティから特定のコンポーネントを引くための、アーキタイプごとの列オフセットのキャッシュ。
+	* @tparam CompT 引くコンポーネントの型。constを付けた場合は読み取り専用で、変更の記録を行わない。
+	* @note キャッシュは構築時とUpdate()でのみ更新するので、複数のスレッドから同時に引いてよい。
+	*		 それ以降に作られたアーキタイプはキャッシュせずに毎回求める。
+	*		 ロールバックなどでワールドのアーキタイプが置き換わった後は、Update()まで全て毎回求める。
+	*		 変更の記録は不可分に行うので、同じチャンクの別々のエンティティに同時に書き込んでもよいが、
+	*		 同じエンティティのコンポーネントに同時に書き込まないこと。
+	*/
+	template <typename CompT>
+	class ComponentLookup
+	{
+		using TType = std::remove_const_t<CompT>;
+
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _world 引く対象のワールド。
+		*/
+		explicit ComponentLookup(World& _world)
+			: m_pWorld(&_world)
+		{
+			Update();
+		}
+
+		/**
+		* @brief ワールドに追加されたアーキタイプをキャッシュに取り込みます。
+		* @note 他のスレッドがこのオブジェクトで引いている間に呼ばないこと。
+		*		 アーキタイプが置き換わっている場合は、キャッシュを作り直す。
+		*/
+		void Update()
+		{
+			const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			if (m_StateEpoch != m_pWorld->m_StateEpoch)
+			{
+				m_Columns.clear();
+				m_StateEpoch = m_pWorld->m_StateEpoch;
+			}
+			for (std::size_t i = m_Columns.size(); i < table.GetArchetypeCount(); i++)
+			{
+				m_Columns.push_back(
+					CalculateColumn(table.GetArchetype(static_cast<ArchetypeTable::ArchetypeIndex>(i))));
+			}
+		}
+
+		/**
+		* @brief 指定されたエンティティのコンポーネントを取得します。
+		* @param _entity 対象のエンティティ。
+		* @return CompT* コンポーネントのポインタ。エンティティが存在しないか、コンポーネントを持たない場合はnullptr。
+		*/
+		CompT* Get(const Entity& _entity) const
+		{
+			const EntityDirectory& entities = m_pWorld->m_pEntityManager->m_EntityDirectory;
+			if (!entities.IsAlive(_entity))
+				return nullptr;
+
+			const auto& record = entities[GetIndex(_entity.m_Identifier)];
+			CompT* pColumn = GetColumnBegin(record.GetChunkIndex(), !std::is_const_v<CompT>);
+			return pColumn ? pColumn + record.GetChunkInIndex() : nullptr;
+		}
+
+		/**
+		* @brief 指定されたエンティティがコンポーネントを持つかどうかを判定します。
+		* @param _entity 対象のエンティティ。
+		* @return bool 存在し、コンポーネントを持つ場合はtrue。
+		*/
+		bool Has(const Entity& _entity) const
+		{
+			const EntityDirectory& entities = m_pWorld->m_pEntityManager->m_EntityDirectory;
+			if (!entities.IsAlive(_entity))
+				return false;
+
+			return GetColumn(entities[GetIndex(_entity.m_Identifier)].GetChunkIndex()).m_Offset != cInvalidOffset;
+		}
+
+		/**
+		* @brief 指定されたエンティティのコンポーネントの列が最後に書き込まれたバージョンを取得します。
+		* @param _entity 対象のエンティティ。
+		* @return ChangeVersion 変更バージョン。チャンク単位なので同じチャンクの他のエンティティの書き込みも含む。
+		*		   エンティティが存在しないか、コンポーネントを持たない場合は0。
+		*/
+		ChangeVersion GetChangeVersion(const Entity& _entity) const
+		{
+			const EntityDirectory& entities = m_pWorld->m_pEntityManager->m_EntityDirectory;
+			if (!entities.IsAlive(_entity))
+				return 0;
+
+			const std::uint32_t chunkIndex = entities[GetIndex(_entity.m_Identifier)].GetChunkIndex();
+			const CachedColumn column = GetColumn(chunkIndex);
+			if (column.m_Offset == cInvalidOffset)
+				return 0;
+			return m_pWorld->m_ChunkList[chunkIndex].GetColumnVersion(column.m_ColumnIndex);
+		}
+
+		/**
+		* @brief 複数のエンティティのコンポーネントをまとめて読み出します。
+		* @param _entities 対象のエンティティ。
+		* @param _out 読み出し先。_entitiesと同じ順に書き込む。取得できなかった要素は書き換えない。
+		* @return std::size_t 読み出せた数。
+		* @note チャンクごとにまとめてから読むので、メモリアクセスが連続しやすい。
+		*/
+		std::size_t Gather(std::span<const Entity> _entities, std::span<TType> _out)
+		{
+			if (_out.size() < _entities.size())
+				std::abort();
+
+			std::size_t count = 0;
+			ForEachSorted(_entities, false, [&](const std::size_t _position, TType* _pComponent)
+				{
+					_out[_position] = *_pComponent;
+					count++;
+				});
+			return count;
+		}
+
+		/**
+		* @brief 複数のエンティティのコンポーネントにまとめて書き込みます。
+		* @param _entities 対象のエンティティ。
+		* @param _values 書き込む値。_entitiesと同じ順に並べる。
+		* @return std::size_t 書き込めた数。
+		* @note チャンクごとにまとめてから書くので、メモリアクセスが連続しやすい。
+		*/
+		std::size_t Scatter(std::span<const Entity> _entities, std::span<const TType> _values)
+			requires (!std::is_const_v<CompT>)
+		{
+			if (_values.size() < _entities.size())
+				std::abort();
+
+			std::size_t count = 0;
+			ForEachSorted(_entities, true, [&](const std::size_t _position, TType* _pComponent)
+				{
+					*_pComponent = _values[_position];
+					count++;
+				});
+			return count;
+		}
+
+	private:
+		//! コンポーネントを持たないアーキタイプのオフセット。
+		static constexpr std::size_t cInvalidOffset = std::size_t(-1);
+
+		/**
+		* @struct CachedColumn
+		* @brief アーキタイプごとの列の情報。
+		*/
+		struct CachedColumn
+		{
+			//! チャンクの先頭から列までのオフセット。持たない場合はcInvalidOffset。
+			std::size_t m_Offset;
+			//! チャンク内での列のインデックス。0はEntityの列。
+			std::size_t m_ColumnIndex;
+		};
+
+		/**
+		* @struct EntityLocation
+		* @brief まとめて読み書きするエンティティの位置。
+		*/
+		struct EntityLocation
+		{
+			//! チャンクのインデックス。
+			std::uint32_t m_ChunkIndex;
+			//! チャンク内インデックス。
+			std::uint32_t m_ChunkInIndex;
+			//! 引数のspan内での位置。
+			std::size_t m_Position;
+		};
+
+		/**
+		* @brief アーキタイプから列の情報を求めます。
+		*/
+		static CachedColumn CalculateColumn(const Archetype& _archetype) noexcept
+		{
+			if (!_archetype.HasType<TType>())
+				return { cInvalidOffset, 0 };
+
+			return {
+				Chunk::CalculateColumnOffset(_archetype.GetMemoryOffset<TType>(), Chunk::CalculateMaxSize(_archetype)),
+				_archetype.GetComponentIndex<TType>() + 1 };
+		}
+
+		/**
+		* @brief チャンクの列の情報を取得します。キャッシュにないアーキタイプはその場で求める。
+		*/
+		CachedColumn GetColumn(const std::uint32_t _chunkIndex) const
+		{
+			const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			const ArchetypeTable::ArchetypeIndex archetypeIndex = table.GetArchetypeIndexOfChunk(_chunkIndex);
+			if (archetypeIndex < m_Columns.size() && m_StateEpoch == m_pWorld->m_StateEpoch)
+				return m_Columns[archetypeIndex];
+			return CalculateColumn(table.GetArchetype(archetypeIndex));
+		}
+
+		/**
+		* @brief チャンクが持つコンポーネントの列の先頭を取得します。
+		* @param _chunkIndex チャンクのインデックス。
+		* @param _bWrite 書き込むかどうか。trueの場合は列を変更済みとして記録する。
+		* @return TType* 列の先頭。コンポーネントを持たない場合はnullptr。
+		*/
+		TType* GetColumnBegin(const std::uint32_t _chunkIndex, const bool _bWrite) const
+		{
+			const CachedColumn column = GetColumn(_chunkIndex);
+			if (column.m_Offset == cInvalidOffset)
+				return nullptr;
+
+			Chunk& chunk = m_pWorld->m_ChunkList[_chunkIndex];
+			// 同じバージョンで記録済みなら書き込まない。複数スレッドから同じチャンクを引いても同じ値になる
+			if (_bWrite && chunk.GetColumnVersion(column.m_ColumnIndex) != GlobalChangeVersion::Get())
+				chunk.MarkColumnChanged(column.m_ColumnIndex);
+			// 読むだけの場合は、他のワールドと共有しているメモリ領域を複製しない
+			std::byte* pBuffer = _bWrite ? chunk.GetBuffer() : const_cast<std::byte*>(std::as_const(chunk).GetBuffer());
+			return reinterpret_cast<TType*>(pBuffer + column.m_Offset);
+		}
+
+		/**
+		* @brief エンティティをチャンクごとにまとめ、コンポーネントを持つものに関数を実行します。
+		* @param _entities 対象のエンティティ。
+		* @param _bWrite 書き込むかどうか。
+		* @param _func 実行する関数。(_entities内の位置, コンポーネントのポインタ)を受け取る。
+		*/
+		template <typename Func>
+		void ForEachSorted(std::span<const Entity> _entities, const bool _bWrite, Func&& _func)
+		{
+			const EntityDirectory& entities = m_pWorld->m_pEntityManager->m_EntityDirectory;
+			const std::size_t chunkCount = m_pWorld->m_ChunkList.size();
+
+			// チャンクごとの数を数えて、チャンク順に並べる(計数ソート)
+			m_ChunkOffsets.assign(chunkCount + 1, 0);
+			m_Locations.clear();
+			m_Locations.reserve(_entities.size());
+			for (std::size_t i = 0; i < _entities.size(); i++)
+			{
+				if (!entities.IsAlive(_entities[i]))
+					continue;
+
+				const auto& record = entities[GetIndex(_entities[i].m_Identifier)];
+				m_Locations.push_back({ record.GetChunkIndex(), record.GetChunkInIndex(), i });
+				m_ChunkOffsets[record.GetChunkIndex() + 1]++;
+			}
+			for (std::size_t i = 0; i < chunkCount; i++)
+				m_ChunkOffsets[i + 1] += m_ChunkOffsets[i];
+
+			m_SortBuffer.resize(m_Locations.size());
+			for (auto&& location : m_Locations)
+				m_SortBuffer[m_ChunkOffsets[location.m_ChunkIndex]++] = location;
+
+			// 同じチャンクが続く間は列の情報を引き直さない
+			std::uint32_t currentChunkIndex = std::uint32_t(-1);
+			TType* pColumn = nullptr;
+			for (auto&& location : m_SortBuffer)
+			{
+				if (location.m_ChunkIndex != currentChunkIndex)
+				{
+					currentChunkIndex = location.m_ChunkIndex;
+					pColumn = GetColumnBegin(currentChunkIndex, _bWrite);
+				}
+				if (pColumn)
+					_func(location.m_Position, pColumn + location.m_ChunkInIndex);
+			}
+		}
+
+	private:
+		//! 引く対象のワールド。
+		World* m_pWorld = nullptr;
+		//! アーキタイプのインデックスごとの列の情報。
+		std::vector<CachedColumn> m_Columns;
+		//! m_Columnsを作ったときのワールドのWorld::m_StateEpoch。
+		std::uint64_t m_StateEpoch = 0;
+		//! まとめて読み書きするときの、エンティティの位置の作業領域。
+		std::vector<EntityLocation> m_Locations;
+		//! m_Locationsをチャンク順に並べ替えた作業領域。
+		std::vector<EntityLocation> m_SortBuffer;
+		//! 並べ替えに使う、チャンクごとの書き込み位置。
+		std::vector<std::size_t> m_ChunkOffsets;
+	};
+}
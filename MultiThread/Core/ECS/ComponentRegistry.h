@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include "Utilities/TypeInfo.h"
+#include "ComponentFunctions.h"
+
+namespace ECS
+{
+	/**
+	* @class ComponentRegistry
+	* @brief プログラムで使うコンポーネントの型を、型IDから引くための表。
+	* @note Archetype::AddType<T>()で使われた型を、静的初期化の時点で登録する。
+	*		 ワールドにまだ現れていない型も引けるので、読み込んだデータの型を検証できる。
+	*/
+	class ComponentRegistry
+	{
+	public:
+		/**
+		* @struct Entry
+		* @brief 登録した型の情報。
+		*/
+		struct Entry
+		{
+			//! 型のサイズ。
+			std::size_t m_Size = 0;
+			//! 型のアライメント。
+			std::size_t m_Alignment = 0;
+			//! トリビアルにコピー可能かどうか。
+			bool m_bTriviallyCopyable = false;
+		};
+
+		/**
+		* @brief 型を登録します。
+		* @tparam CompT 登録するコンポーネントの型。
+		* @return bool 常にtrue。
+		*/
+		template <typename CompT>
+		static bool Register()
+		{
+			const Entry entry{ sizeof(CompT), alignof(CompT), ComponentFunctions::Get<CompT>() == nullptr };
+			std::lock_guard<std::mutex> lock(GetMutex());
+			GetEntries().emplace(TypeManager::TypeInfo<CompT>::GetID(), entry);
+			return true;
+		}
+
+		/**
+		* @brief 型IDから登録した型の情報を探します。
+		* @param _id 型ID。
+		* @param _entry 見つかった型の情報を格納する。
+		* @return bool 登録されている場合はtrue。
+		*/
+		static bool Find(const TypeId _id, Entry& _entry)
+		{
+			std::lock_guard<std::mutex> lock(GetMutex());
+			const auto& entries = GetEntries();
+			auto it = entries.find(_id);
+			if (it == entries.end())
+				return false;
+			_entry = it->second;
+			return true;
+		}
+
+		//! 型を登録するための変数。アドレスを取ると実体化され、静的初期化で登録される。
+		template <typename CompT>
+		static inline const bool cRegistered = Register<CompT>();
+
+	private:
+		/**
+		* @brief 登録した型の表を取得します。静的初期化の順序に依らないように関数内で持つ。
+		*/
+		static std::unordered_map<TypeId, Entry>& GetEntries()
+		{
+			static std::unordered_map<TypeId, Entry> entries;
+			return entries;
+		}
+
+		/**
+		* @brief 表を守るミューテックスを取得します。
+		*/
+		static std::mutex& GetMutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+	};
+}
@@ -0,0 +1,597 @@
+#include "DeltaStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "World.h"
+#include "EntityManager.h"
+#include "Chunk.h"
+#include "WorldSection.h"
+
+namespace ECS
+{
+	namespace
+	{
+		//! 1ティック分のレコードの識別子("ECSD")。
+		constexpr std::uint32_t cMagic = 0x44534345;
+
+		/**
+		* @brief 値を可変長整数としてストリームに書き込む。
+		*/
+		void WriteVarint(std::vector<std::byte>& _stream, std::uint64_t _value)
+		{
+			while (_value >= 0x80)
+			{
+				_stream.push_back(static_cast<std::byte>((_value & 0x7F) | 0x80));
+				_value >>= 7;
+			}
+			_stream.push_back(static_cast<std::byte>(_value));
+		}
+
+		/**
+		* @brief 値をそのままストリームに書き込む。
+		*/
+		template <typename T>
+		void WriteRaw(std::vector<std::byte>& _stream, const T& _value)
+		{
+			const std::size_t offset = _stream.size();
+			_stream.resize(offset + sizeof(T));
+			std::memcpy(_stream.data() + offset, &_value, sizeof(T));
+		}
+
+		/**
+		* @class StreamReader
+		* @brief 範囲を検査しながらストリームを読み込む。
+		*/
+		class StreamReader
+		{
+		public:
+			StreamReader(const std::byte* _pData, std::size_t _size)
+				: m_pData(_pData), m_Size(_size)
+			{}
+
+			bool ReadVarint(std::uint64_t& _value)
+			{
+				_value = 0;
+				for (std::uint32_t shift = 0; shift < 64; shift += 7)
+				{
+					if (m_Position >= m_Size)
+						return false;
+					const std::uint8_t byte = static_cast<std::uint8_t>(m_pData[m_Position++]);
+					_value |= std::uint64_t(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0)
+						return true;
+				}
+				return false;
+			}
+
+			template <typename T>
+			bool ReadRaw(T& _value)
+			{
+				if (m_Size - m_Position < sizeof(T))
+					return false;
+				std::memcpy(&_value, m_pData + m_Position, sizeof(T));
+				m_Position += sizeof(T);
+				return true;
+			}
+
+			const std::byte* ReadBytes(std::size_t _size)
+			{
+				if (m_Size - m_Position < _size)
+					return nullptr;
+				const std::byte* pBytes = m_pData + m_Position;
+				m_Position += _size;
+				return pBytes;
+			}
+
+			std::size_t GetPosition() const noexcept
+			{
+				return m_Position;
+			}
+
+		private:
+			const std::byte* m_pData;
+			std::size_t m_Size;
+			std::size_t m_Position = 0;
+		};
+
+		/**
+		* @brief 列のメモリ範囲を求める。
+		* @param _archetype チャンクのアーキタイプ。
+		* @param _columnIndex 列のインデックス。0がEntityの列。
+		* @param _rowCount 行数。
+		* @return (チャンク先頭からのオフセット, バイト数)。
+		*/
+		std::pair<std::size_t, std::size_t> GetColumnRange(
+			const Archetype& _archetype, const std::size_t _columnIndex, const std::uint32_t _rowCount)
+		{
+			if (_columnIndex == 0)
+				return { 0, sizeof(Entity) * _rowCount };
+
+			const std::uint32_t maxSize = Chunk::CalculateMaxSize(_archetype);
+			return {
+				Chunk::CalculateColumnOffset(_archetype.GetMemroyOffsetByIndex(_columnIndex - 1), maxSize),
+				_archetype.GetMemorySizeByIndex(_columnIndex - 1) * _rowCount };
+		}
+
+		/**
+		* @brief 列の内容と前回送った内容のXORを、0の連続を詰めた形で書き込み、前回の内容を更新する。
+		* @note [0の長さ][リテラルの長さ][リテラル]の繰り返し。
+		*/
+		void WriteColumnDelta(std::vector<std::byte>& _stream,
+			const std::byte* _pLive, std::byte* _pShadow, const std::size_t _size)
+		{
+			std::size_t position = 0;
+			while (position < _size)
+			{
+				const std::size_t zeroBegin = position;
+				while (position < _size && _pLive[position] == _pShadow[position])
+					position++;
+				const std::size_t literalBegin = position;
+				while (position < _size && _pLive[position] != _pShadow[position])
+					position++;
+
+				WriteVarint(_stream, literalBegin - zeroBegin);
+				WriteVarint(_stream, position - literalBegin);
+				for (std::size_t i = literalBegin; i < position; i++)
+				{
+					_stream.push_back(_pLive[i] ^ _pShadow[i]);
+					_pShadow[i] = _pLive[i];
+				}
+			}
+		}
+
+		/**
+		* @brief WriteColumnDeltaで書き込んだ差分を適用する。
+		* @param _pDestination 適用先。nullptrの場合は差分の形式だけを検証する。
+		*/
+		bool ReadColumnDelta(StreamReader& _reader, std::byte* _pDestination, const std::size_t _size)
+		{
+			std::size_t position = 0;
+			while (position < _size)
+			{
+				std::uint64_t zeroLength = 0, literalLength = 0;
+				if (!_reader.ReadVarint(zeroLength) || !_reader.ReadVarint(literalLength) ||
+					zeroLength > _size - position || literalLength > _size - position - zeroLength)
+					return false;
+				position += static_cast<std::size_t>(zeroLength);
+
+				const std::byte* pLiteral = _reader.ReadBytes(static_cast<std::size_t>(literalLength));
+				if (!pLiteral)
+					return false;
+				for (std::size_t i = 0; _pDestination && i < literalLength; i++)
+					_pDestination[position + i] ^= pLiteral[i];
+				position += static_cast<std::size_t>(literalLength);
+			}
+			return true;
+		}
+	}
+
+	namespace
+	{
+		/**
+		* @struct ChangedChunk
+		* @brief 検証済みの、変更されたチャンクの列。
+		*/
+		struct ChangedChunk
+		{
+			//! チャンクのインデックス。
+			std::uint32_t m_ChunkIndex = 0;
+			//! 適用した後の行数。
+			std::uint32_t m_Size = 0;
+			//! (列のインデックス, ストリーム内の差分の位置)。
+			std::vector<std::pair<std::size_t, std::size_t>> m_Columns;
+		};
+
+		/**
+		* @struct ChangedEntity
+		* @brief 検証済みの、変更されたエンティティの管理情報。
+		*/
+		struct ChangedEntity
+		{
+			//! エンティティのインデックス。
+			EntityIndex m_Index;
+			//! チャンクのインデックス。
+			std::uint32_t m_ChunkIndex;
+			//! チャンク内の行。
+			std::uint32_t m_ChunkInIndex;
+			//! エンティティの識別ID。
+			EntityIdentifier m_Identifier;
+		};
+	}
+
+	DeltaEncoder::DeltaEncoder(World& _world)
+		: m_pWorld(&_world)
+	{
+		m_pWorld->m_pEntityManager->m_bRecordEntityChanges = true;
+	}
+
+	DeltaEncoder::~DeltaEncoder()
+	{
+		EntityManager& entityManager = *m_pWorld->m_pEntityManager;
+		entityManager.m_bRecordEntityChanges = false;
+		entityManager.m_vChangedEntityIndices.clear();
+	}
+
+	bool DeltaEncoder::Encode(std::vector<std::byte>& _stream)
+	{
+		const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+		EntityManager& entityManager = *m_pWorld->m_pEntityManager;
+		ChunkList& chunkList = m_pWorld->m_ChunkList;
+
+		// コンポーネントはメモリの内容をそのまま送るので、トリビアルにコピー可能である必要がある
+		for (std::size_t i = m_EncodedArchetypeCount; i < table.GetArchetypeCount(); i++)
+		{
+			if (!table.GetArchetype(static_cast<ArchetypeTable::ArchetypeIndex>(i)).IsTriviallyCopyable())
+				return false;
+		}
+
+		// 疎な集合は送らないので、要素がある場合は受け取る側と食い違う
+		for (auto&& [typeId, pSet] : m_pWorld->m_SparseSets)
+		{
+			if (pSet->GetSize() != 0)
+				return false;
+		}
+
+		// 状態が置き換わった場合は、送った内容が基準にならないので全体を送り直す
+		if (m_StateEpoch != m_pWorld->m_StateEpoch)
+		{
+			m_bFirst = true;
+			m_EncodedArchetypeCount = 0;
+			m_ChunkShadows.clear();
+			m_StateEpoch = m_pWorld->m_StateEpoch;
+		}
+		const ChangeVersion lastVersion = m_bFirst ? 0 : m_LastVersion;
+
+		WriteRaw(_stream, cMagic);
+		_stream.push_back(static_cast<std::byte>(m_bFirst));
+
+		//=== 新しいアーキタイプ
+		WriteVarint(_stream, table.GetArchetypeCount() - m_EncodedArchetypeCount);
+		for (; m_EncodedArchetypeCount < table.GetArchetypeCount(); m_EncodedArchetypeCount++)
+		{
+			const Archetype& archetype =
+				table.GetArchetype(static_cast<ArchetypeTable::ArchetypeIndex>(m_EncodedArchetypeCount));
+			WriteVarint(_stream, archetype.GetArchetypeSize());
+			for (std::size_t i = 0; i < archetype.GetArchetypeSize(); i++)
+			{
+				WriteRaw(_stream, archetype.GetComponentIdByIndex(i));
+				WriteVarint(_stream, archetype.GetMemorySizeByIndex(i));
+				WriteVarint(_stream, archetype.GetAlignmentByIndex(i));
+			}
+		}
+
+		//=== 新しいチャンク
+		WriteVarint(_stream, chunkList.size() - m_ChunkShadows.size());
+		while (m_ChunkShadows.size() < chunkList.size())
+		{
+			const std::uint32_t chunkIndex = static_cast<std::uint32_t>(m_ChunkShadows.size());
+			WriteVarint(_stream, chunkIndex);
+			WriteVarint(_stream, table.GetArchetypeIndexOfChunk(chunkIndex));
+			m_ChunkShadows.push_back(std::make_unique<std::byte[]>(Chunk::GetCapacity()));
+		}
+
+		//=== 変更されたチャンクの列
+		std::vector<std::uint32_t> changedChunks;
+		for (std::uint32_t i = 0; i < chunkList.size(); i++)
+		{
+			const Chunk& chunk = chunkList[i];
+			bool bChanged = chunk.GetStructureVersion() > lastVersion;
+			for (std::size_t column = 0; !bChanged && column <= chunk.m_pArchetype->GetArchetypeSize(); column++)
+				bChanged = chunk.GetColumnVersion(column) > lastVersion;
+			if (bChanged)
+				changedChunks.push_back(i);
+		}
+
+		WriteVarint(_stream, changedChunks.size());
+		for (auto&& chunkIndex : changedChunks)
+		{
+			const Chunk& chunk = chunkList[chunkIndex];
+			const std::size_t columnCount = chunk.m_pArchetype->GetArchetypeSize() + 1;
+			WriteVarint(_stream, chunkIndex);
+			WriteVarint(_stream, chunk.GetSize());
+
+			std::size_t changedColumnCount = 0;
+			for (std::size_t column = 0; column < columnCount; column++)
+			{
+				if (chunk.GetColumnVersion(column) > lastVersion)
+					changedColumnCount++;
+			}
+			WriteVarint(_stream, changedColumnCount);
+
+			for (std::size_t column = 0; column < columnCount; column++)
+			{
+				if (chunk.GetColumnVersion(column) <= lastVersion)
+					continue;
+
+				auto [offset, size] = GetColumnRange(*chunk.m_pArchetype, column, chunk.GetSize());
+				WriteVarint(_stream, column);
+				WriteColumnDelta(_stream,
+					chunk.GetBuffer() + offset, m_ChunkShadows[chunkIndex].get() + offset, size);
+			}
+		}
+
+		//=== エンティティの管理情報。初回は記録が揃っていないので全て送る
+		std::vector<EntityIndex>& changedEntities = entityManager.m_vChangedEntityIndices;
+		if (m_bFirst)
+		{
+			changedEntities.resize(entityManager.m_EntityDirectory.GetSize());
+			for (EntityIndex i = 0; i < changedEntities.size(); i++)
+				changedEntities[i] = i;
+		}
+		else
+		{
+			std::sort(changedEntities.begin(), changedEntities.end());
+			changedEntities.erase(std::unique(changedEntities.begin(), changedEntities.end()), changedEntities.end());
+		}
+
+		WriteVarint(_stream, entityManager.m_EntityDirectory.GetSize());
+		WriteVarint(_stream, changedEntities.size());
+		for (auto&& entityIndex : changedEntities)
+		{
+			const auto& record = entityManager.m_EntityDirectory[entityIndex];
+			WriteVarint(_stream, entityIndex);
+			WriteVarint(_stream, record.GetChunkIndex());
+			WriteVarint(_stream, record.GetChunkInIndex());
+			WriteRaw(_stream, entityManager.m_EntityDirectory.GetEntity(entityIndex).m_Identifier);
+		}
+		changedEntities.clear();
+
+		//=== 再利用可能なエンティティインデックス。変わった場合のみ送る
+		const bool bRecycleChanged = m_bFirst || m_RecycleShadow != entityManager.m_vRecycleEntityIndices;
+		_stream.push_back(static_cast<std::byte>(bRecycleChanged));
+		if (bRecycleChanged)
+		{
+			m_RecycleShadow = entityManager.m_vRecycleEntityIndices;
+			WriteVarint(_stream, m_RecycleShadow.size());
+			for (auto&& index : m_RecycleShadow)
+				WriteVarint(_stream, index);
+		}
+
+		m_bFirst = false;
+		m_LastVersion = GlobalChangeVersion::Advance();
+		return true;
+	}
+
+	DeltaDecoder::DeltaDecoder(World& _world)
+		: m_pWorld(&_world)
+	{}
+
+	std::size_t DeltaDecoder::Decode(const std::byte* _pData, std::size_t _size)
+	{
+		ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+		EntityManager& entityManager = *m_pWorld->m_pEntityManager;
+		ChunkList& chunkList = m_pWorld->m_ChunkList;
+		EntityDirectory& entities = entityManager.m_EntityDirectory;
+		StreamReader reader(_pData, _size);
+
+		std::uint32_t magic = 0;
+		std::uint8_t bReset = 0;
+		if (!reader.ReadRaw(magic) || magic != cMagic || !reader.ReadRaw(bReset))
+			return 0;
+
+		// レコード全体を読んで検証してから適用する。途中で失敗した場合はワールドを変更しない
+		// 全体を送り直す場合は、これまでに適用した内容を捨てた状態を基準に検証する
+		const std::size_t baseArchetypeCount = bReset ? 0 : m_ArchetypeIndices.size();
+		const std::size_t baseChunkCount = bReset ? 0 : chunkList.size();
+		const std::size_t baseEntityCount = bReset ? 0 : entities.GetSize();
+
+		//=== 新しいアーキタイプ
+		std::uint64_t archetypeCount = 0;
+		if (!reader.ReadVarint(archetypeCount))
+			return 0;
+		std::vector<Archetype> newArchetypes;
+		for (std::uint64_t i = 0; i < archetypeCount; i++)
+		{
+			std::uint64_t componentCount = 0;
+			if (!reader.ReadVarint(componentCount) || componentCount > cMaxComponentSize)
+				return 0;
+
+			Archetype archetype;
+			for (std::uint64_t j = 0; j < componentCount; j++)
+			{
+				TypeId id = 0;
+				std::uint64_t size = 0, alignment = 0;
+				if (!reader.ReadRaw(id) || !reader.ReadVarint(size) || !reader.ReadVarint(alignment) ||
+					size > Chunk::GetCapacity() || !Archetype::IsValidAlignment(static_cast<std::size_t>(alignment)))
+					return 0;
+				archetype.AddType(id, static_cast<std::size_t>(size), static_cast<std::size_t>(alignment));
+			}
+			// 1行も入らないアーキタイプのチャンクは作れない
+			if (Chunk::CalculateMaxSize(archetype) == 0)
+				return 0;
+			newArchetypes.push_back(archetype);
+		}
+		const std::size_t totalArchetypeCount = baseArchetypeCount + newArchetypes.size();
+
+		//=== 新しいチャンク。エンコード側と同じインデックスに作る
+		std::uint64_t chunkCount = 0;
+		if (!reader.ReadVarint(chunkCount) ||
+			chunkCount > (std::uint64_t(1) << EntityDirectory::Record::cChunkIndexBits) - baseChunkCount)
+			return 0;
+		std::vector<std::uint32_t> newChunkArchetypes;
+		for (std::uint64_t i = 0; i < chunkCount; i++)
+		{
+			std::uint64_t chunkIndex = 0, archetypeIndex = 0;
+			if (!reader.ReadVarint(chunkIndex) || !reader.ReadVarint(archetypeIndex) ||
+				chunkIndex != baseChunkCount + i || archetypeIndex >= totalArchetypeCount)
+				return 0;
+			newChunkArchetypes.push_back(static_cast<std::uint32_t>(archetypeIndex));
+		}
+		const std::size_t totalChunkCount = baseChunkCount + newChunkArchetypes.size();
+
+		// 適用した後にチャンクが持つアーキタイプ
+		const auto getChunkArchetype = [&](const std::size_t _chunkIndex) -> const Archetype& {
+			if (_chunkIndex < baseChunkCount)
+				return chunkList[_chunkIndex].GetArchetype();
+			const std::size_t archetypeIndex = newChunkArchetypes[_chunkIndex - baseChunkCount];
+			if (archetypeIndex < baseArchetypeCount)
+				return table.GetArchetype(m_ArchetypeIndices[archetypeIndex]);
+			return newArchetypes[archetypeIndex - baseArchetypeCount];
+		};
+
+		//=== 変更されたチャンクの列。差分は形式だけを検証し、位置を覚えておく
+		const TypeId parentId = TypeManager::TypeInfo<Parent>::GetID();
+		bool bHierarchyChanged = bReset;
+		std::uint64_t changedChunkCount = 0;
+		if (!reader.ReadVarint(changedChunkCount))
+			return 0;
+		std::vector<ChangedChunk> changedChunks;
+		std::unordered_map<std::uint32_t, std::uint32_t> changedChunkSizes;
+		for (std::uint64_t i = 0; i < changedChunkCount; i++)
+		{
+			std::uint64_t chunkIndex = 0, size = 0, columnCount = 0;
+			if (!reader.ReadVarint(chunkIndex) || chunkIndex >= totalChunkCount)
+				return 0;
+			const Archetype& archetype = getChunkArchetype(static_cast<std::size_t>(chunkIndex));
+			if (!reader.ReadVarint(size) || size > Chunk::CalculateMaxSize(archetype) ||
+				!reader.ReadVarint(columnCount) || columnCount > archetype.GetArchetypeSize() + 1)
+				return 0;
+
+			ChangedChunk changed;
+			changed.m_ChunkIndex = static_cast<std::uint32_t>(chunkIndex);
+			changed.m_Size = static_cast<std::uint32_t>(size);
+			for (std::uint64_t j = 0; j < columnCount; j++)
+			{
+				std::uint64_t column = 0;
+				if (!reader.ReadVarint(column) || column > archetype.GetArchetypeSize())
+					return 0;
+
+				const std::size_t position = reader.GetPosition();
+				auto [offset, byteSize] = GetColumnRange(archetype, static_cast<std::size_t>(column), changed.m_Size);
+				if (!ReadColumnDelta(reader, nullptr, byteSize))
+					return 0;
+				changed.m_Columns.emplace_back(static_cast<std::size_t>(column), position);
+				if (column != 0 && archetype.GetComponentIdByIndex(static_cast<std::size_t>(column) - 1) == parentId)
+					bHierarchyChanged = true;
+			}
+			changedChunkSizes[changed.m_ChunkIndex] = changed.m_Size;
+			changedChunks.push_back(std::move(changed));
+		}
+
+		// 適用した後のチャンクの行数
+		const auto getChunkSize = [&](const std::uint32_t _chunkIndex) -> std::uint32_t {
+			auto it = changedChunkSizes.find(_chunkIndex);
+			if (it != changedChunkSizes.end())
+				return it->second;
+			return _chunkIndex < baseChunkCount ? chunkList[_chunkIndex].GetSize() : 0;
+		};
+
+		//=== エンティティの管理情報。管理情報は縮まないので、要素数は今より少なくならない
+		std::uint64_t entityCount = 0, changedEntityCount = 0;
+		if (!reader.ReadVarint(entityCount) || !reader.ReadVarint(changedEntityCount) ||
+			entityCount < baseEntityCount || entityCount > std::numeric_limits<EntityIndex>::max())
+			return 0;
+		bHierarchyChanged |= changedEntityCount != 0;
+		std::vector<ChangedEntity> changedEntities;
+		for (std::uint64_t i = 0; i < changedEntityCount; i++)
+		{
+			std::uint64_t entityIndex = 0, chunkIndex = 0, chunkInIndex = 0;
+			EntityIdentifier identifier = 0;
+			if (!reader.ReadVarint(entityIndex) || entityIndex >= entityCount ||
+				!reader.ReadVarint(chunkIndex) || !reader.ReadVarint(chunkInIndex) || !reader.ReadRaw(identifier) ||
+				GetVersion(identifier) > EntityDirectory::Record::cReservedVersion)
+				return 0;
+			// 再利用待ちや予約済みの要素も位置はそのまま管理情報に入れるので、ビット幅を確かめる
+			if (chunkIndex >= (std::uint64_t(1) << EntityDirectory::Record::cChunkIndexBits) ||
+				chunkInIndex >= (std::uint64_t(1) << EntityDirectory::Record::cChunkInIndexBits))
+				return 0;
+			changedEntities.push_back(ChangedEntity{ static_cast<EntityIndex>(entityIndex),
+				static_cast<std::uint32_t>(chunkIndex), static_cast<std::uint32_t>(chunkInIndex), identifier });
+		}
+
+		//=== 再利用可能なエンティティインデックス
+		std::uint8_t bRecycleChanged = 0;
+		if (!reader.ReadRaw(bRecycleChanged))
+			return 0;
+		std::vector<std::uint32_t> recycleIndices;
+		if (bRecycleChanged)
+		{
+			std::uint64_t recycleCount = 0;
+			if (!reader.ReadVarint(recycleCount))
+				return 0;
+			for (std::uint64_t i = 0; i < recycleCount; i++)
+			{
+				std::uint64_t index = 0;
+				if (!reader.ReadVarint(index) || index >= entityCount)
+					return 0;
+				recycleIndices.push_back(static_cast<std::uint32_t>(index));
+			}
+		}
+		else if (!bReset)
+		{
+			recycleIndices = entityManager.m_vRecycleEntityIndices;
+		}
+
+		//=== 再利用待ちと予約済み以外の要素は、適用した後のチャンクの行を指す必要がある
+		std::vector<bool> recycled(static_cast<std::size_t>(entityCount), false);
+		for (auto&& index : recycleIndices)
+		{
+			if (index >= entityCount || recycled[index])
+				return 0;
+			recycled[index] = true;
+		}
+		for (auto&& changed : changedEntities)
+		{
+			if (recycled[changed.m_Index] || GetVersion(changed.m_Identifier) >= EntityDirectory::Record::cReservedVersion)
+				continue;
+			if (GetIndex(changed.m_Identifier) != changed.m_Index ||
+				changed.m_ChunkIndex >= totalChunkCount || changed.m_ChunkInIndex >= getChunkSize(changed.m_ChunkIndex))
+				return 0;
+		}
+
+		//=== ここから先は失敗しないので、ワールドに適用する
+		if (bReset)
+		{
+			WorldSection::ClearWorld(*m_pWorld);
+			m_ArchetypeIndices.clear();
+		}
+		for (auto&& archetype : newArchetypes)
+			m_ArchetypeIndices.push_back(table.GetOrCreateArchetype(archetype));
+
+		for (auto&& archetypeIndex : newChunkArchetypes)
+		{
+			const ArchetypeTable::ArchetypeIndex localIndex = m_ArchetypeIndices[archetypeIndex];
+			const std::uint32_t chunkIndex = static_cast<std::uint32_t>(chunkList.size());
+			chunkList.push_back(Chunk(table.GetArchetype(localIndex)));
+			// 差分はゼロ初期化した内容を基準にしている
+			std::memset(chunkList.back().GetBuffer(), 0, Chunk::GetCapacity());
+			table.AddChunk(localIndex, chunkIndex);
+		}
+
+		for (auto&& changed : changedChunks)
+		{
+			Chunk& chunk = chunkList[changed.m_ChunkIndex];
+			if (chunk.m_Size != changed.m_Size)
+			{
+				chunk.m_Size = changed.m_Size;
+				chunk.MarkStructureChanged();
+			}
+			for (auto&& [column, position] : changed.m_Columns)
+			{
+				auto [offset, byteSize] = GetColumnRange(*chunk.m_pArchetype, column, chunk.m_Size);
+				StreamReader columnReader(_pData + position, _size - position);
+				ReadColumnDelta(columnReader, chunk.GetBuffer() + offset, byteSize);
+				chunk.MarkColumnChanged(column);
+			}
+		}
+
+		entities.Grow(static_cast<std::size_t>(entityCount), EntityDirectory::Record());
+		entityManager.m_NextEntityIndex.store(static_cast<EntityIndex>(entities.GetSize()));
+		for (auto&& changed : changedEntities)
+		{
+			entities[changed.m_Index] = EntityDirectory::Record(
+				changed.m_ChunkIndex, changed.m_ChunkInIndex, GetVersion(changed.m_Identifier));
+		}
+		if (bRecycleChanged)
+			entityManager.m_vRecycleEntityIndices = std::move(recycleIndices);
+
+		// 子の一覧と階層の深さは送らないので、Parentから作り直す
+		if (bHierarchyChanged)
+			entityManager.RebuildHierarchy();
+
+		return reader.GetPosition();
+	}
+}
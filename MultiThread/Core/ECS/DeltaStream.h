@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "Common/ChangeVersion.h"
+#include "ArchetypeTable.h"
+
+namespace ECS
+{
+	class World;
+
+	/**
+	* @class DeltaEncoder
+	* @brief 前回のエンコード以降に変更されたチャンクだけをバイナリストリームに書き出すクラス。
+	* @note 列ごとの変更バージョンで変更を検出し、前回送った内容とのXORを
+	*		 0の連続を詰めた形で書き出す。初回はワールド全体を書き出す。
+	*		 エンティティの管理情報は変更されたものだけを書き出す。
+	*		 ロールバックなどでワールドの状態が丸ごと置き換わった後は、初回と同じく全体を書き出し、
+	*		 適用側のワールドも作り直させる。
+	*/
+	class DeltaEncoder
+	{
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _world 変更を追跡するワールド。
+		*/
+		explicit DeltaEncoder(World& _world);
+
+		/**
+		* @brief デストラクタ。
+		*/
+		~DeltaEncoder();
+
+		DeltaEncoder(const DeltaEncoder&) = delete;
+		DeltaEncoder& operator=(const DeltaEncoder&) = delete;
+
+		/**
+		* @brief 前回のエンコード以降の変更を1ティック分として書き出します。
+		* @param _stream 書き出し先。末尾に追記する。
+		* @return bool 成功した場合はtrue。トリビアルにコピーできないコンポーネントを含む場合と、
+		*		  疎な集合に格納するコンポーネントを持つエンティティがある場合はfalse。
+		*/
+		bool Encode(std::vector<std::byte>& _stream);
+
+	private:
+		//! 追跡するワールドへのポインタ。
+		World* m_pWorld = nullptr;
+		//! 前回エンコードした時点の変更バージョン。
+		ChangeVersion m_LastVersion = 0;
+		//! 初回のエンコードかどうか。
+		bool m_bFirst = true;
+		//! 前回エンコードした時点のワールドのWorld::m_StateEpoch。
+		std::uint64_t m_StateEpoch = 0;
+		//! 書き出し済みのアーキタイプ数。
+		std::size_t m_EncodedArchetypeCount = 0;
+		//! チャンクごとの、前回送った内容の複製。
+		std::vector<std::unique_ptr<std::byte[]>> m_ChunkShadows;
+		//! 前回送った再利用可能なエンティティインデックスの配列。
+		std::vector<std::uint32_t> m_RecycleShadow;
+	};
+
+	/**
+	* @class DeltaDecoder
+	* @brief DeltaEncoderが書き出したストリームを別のワールドに適用するクラス。
+	* @note 適用先のワールドはこのストリーム以外で変更しない前提。
+	*		 全体を送り直したレコードを受け取った場合は、適用先のワールドを空にしてから適用する。
+	*/
+	class DeltaDecoder
+	{
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _world ストリームを適用するワールド。
+		*/
+		explicit DeltaDecoder(World& _world);
+
+		/**
+		* @brief ストリームから1ティック分を読み込んで適用します。
+		* @param _pData ストリームの先頭。
+		* @param _size ストリームのサイズ[byte]。
+		* @return std::size_t 読み込んだサイズ[byte]。不正なデータの場合は0。
+		* @note 1ティック分を全て検証してから適用するので、不正なデータの場合はワールドを変更しない。
+		*/
+		std::size_t Decode(const std::byte* _pData, std::size_t _size);
+
+	private:
+		//! 適用先のワールドへのポインタ。
+		World* m_pWorld = nullptr;
+		//! エンコード側のアーキタイプのインデックスから適用先のインデックスへの対応。
+		std::vector<ArchetypeTable::ArchetypeIndex> m_ArchetypeIndices;
+	};
+}
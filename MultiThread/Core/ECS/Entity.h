@@ -6,14 +6,14 @@ namespace ECS
 {
 	/**
 	* @struct Entity
-	* @brief ECSA[LeN`ɂGeBeB\\́B
+	* @brief ECSアーキテクチャにおけるエンティティを表す構造体。
 	*/
 	struct Entity
 	{
 		/**
-		* @brief RXgN^
-		* @param _index GeBeB̃CfbNXB
-		* @param _version GeBeB̃o[W
+		* @brief コンストラクタ
+		* @param _index エンティティのインデックス。
+		* @param _version エンティティのバージョン
 		*/
 		Entity(const std::uint32_t _index, const std::uint32_t _version)
 			: m_Identifier(NULL)
@@ -23,14 +23,14 @@ namespace ECS
 		}
 
 		/**
-		* @brief RXgN^
-		* @param _Identifier GeBeB̎ʃrbgB
+		* @brief コンストラクタ
+		* @param _Identifier エンティティの識別ビット。
 		*/
 		Entity(const EntityIdentifier _Identifier)
 			: m_Identifier(_Identifier)
 		{}
 
-		//! GeBeB̈ӂ̎ʃrbgB
+		//! エンティティの一意の識別ビット。
 		EntityIdentifier m_Identifier;
 	};
 }
\ No newline at end of file
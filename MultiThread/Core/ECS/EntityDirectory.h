@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Common/Id.h"
+#include "Entity.h"
+#include "Chunk.h"
+
+namespace ECS
+{
+	/**
+	* @class EntityDirectory
+	* @brief エンティティのインデックスから、所属するチャンクと行、バージョンを引く管理情報の配列。
+	* @note 1要素を8バイトに詰め、固定長のページに分けて確保する。広げるときは
+	*		 ページを足すだけで既存の要素は動かさないので、要素への参照も保たれる。
+	*		 インデックスは要素の位置そのものなので持たない。
+	*/
+	class EntityDirectory
+	{
+	public:
+		/**
+		* @class Record
+		* @brief 1エンティティ分の管理情報。チャンクのインデックス、チャンク内インデックス、バージョンを詰めたもの。
+		*/
+		class Record
+		{
+			friend EntityDirectory;
+
+		public:
+			//! チャンクのインデックスのビット数。
+			static constexpr std::uint32_t cChunkIndexBits = 26;
+			//! チャンク内インデックスのビット数。
+			static constexpr std::uint32_t cChunkInIndexBits = 11;
+			//! バージョンのビット数。
+			static constexpr std::uint32_t cVersionBits = 64 - cChunkIndexBits - cChunkInIndexBits;
+			//! 予約済みで未配置のエンティティに入れるバージョン。どのハンドルとも一致しない。
+			static constexpr EntityVersion cReservedVersion = (EntityVersion(1) << cVersionBits) - 1;
+
+			static_assert(Chunk::GetCapacity() / sizeof(Entity) <= (std::size_t(1) << cChunkInIndexBits),
+				"Chunk rows do not fit in the entity directory record.");
+
+			/**
+			* @brief コンストラクタ
+			* @param _chunkIndex チャンクのインデックス。
+			* @param _chunkInIndex チャンク内インデックス。
+			* @param _version バージョン。
+			*/
+			constexpr Record(const std::uint32_t _chunkIndex = 0, const std::uint32_t _chunkInIndex = 0,
+				const EntityVersion _version = 0) noexcept
+				: m_Bits(0)
+			{
+				SetLocation(_chunkIndex, _chunkInIndex);
+				SetVersion(_version);
+			}
+
+			/**
+			* @brief チャンクのインデックスを取得します。
+			* @return std::uint32_t チャンクのインデックス。
+			*/
+			constexpr std::uint32_t GetChunkIndex() const noexcept
+			{
+				return static_cast<std::uint32_t>(m_Bits & mc_ChunkIndexMask);
+			}
+
+			/**
+			* @brief チャンク内インデックスを取得します。
+			* @return std::uint32_t チャンク内インデックス。
+			*/
+			constexpr std::uint32_t GetChunkInIndex() const noexcept
+			{
+				return static_cast<std::uint32_t>((m_Bits >> cChunkIndexBits) & mc_ChunkInIndexMask);
+			}
+
+			/**
+			* @brief バージョンを取得します。
+			* @return EntityVersion バージョン。
+			*/
+			constexpr EntityVersion GetVersion() const noexcept
+			{
+				return static_cast<EntityVersion>(m_Bits >> (cChunkIndexBits + cChunkInIndexBits));
+			}
+
+			/**
+			* @brief 所属するチャンクと行を設定します。
+			* @param _chunkIndex チャンクのインデックス。
+			* @param _chunkInIndex チャンク内インデックス。
+			*/
+			constexpr void SetLocation(const std::uint32_t _chunkIndex, const std::uint32_t _chunkInIndex) noexcept
+			{
+				if (_chunkIndex > mc_ChunkIndexMask || _chunkInIndex > mc_ChunkInIndexMask)
+					std::abort();
+
+				m_Bits = (m_Bits & ~(mc_ChunkIndexMask | (mc_ChunkInIndexMask << cChunkIndexBits))) |
+					std::uint64_t(_chunkIndex) | (std::uint64_t(_chunkInIndex) << cChunkIndexBits);
+			}
+
+			/**
+			* @brief チャンク内インデックスだけを設定します。
+			* @param _chunkInIndex チャンク内インデックス。
+			*/
+			constexpr void SetChunkInIndex(const std::uint32_t _chunkInIndex) noexcept
+			{
+				SetLocation(GetChunkIndex(), _chunkInIndex);
+			}
+
+			/**
+			* @brief バージョンを設定します。
+			* @param _version バージョン。cReservedVersion以下である必要がある。
+			*/
+			constexpr void SetVersion(const EntityVersion _version) noexcept
+			{
+				if (_version > cReservedVersion)
+					std::abort();
+
+				constexpr std::uint32_t shift = cChunkIndexBits + cChunkInIndexBits;
+				m_Bits = (m_Bits & ((std::uint64_t(1) << shift) - 1)) | (std::uint64_t(_version) << shift);
+			}
+
+			/**
+			* @brief 破棄したときに進めた後のバージョンを求めます。予約用の値は飛ばして0に戻る。
+			* @param _version 今のバージョン。
+			* @return EntityVersion 次のバージョン。
+			*/
+			static constexpr EntityVersion NextVersion(const EntityVersion _version) noexcept
+			{
+				return _version + 1 >= cReservedVersion ? 0 : _version + 1;
+			}
+
+			constexpr bool operator==(const Record&) const noexcept = default;
+
+		private:
+			//! チャンクのインデックスを取り出すマスク。
+			static constexpr std::uint64_t mc_ChunkIndexMask = (std::uint64_t(1) << cChunkIndexBits) - 1;
+			//! チャンク内インデックスを取り出すマスク。
+			static constexpr std::uint64_t mc_ChunkInIndexMask = (std::uint64_t(1) << cChunkInIndexBits) - 1;
+
+			//! 詰めた管理情報。下位からチャンクのインデックス、チャンク内インデックス、バージョン。
+			std::uint64_t m_Bits;
+		};
+
+		static_assert(sizeof(Record) == 8, "EntityDirectory::Record must stay 8 bytes.");
+
+		//! 1ページの要素数のビット数。
+		static constexpr std::uint32_t cPageShift = 16;
+		//! 1ページの要素数。
+		static constexpr std::size_t cPageSize = std::size_t(1) << cPageShift;
+
+	public:
+		/**
+		* @brief 要素数を取得します。
+		* @return std::size_t 要素数。
+		*/
+		std::size_t GetSize() const noexcept
+		{
+			return m_Size;
+		}
+
+		/**
+		* @brief 要素を取得します。
+		* @param _entityIndex エンティティのインデックス。GetSize()未満である必要がある。
+		* @return Record& 管理情報。
+		*/
+		Record& operator[](const EntityIndex _entityIndex) noexcept
+		{
+			return m_Pages[_entityIndex >> cPageShift][_entityIndex & (cPageSize - 1)];
+		}
+
+		/**
+		* @brief 要素を取得します。
+		* @param _entityIndex エンティティのインデックス。GetSize()未満である必要がある。
+		* @return const Record& 管理情報。
+		*/
+		const Record& operator[](const EntityIndex _entityIndex) const noexcept
+		{
+			return m_Pages[_entityIndex >> cPageShift][_entityIndex & (cPageSize - 1)];
+		}
+
+		/**
+		* @brief 要素を不可分に読み取ります。
+		* @param _entityIndex エンティティのインデックス。GetSize()未満である必要がある。
+		* @return Record 管理情報。
+		* @note 構成の変更は違うアーキタイプ同士で並行するので、行を動かしている途中の要素も読める形で読む。
+		*/
+		Record Load(const EntityIndex _entityIndex) const noexcept
+		{
+			Record record;
+			record.m_Bits = std::atomic_ref<std::uint64_t>(const_cast<std::uint64_t&>((*this)[_entityIndex].m_Bits))
+				.load(std::memory_order_acquire);
+			return record;
+		}
+
+		/**
+		* @brief 要素を不可分に書き込みます。
+		* @param _entityIndex エンティティのインデックス。GetSize()未満である必要がある。
+		* @param _record 管理情報。
+		*/
+		void Store(const EntityIndex _entityIndex, const Record& _record) noexcept
+		{
+			std::atomic_ref<std::uint64_t>((*this)[_entityIndex].m_Bits).store(_record.m_Bits, std::memory_order_release);
+		}
+
+		/**
+		* @brief エンティティのハンドルが今も有効かどうかを判定します。
+		* @param _entity 判定するエンティティ。
+		* @return bool インデックスが範囲内で、バージョンが一致する場合はtrue。
+		*/
+		bool IsAlive(const Entity& _entity) const noexcept
+		{
+			const EntityIndex entityIndex = GetIndex(_entity.m_Identifier);
+			return entityIndex < m_Size && Load(entityIndex).GetVersion() == GetVersion(_entity.m_Identifier);
+		}
+
+		/**
+		* @brief 今のバージョンのエンティティのハンドルを取得します。
+		* @param _entityIndex エンティティのインデックス。
+		* @return Entity エンティティ。
+		*/
+		Entity GetEntity(const EntityIndex _entityIndex) const noexcept
+		{
+			return Entity(_entityIndex, (*this)[_entityIndex].GetVersion());
+		}
+
+		/**
+		* @brief 要素数を指定の数以上にします。追加分は_recordで埋める。
+		* @param _size 必要な要素数。
+		* @param _record 追加分に入れる管理情報。
+		*/
+		void Grow(const std::size_t _size, const Record& _record)
+		{
+			Reserve(_size);
+			while (m_Size < _size)
+				(*this)[static_cast<EntityIndex>(m_Size++)] = _record;
+		}
+
+		/**
+		* @brief 指定の要素数まで追加してもページの確保が起きないようにします。
+		* @param _capacity 必要な要素数。
+		*/
+		void Reserve(const std::size_t _capacity)
+		{
+			const std::size_t pageCount = (_capacity + cPageSize - 1) >> cPageShift;
+			while (m_Pages.size() < pageCount)
+				m_Pages.push_back(std::make_unique<Record[]>(cPageSize));
+		}
+
+		/**
+		* @brief 別の配列と同じ内容にします。
+		* @param _other 複製元の配列。
+		* @note 確保済みのページは使い回すので、同じ程度の大きさの配列同士であれば確保は起きない。
+		*/
+		void CopyFrom(const EntityDirectory& _other)
+		{
+			Reserve(_other.m_Size);
+			for (std::size_t first = 0; first < _other.m_Size; first += cPageSize)
+			{
+				const std::size_t pageIndex = first >> cPageShift;
+				std::memcpy(m_Pages[pageIndex].get(), _other.m_Pages[pageIndex].get(),
+					sizeof(Record) * (std::min)(cPageSize, _other.m_Size - first));
+			}
+			m_Size = _other.m_Size;
+		}
+
+		/**
+		* @brief 全ての要素を取り除きます。ページは解放する。
+		*/
+		void Clear() noexcept
+		{
+			m_Pages.clear();
+			m_Size = 0;
+		}
+
+		/**
+		* @brief 確保しているメモリ量を取得します。
+		* @return std::size_t メモリ量[byte]。
+		*/
+		std::size_t GetMemorySize() const noexcept
+		{
+			return m_Pages.size() * cPageSize * sizeof(Record) + m_Pages.capacity() * sizeof(m_Pages[0]);
+		}
+
+	private:
+		//! 要素のページ。ページ内の要素は確保したまま動かさない。
+		std::vector<std::unique_ptr<Record[]>> m_Pages;
+		//! 要素数。
+		std::size_t m_Size = 0;
+	};
+}
@@ -3,33 +3,57 @@
 #include "Common/Id.h"
 #include "IComponentData.h"
 #include "Archetype.h"
+#include "StaticArchetype.h"
+#include "EntityDirectory.h"
+#include "StructuralEventLog.h"
+#include "Transform.h"
 #include "World.h"
 
+#include "../../AsyncFunctionManager.h"
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+
 namespace ECS
 {
 	/**
 	* @class EntityManager
-	* @brief GeBeB̍쐬AjȂǂ̊ǗA
-	*		 R|[lg̒ǉA폜AݒȂǂ̑sB
+	* @brief エンティティの作成、破棄などの管理、
+	*		 コンポーネントの追加、削除、設定などの操作を行う。
+	* @note World::GetArchetypeLocks()でロックを有効にすると、作成、破棄、コンポーネントの追加と削除は
+	*		 構成ロックを読み取りで取り、行を動かすアーキタイプのロックを書き込みで取るので、違うアーキタイプ
+	*		 同士であれば並行して動く。アーキタイプやチャンクの追加、管理情報の拡張、疎な集合の追加、親子関係の
+	*		 変更が要る場合と、まとめて行う操作は、構成ロックを書き込みで取り互いに直列化される。
 	*/
 	class EntityManager
 	{
+		friend WorldSnapshot;
+		friend MemoryReport;
+		friend WorldSection;
+		friend WorldFork;
+		friend DeltaEncoder;
+		friend DeltaDecoder;
+		friend EntitySpawner;
+		template <typename> friend class ComponentLookup;
+
 		using ChunkIndex = std::uint32_t;;
 		using ChunkInIndex = std::uint32_t;
-		using EntityInfo = std::pair<ChunkIndex, ChunkInIndex>;
+		using EntityRecord = EntityDirectory::Record;
 
 	public:
 		/**
-		* @brief RXgN^
-		* @param _pWorld 郏[h̃|C^B
+		* @brief コンストラクタ
+		* @param _pWorld 所属するワールドのポインタ。
 		*/
 		EntityManager(World* _pWorld)
 			: m_pWorld(_pWorld)
 		{}
 
 		/**
-		* @brief VGeBeB쐬܂B
-		* @return 쐬ꂽGeBeB̃CX^XB
+		* @brief 新しいエンティティを作成します。
+		* @return 作成されたエンティティのインスタンス。
 		*/
 		inline Entity CreateEntity()
 		{
@@ -38,246 +62,1323 @@ namespace ECS
 		}
 
 		/**
-		* @brief w肳ꂽA[L^Cv̊ÂĐVGeBeB쐬܂B
-		* @param _archetype VGeBeBɎgpA[L^CvB
-		* @return 쐬ꂽVGeBeBB
+		* @brief 指定されたアーキタイプの基づいて新しいエンティティを作成します。
+		* @param _archetype 新しいエンティティに使用するアーキタイプ。
+		* @return 作成された新しいエンティティ。
 		*/
 		inline Entity CreateEntity(const Archetype& _archetype)
 		{
+			StructureChangeScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (structureScope.IsShared())
+			{
+				Entity entity(0, 0);
+				if (TryCreateEntityShared(_archetype, [](Chunk& _chunk, const ChunkInIndex _chunkInIndex) {
+					_chunk.ConstructComponents(_chunkInIndex, 1); }, entity))
+					return entity;
+				structureScope.Upgrade();
+			}
+
+			PrepareRecycleIndices();
 			auto entityInfo = m_vRecycleEntityIndices.size() == 0 ?
 				CreateNewEntity() : CreateRecycleEntity();
 
-			const std::uint32_t chunkIndex = GetAndCreateChunkIndex(_archetype, true);
+			const std::uint32_t chunkIndex = GetAndCreateChunkIndex(_archetype);
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, GetArchetypeIndexOfChunk(chunkIndex));
 
 			std::uint32_t chunkInIndex = m_pWorld->m_ChunkList[chunkIndex].
 				CreateEntity(entityInfo.first, entityInfo.second);
+			m_pWorld->m_ChunkList[chunkIndex].ConstructComponents(chunkInIndex, 1);
+
+			m_EntityDirectory[entityInfo.first].SetLocation(chunkIndex, chunkInIndex);
+			RecordEntityChange(entityInfo.first);
+			const Entity entity(entityInfo.first, entityInfo.second);
+			RecordStructuralEvent(ArchetypeTable::cInvalidIndex, GetArchetypeIndexOfChunk(chunkIndex), &entity);
+			return entity;
+		}
+
+		/**
+		* @brief 指定されたコンポーネントの値を持つ新しいエンティティを作成します。
+		* @tparam CompTs エンティティが持つコンポーネントの型。
+		* @param _values 各コンポーネントの初期値。
+		* @return 作成された新しいエンティティ。
+		* @note 各値はコンパイル時に求めたオフセットへ直接構築する。
+		*/
+		template <typename... CompTs>
+			requires (sizeof...(CompTs) > 0 &&
+				(!std::is_same_v<std::remove_cvref_t<CompTs>, Archetype> && ...))
+		inline Entity CreateEntity(CompTs&&... _values)
+		{
+			using StaticArchetypeT = StaticArchetype<std::remove_cvref_t<CompTs>...>;
+
+			StructureChangeScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (structureScope.IsShared())
+			{
+				// 値は作成できた場合にだけ転送するので、排他で取り直した後に使える
+				Entity entity(0, 0);
+				if (TryCreateEntityShared(StaticArchetypeT::cArchetype, [&](Chunk& _chunk, const ChunkInIndex _chunkInIndex) {
+					StaticArchetypeT::Construct(_chunk, _chunkInIndex, std::forward<CompTs>(_values)...); }, entity))
+					return entity;
+				structureScope.Upgrade();
+			}
+
+			PrepareRecycleIndices();
+			auto entityInfo = m_vRecycleEntityIndices.size() == 0 ?
+				CreateNewEntity() : CreateRecycleEntity();
+
+			const std::uint32_t chunkIndex =
+				GetAndCreateChunkIndex(StaticArchetypeT::cArchetype);
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, GetArchetypeIndexOfChunk(chunkIndex));
+			Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
 
-			m_vEntities[entityInfo.first].first =
-				EntityInfo(chunkIndex, chunkInIndex);
-			return m_vEntities[entityInfo.first].second;
+			std::uint32_t chunkInIndex = chunk.CreateEntity(entityInfo.first, entityInfo.second);
+			StaticArchetypeT::Construct(chunk, chunkInIndex, std::forward<CompTs>(_values)...);
+
+			m_EntityDirectory[entityInfo.first].SetLocation(chunkIndex, chunkInIndex);
+			RecordEntityChange(entityInfo.first);
+			const Entity entity(entityInfo.first, entityInfo.second);
+			RecordStructuralEvent(ArchetypeTable::cInvalidIndex, GetArchetypeIndexOfChunk(chunkIndex), &entity);
+			return entity;
 		}
 
 		/**
-		* @brief w肳ꂽGeBeBj܂B
-		* @param _entity jGeBeBB
+		* @brief 指定されたエンティティを複製したエンティティをまとめて作成します。
+		* @param _prefab 複製元のエンティティ。
+		* @param _count 作成する数。
+		* @return std::vector<Entity> 作成されたエンティティ。複製元が存在しない場合は空。
+		* @note アーキタイプは1度だけ引き、チャンクごとに行をまとめて確保してから
+		*		 各列を複製元の行で埋める。数が多い場合はチャンク単位で並列に埋める。
+		*/
+		inline std::vector<Entity> Instantiate(const Entity& _prefab, const std::size_t _count)
+		{
+			std::vector<Entity> result;
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (!ExistEntity(_prefab) || _count == 0) return result;
+			result.reserve(_count);
+
+			const EntityRecord prefabRecord = m_EntityDirectory[GetIndex(_prefab.m_Identifier)];
+			const Archetype& archetype = m_pWorld->m_ChunkList[prefabRecord.GetChunkIndex()].GetArchetype();
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, GetArchetypeIndexOfChunk(prefabRecord.GetChunkIndex()));
+
+			//=== エンティティとチャンク内の行を確保する
+			// 範囲は(チャンクのインデックス, 先頭のチャンク内インデックス, 行数)
+			std::vector<std::tuple<ChunkIndex, ChunkInIndex, std::uint32_t>> ranges;
+			if (m_vRecycleEntityIndices.size() < _count)
+				m_EntityDirectory.Reserve(m_EntityDirectory.GetSize() + _count - m_vRecycleEntityIndices.size());
+
+			std::size_t remainingCount = _count;
+			while (remainingCount > 0)
+			{
+				const std::uint32_t chunkIndex = GetAndCreateChunkIndex(archetype);
+				Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+				const std::uint32_t count = static_cast<std::uint32_t>(
+					(std::min)(remainingCount, std::size_t(chunk.GetMaxSize() - chunk.GetSize())));
+				const ChunkInIndex firstChunkInIndex = chunk.GetSize();
+
+				for (std::uint32_t i = 0; i < count; i++)
+				{
+					auto entityInfo = m_vRecycleEntityIndices.size() == 0 ?
+						CreateNewEntity() : CreateRecycleEntity();
+
+					m_EntityDirectory[entityInfo.first].SetLocation(chunkIndex, firstChunkInIndex + i);
+					RecordEntityChange(entityInfo.first);
+					result.push_back(Entity(entityInfo.first, entityInfo.second));
+				}
+				chunk.CreateEntities(result.data() + result.size() - count, count);
+				RecordStructuralEvent(ArchetypeTable::cInvalidIndex, GetArchetypeIndexOfChunk(chunkIndex),
+					result.data() + result.size() - count, count);
+
+				ranges.emplace_back(chunkIndex, firstChunkInIndex, count);
+				remainingCount -= count;
+			}
+
+			// 疎な集合のコンポーネントも複製する
+			for (auto&& [typeId, pSet] : m_pWorld->m_SparseSets)
+				pSet->CopyTo(GetIndex(_prefab.m_Identifier), result.data(), result.size());
+
+			//=== 各列を複製元の行で埋める。チャンクの追加は済んでいるので参照は安定している
+			const Chunk& sourceChunk = m_pWorld->m_ChunkList[prefabRecord.GetChunkIndex()];
+
+			// 複製元に親がいる場合は、複製も同じ親の子として登録する
+			if (const Parent* pParent = FindParent(GetIndex(_prefab.m_Identifier)))
+			{
+				auto& children = m_Children[GetIndex(pParent->m_Entity.m_Identifier)];
+				children.insert(children.end(), result.begin(), result.end());
+			}
+
+			const auto fillRange = [&](const std::size_t _rangeIndex)
+				{
+					const auto& [chunkIndex, firstChunkInIndex, count] = ranges[_rangeIndex];
+					m_pWorld->m_ChunkList[chunkIndex].FillComponents(
+						firstChunkInIndex, count, sourceChunk, prefabRecord.GetChunkInIndex());
+				};
+			if (_count < mc_ParallelInstantiateCount)
+			{
+				for (std::size_t i = 0; i < ranges.size(); i++)
+					fillRange(i);
+				return result;
+			}
+
+			m_pWorld->m_pAsyncFunctionManager->ParallelFor(ranges.size(), 1, fillRange);
+			return result;
+		}
+
+		/**
+		* @brief エンティティのインデックスを連続して予約します。スレッドセーフ。
+		* @param _count 予約する数。
+		* @return EntityIndex 予約した範囲の先頭。
+		* @note 管理情報はEntitySpawnerが配置するときに作られる。それまでは予約したインデックスの
+		*		 エンティティは存在しない扱いになる。
+		*/
+		inline EntityIndex ReserveEntityIndices(const std::uint32_t _count)
+		{
+			return m_NextEntityIndex.fetch_add(_count, std::memory_order_relaxed);
+		}
+
+		/**
+		* @brief 指定されたエンティティを破棄します。
+		* @param _entity 破棄するエンティティ。
 		*/
 		inline void DestroyEntity(const Entity& _entity)
 		{
+			StructureChangeScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (structureScope.IsShared())
+			{
+				if (TryDestroyEntityShared(_entity))
+					return;
+				structureScope.Upgrade();
+			}
 			if (!ExistEntity(_entity)) return;
 
 			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			EntityInfo& entityInfo = m_vEntities[entityIndex].first;
 
-			m_pWorld->m_ChunkList[entityInfo.first].DestroyEntity(entityInfo.second);
+			// 子はルートにして残し、親の子の一覧からは外す
+			auto it = m_Children.find(entityIndex);
+			if (it != m_Children.end())
+			{
+				const std::vector<Entity> children = it->second;
+				for (auto&& child : children)
+					RemoveParent(child);
+				m_Children.erase(entityIndex);
+			}
+			DetachFromParent(entityIndex);
+
+			for (auto&& [typeId, pSet] : m_pWorld->m_SparseSets)
+				pSet->Remove(entityIndex);
 
-			SetVersion(
-				m_vEntities[entityIndex].second.m_Identifier,
-				GetVersion(m_vEntities[entityIndex].second.m_Identifier)
-			);
+			EntityRecord& record = m_EntityDirectory[entityIndex];
+			RecordStructuralEvent(GetArchetypeIndexOfChunk(record.GetChunkIndex()), ArchetypeTable::cInvalidIndex, &_entity);
+			{
+				ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, GetArchetypeIndexOfChunk(record.GetChunkIndex()));
+				m_pWorld->m_ChunkList[record.GetChunkIndex()].DestroyEntity(record.GetChunkInIndex());
+				UpdateMovedEntity(record.GetChunkIndex(), record.GetChunkInIndex());
+			}
+
+			// バージョンを進めて、破棄したエンティティを指すハンドルを無効にする
+			record.SetVersion(EntityRecord::NextVersion(record.GetVersion()));
+			RecordEntityChange(entityIndex);
 
 			m_vRecycleEntityIndices.push_back(entityIndex);
 		}
 
 		/**
-		* @brief w肳ꂽGeBeB݂邩ǂ𔻒肵܂B
-		* @param _entity ݂mFGeBeBB
-		* @return GeBeB݂ꍇtrue, łȂꍇfalseB
+		* @brief 指定されたエンティティが存在するかどうかを判定します。
+		* @param _entity 存在を確認するエンティティ。
+		* @return エンティティが存在する場合はtrue, そうでない場合はfalse。
 		*/
 		inline const bool ExistEntity(const Entity& _entity)
 		{
-			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			return _entity.m_Identifier
-				== m_vEntities[entityIndex].second.m_Identifier;
+			return m_EntityDirectory.IsAlive(_entity);
 		}
 
 		/**
-		* @brief w肳ꂽGeBeBɃR|[lgǉ܂B
-		* @param _entity R|[lgǉGeBeBB
+		* @brief 指定されたエンティティにコンポーネントを追加します。
+		* @param _entity コンポーネントを追加するエンティティ。
 		*/
 		template <typename CompT>
 		inline void AddComponent(Entity& _entity)
 		{
-			if (!ExistEntity(_entity)) return;
+			StructureChangeScope structureScope(m_pWorld->m_ArchetypeLocks);
 
-			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			EntityInfo entityInfo = m_vEntities[entityIndex].first;
-			auto newArchetype =
-				m_pWorld->m_ChunkList[entityInfo.first].GetArchetype();
-			newArchetype.AddType<CompT>();
+			// 疎な集合に格納する型は集合に加えるだけで、エンティティは移動しない
+			if constexpr (SparseComponent<CompT>)
+			{
+				// 集合を作る場合は型ごとの表が変わるので、書き込みで取り直す
+				if (!m_pWorld->FindSparseSet<CompT>())
+					structureScope.Upgrade();
+				if (!ExistEntity(_entity)) return;
 
-			const std::uint32_t newChunkIndex =
-				GetAndCreateChunkIndex(newArchetype);
-			Chunk& chunk = m_pWorld->m_ChunkList[newChunkIndex];
+				auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+				m_pWorld->GetSparseSet<CompT>().Add(_entity);
+			}
+			else
+			{
+				if (structureScope.IsShared())
+				{
+					if (TryMoveToArchetypeShared<CompT>(_entity, true))
+						return;
+					structureScope.Upgrade();
+				}
+				if (!ExistEntity(_entity)) return;
 
-			std::size_t chunkInIndex = entityInfo.second;
-			m_pWorld->m_ChunkList[entityInfo.first].MoveEntity(
-				chunkInIndex, _entity, chunk
-			);
-			m_vEntities[entityIndex].first = std::pair<ChunkIndex, ChunkInIndex>(newChunkIndex, chunkInIndex);
+				const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
+				const ChunkIndex chunkIndex = m_EntityDirectory[entityIndex].GetChunkIndex();
+				if (m_pWorld->m_ChunkList[chunkIndex].GetArchetype().HasType<CompT>()) return;
+
+				MoveToArchetype(entityIndex,
+					m_pWorld->m_ArchetypeTable.GetOrCreateTransition<CompT>(GetArchetypeIndexOfChunk(chunkIndex), true));
+			}
 		}
 
 		/**
-		* @brief w肳ꂽGeBeBR|[lgO܂B
-		* @oaram _entity R|[lgOGeBeBB
+		* @brief 指定されたエンティティからコンポーネントを除外します。
+		* @oaram _entity コンポーネントを除外するエンティティ。
 		*/
 		template <typename CompT>
 		inline void RemoveComponent(Entity& _entity)
 		{
-			if (!ExistEntity(_entity)) return;
+			StructureChangeScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if constexpr (SparseComponent<CompT>)
+			{
+				if (!ExistEntity(_entity)) return;
+				auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+				if (auto* pSparseSet = m_pWorld->FindSparseSet<CompT>())
+					pSparseSet->Remove(GetIndex(_entity.m_Identifier));
+			}
+			else
+			{
+				if (structureScope.IsShared())
+				{
+					if (TryMoveToArchetypeShared<CompT>(_entity, false))
+						return;
+					structureScope.Upgrade();
+				}
+				if (!ExistEntity(_entity)) return;
 
-			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			EntityInfo& entityInfo = m_vEntities[entityIndex].first;
+				const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
+				const ChunkIndex chunkIndex = m_EntityDirectory[entityIndex].GetChunkIndex();
+				if (!m_pWorld->m_ChunkList[chunkIndex].GetArchetype().HasType<CompT>()) return;
+
+				MoveToArchetype(entityIndex,
+					m_pWorld->m_ArchetypeTable.GetOrCreateTransition<CompT>(GetArchetypeIndexOfChunk(chunkIndex), false));
+			}
+		}
+
+		/**
+		* @brief 親子関係を設定します。子孫も含めて、階層の深さごとのアーキタイプに移る。
+		* @param _child 子にするエンティティ。既に親がいる場合は付け替える。
+		* @param _parent 親にするエンティティ。
+		* @return bool 設定できた場合はtrue。どちらかが存在しないか、循環する場合はfalse。
+		*/
+		inline bool SetParent(const Entity& _child, const Entity& _parent)
+		{
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (!ExistEntity(_child) || !ExistEntity(_parent)) return false;
+
+			// 子の子孫を親にすると循環するので、親から祖先をたどって確かめる
+			const EntityIndex childIndex = GetIndex(_child.m_Identifier);
+			EntityIndex ancestorIndex = GetIndex(_parent.m_Identifier);
+			while (true)
+			{
+				if (ancestorIndex == childIndex) return false;
+				const Parent* pParent = FindParent(ancestorIndex);
+				if (!pParent) break;
+				ancestorIndex = GetIndex(pParent->m_Entity.m_Identifier);
+			}
+
+			DetachFromParent(childIndex);
+			const Parent* pGrandParent = FindParent(GetIndex(_parent.m_Identifier));
+			m_Children[GetIndex(_parent.m_Identifier)].push_back(_child);
+			UpdateHierarchy(childIndex, _parent, pGrandParent ? pGrandParent->m_Depth + 1 : 1);
+			return true;
+		}
+
+		/**
+		* @brief 親子関係を解除し、ルートにします。子孫の深さも更新する。
+		* @param _child 親から外すエンティティ。
+		*/
+		inline void RemoveParent(const Entity& _child)
+		{
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			if (!ExistEntity(_child)) return;
+
+			const EntityIndex childIndex = GetIndex(_child.m_Identifier);
+			const Parent* pParent = FindParent(childIndex);
+			if (!pParent) return;
+
+			DetachFromParent(childIndex);
 			Archetype newArchetype =
-				m_pWorld->m_ChunkList[entityInfo.first].GetArchetype();
-			newArchetype.RemoveType<CompT>();
+				m_pWorld->m_ChunkList[m_EntityDirectory[childIndex].GetChunkIndex()].GetArchetype();
+			newArchetype.RemoveType(HierarchyDepth::GetTypeId(pParent->m_Depth));
+			newArchetype.RemoveType<Parent>();
+			MoveToArchetype(childIndex, newArchetype);
 
-			const std::uint32_t newChunkIndex =
-				GetAndCreateChunkIndex(newArchetype);
-			Chunk& chunk = m_pWorld->m_ChunkList[newChunkIndex];
+			auto it = m_Children.find(childIndex);
+			if (it == m_Children.end()) return;
+			for (auto&& child : it->second)
+				UpdateHierarchy(GetIndex(child.m_Identifier), _child, 1);
+		}
 
-			m_pWorld->m_ChunkList[entityInfo.first].MoveEntity(
-				entityInfo.second, _entity, chunk
-			);
-			entityInfo.first = newChunkIndex;
+		/**
+		* @brief 子のエンティティの一覧を取得します。
+		* @param _entity 親のエンティティ。
+		* @return const std::vector<Entity>* 子の一覧。子がいない場合はnullptr。
+		*/
+		inline const std::vector<Entity>* GetChildren(const Entity& _entity)
+		{
+			if (!ExistEntity(_entity)) return nullptr;
+
+			auto it = m_Children.find(GetIndex(_entity.m_Identifier));
+			return it != m_Children.end() && !it->second.empty() ? &it->second : nullptr;
 		}
 
 		/**
-		* @brief w肳ꂽGeBeB̃R|[lgf[^ݒ肵܂B
-		* @param _entity R|[lgf[^ݒ肷GeBeBB
-		* @param _data ݒ肷R|[lgf[^B
+		* @brief これまでに作られた階層の深さの最大値を取得します。
+		* @return std::uint32_t 深さの最大値。親子関係がない場合は0。減ることはない。
+		*/
+		inline std::uint32_t GetMaxHierarchyDepth() const noexcept
+		{
+			return m_MaxHierarchyDepth;
+		}
+
+		/**
+		* @brief 指定されたエンティティのコンポーネントデータを設定します。
+		* @param _entity コンポーネントデータを設定するエンティティ。
+		* @param _data 設定するコンポーネントデータ。
 		*/
 		template <typename CompT>
 		inline void SetComponent(const Entity& _entity, const CompT& _data)
 		{
 			if (!ExistEntity(_entity)) return;
 
-			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			EntityInfo& entityInfo = m_vEntities[entityIndex].first;
+			if constexpr (SparseComponent<CompT>)
+			{
+				if (CompT* pComponent = GetComponent<CompT>(_entity))
+					*pComponent = _data;
+			}
+			else
+			{
+				const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
+				const EntityRecord& record = m_EntityDirectory[entityIndex];
 
-			m_pWorld->m_ChunkList[entityInfo.first].SetComponentData(
-				entityInfo.second, _data
-			);
+				m_pWorld->m_ChunkList[record.GetChunkIndex()].SetComponentData(
+					record.GetChunkInIndex(), _data
+				);
+			}
 		}
 
 		/**
-		* @brief w肳ꂽGeBeB̃R|[lgf[^擾܂B
-		* @param _entity R|[lgf[^擾GeBeBB
-		* @return w肳ꂽR|[lg̃|C^BGeBeB݂ȂꍇnullptrB
+		* @brief 指定されたエンティティのコンポーネントデータを取得します。
+		* @param _entity コンポーネントデータを取得するエンティティ。
+		* @return 指定されたコンポーネントのポインタ。エンティティが存在しない場合はnullptr。
 		*/
 		template <typename CompT>
 		inline CompT* GetComponent(const Entity& _entity)
 		{
 			if (!ExistEntity(_entity)) return nullptr;
 
-			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			EntityInfo& entityInfo = m_vEntities[entityIndex].first;
-			Chunk* chunk = &m_pWorld->m_ChunkList[entityInfo.first];
-			return &chunk->GetComponentList<CompT>()[entityInfo.second];
+			if constexpr (SparseComponent<CompT>)
+			{
+				auto* pSparseSet = m_pWorld->FindSparseSet<CompT>();
+				return pSparseSet ? pSparseSet->Find(_entity) : nullptr;
+			}
+			else
+			{
+				const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
+				const EntityRecord& record = m_EntityDirectory[entityIndex];
+				Chunk* chunk = &m_pWorld->m_ChunkList[record.GetChunkIndex()];
+				return &chunk->GetComponentList<CompT>()[record.GetChunkInIndex()];
+			}
+		}
+
+		/**
+		* @brief アーキタイプ内のエンティティを、コンポーネントから求めたキーの順にチャンクをまたいで並べ替えます。
+		* @tparam CompT キーを求めるコンポーネントの型。
+		* @param _archetype 並べ替えるアーキタイプ。完全に一致するアーキタイプのチャンクだけが対象。
+		* @param _keyFunc キーを求める関数。(const CompT&)を受け取り、比較できる値を返す。
+		* @param _compare キーの比較関数。キーが等しいエンティティは元の順序を保つ。
+		* @return bool 並び順が変わった場合はtrue。
+		* @note チャンクごとの並べ替えとチャンク間のマージを並列に行い、各チャンクの行を
+		*		 新しいメモリ領域に集め直す。既に並んでいる場合は列を書き換えないので、
+		*		 エンティティを追加するたびに呼んでも、追加分を差し込む手間だけで済む。
+		*/
+		template <typename CompT, typename KeyFunc, typename Compare = std::less<>>
+		inline bool SortEntities(const Archetype& _archetype, KeyFunc&& _keyFunc, Compare _compare = Compare())
+		{
+			using KeyT = std::remove_cvref_t<std::invoke_result_t<KeyFunc&, const CompT&>>;
+
+			/**
+			* @struct SortItem
+			* @brief 並べ替える行。
+			*/
+			struct SortItem
+			{
+				//! 並べ替えのキー。
+				KeyT m_Key;
+				//! 並べ替え前のチャンクの、アーキタイプ内での番号。
+				std::uint32_t m_ChunkSlot;
+				//! 並べ替え前のチャンク内インデックス。
+				ChunkInIndex m_Row;
+			};
+
+			if (!_archetype.HasType<CompT>()) return false;
+
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			const ArchetypeTable::ArchetypeIndex archetypeIndex = table.FindArchetype(_archetype);
+			if (archetypeIndex == ArchetypeTable::cInvalidIndex) return false;
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, archetypeIndex);
+
+			// セクションのチャンクと行を交換すると、切り離すときに別のエンティティを持っていってしまうので除く
+			std::vector<std::uint32_t> chunkIndices = table.GetChunkIndices(archetypeIndex);
+			std::erase_if(chunkIndices, [this](const std::uint32_t _chunkIndex) {
+				return m_pWorld->m_ChunkList[_chunkIndex].GetSectionId() != 0; });
+			const std::size_t chunkCount = chunkIndices.size();
+
+			// チャンクごとの行の先頭位置
+			std::vector<std::size_t> offsets(chunkCount + 1, 0);
+			for (std::size_t i = 0; i < chunkCount; i++)
+				offsets[i + 1] = offsets[i] + m_pWorld->m_ChunkList[chunkIndices[i]].GetSize();
+			const std::size_t count = offsets.back();
+			if (count < 2) return false;
+
+			const auto less = [&_compare](const SortItem& _a, const SortItem& _b)
+				{ return _compare(_a.m_Key, _b.m_Key); };
+
+			//=== キーを求めて、チャンクの中で並べる
+			std::vector<SortItem> items;
+			items.reserve(count);
+			for (std::size_t i = 0; i < chunkCount; i++)
+			{
+				const Chunk& chunk = m_pWorld->m_ChunkList[chunkIndices[i]];
+				for (ChunkInIndex row = 0; row < chunk.GetSize(); row++)
+					items.push_back({ KeyT(), static_cast<std::uint32_t>(i), row });
+			}
+			ExecuteParallel(chunkCount, [&](const std::size_t _slot)
+				{
+					Chunk& chunk = m_pWorld->m_ChunkList[chunkIndices[_slot]];
+					auto components = chunk.GetComponentList<const CompT>();
+					SortItem* pBegin = items.data() + offsets[_slot];
+					for (ChunkInIndex row = 0; row < chunk.GetSize(); row++)
+						pBegin[row].m_Key = _keyFunc(components[row]);
+					std::stable_sort(pBegin, pBegin + chunk.GetSize(), less);
+				});
+
+			//=== 並んだチャンクを2つずつマージしていく。前のチャンクを優先するので元の順序は保たれる
+			std::vector<SortItem> mergeBuffer(count);
+			for (std::size_t width = 1; width < chunkCount; width *= 2)
+			{
+				const std::size_t pairCount = (chunkCount + width * 2 - 1) / (width * 2);
+				ExecuteParallel(pairCount, [&](const std::size_t _pair)
+					{
+						const std::size_t first = offsets[_pair * width * 2];
+						const std::size_t middle = offsets[(std::min)(_pair * width * 2 + width, chunkCount)];
+						const std::size_t last = offsets[(std::min)(_pair * width * 2 + width * 2, chunkCount)];
+						std::merge(
+							std::make_move_iterator(items.begin() + first), std::make_move_iterator(items.begin() + middle),
+							std::make_move_iterator(items.begin() + middle), std::make_move_iterator(items.begin() + last),
+							mergeBuffer.begin() + first, less);
+					});
+				items.swap(mergeBuffer);
+			}
+
+			// 並び順が変わらなければ何もしない
+			bool bChanged = false;
+			for (std::size_t i = 0; i < count && !bChanged; i++)
+				bChanged = offsets[items[i].m_ChunkSlot] + items[i].m_Row != i;
+			if (!bChanged) return false;
+
+			//=== 各チャンクの行を並べ替え後の順に集め直す。行数はチャンクごとに変えない
+			std::vector<const std::byte*> pSourceBuffers(count);
+			std::vector<std::uint32_t> sourceRows(count);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				pSourceBuffers[i] = m_pWorld->m_ChunkList[chunkIndices[items[i].m_ChunkSlot]].GetBuffer();
+				sourceRows[i] = items[i].m_Row;
+			}
+
+			// 他のチャンクの複製元になるので、全てのチャンクが終わるまで並べ替え前の領域を保持する
+			std::vector<std::shared_ptr<std::byte[]>> pOldBuffers(chunkCount);
+			ExecuteParallel(chunkCount, [&](const std::size_t _slot)
+				{
+					const ChunkIndex chunkIndex = chunkIndices[_slot];
+					Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+					pOldBuffers[_slot] = chunk.GatherRows(
+						pSourceBuffers.data() + offsets[_slot], sourceRows.data() + offsets[_slot]);
+
+					// エンティティごとに別の要素なので並列に書き換えてよい
+					for (ChunkInIndex row = 0; row < chunk.GetSize(); row++)
+					{
+						const EntityIndex entityIndex = GetIndex(chunk.GetEntity(row).m_Identifier);
+						m_EntityDirectory[entityIndex].SetLocation(chunkIndex, row);
+					}
+				});
+
+			if (m_bRecordEntityChanges)
+			{
+				for (auto&& chunkIndex : chunkIndices)
+				{
+					const Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+					for (ChunkInIndex row = 0; row < chunk.GetSize(); row++)
+						RecordEntityChange(GetIndex(chunk.GetEntity(row).m_Identifier));
+				}
+			}
+			return true;
 		}
 
 		/**
-		* @brief w肳ꂽA[L^Cv܂ރ`ÑXg擾܂B
-		* @param _archetype 擾A[L^CvB
-		* @return A[L^Cv܂ރ`ÑXgB
+		* @brief 指定されたアーキタイプを含むチャンクのリストを取得します。
+		* @param _archetype 取得するアーキタイプ。
+		* @return アーキタイプを含むチャンクのリスト。
 		*/
 		inline std::vector<Chunk*> GetContainChunkList(const Archetype& _archetype) const
 		{
 			std::vector<Chunk*> result;
 			result.reserve(8);
-			for (auto&& chunk : m_pWorld->m_ChunkList)
+			ArchetypeQuery query;
+			GetContainChunkList(_archetype, result, query);
+			return result;
+		}
+
+		/**
+		* @brief 指定されたアーキタイプを含むチャンクのリストを、既存の配列に取得します。
+		* @param _archetype 取得するアーキタイプ。
+		* @param _result 結果を格納する配列。中身は置き換える。
+		* @param _query 検索用のシグネチャの作業領域。
+		* @note 配列とシグネチャの容量は再利用するので、毎フレーム呼んでも確保が起きない。
+		*/
+		inline void GetContainChunkList(const Archetype& _archetype,
+			std::vector<Chunk*>& _result, ArchetypeQuery& _query) const
+		{
+			_result.clear();
+
+			const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			table.CreateQuery(_archetype, _query);
+			table.ForEachMatch(_query,
+				[this, &table, &_result](ArchetypeTable::ArchetypeIndex _archetypeIndex)
+				{
+					for (auto&& chunkIndex : table.GetChunkIndices(_archetypeIndex))
+					{
+						_result.push_back(&m_pWorld->m_ChunkList[chunkIndex]);
+					}
+				});
+		}
+
+		/**
+		* @brief 前回読んだ後に、アーキタイプの条件を満たすようになったエンティティに関数を実行します。
+		* @param _archetype 条件のアーキタイプ。全ての型を含むアーキタイプのエンティティが条件を満たす。
+		* @param _cursor 前回読んだ通し番号。0の場合は今条件を満たす全てのエンティティを対象にする。読んだ分まで進める。
+		* @param _func 実行する関数。(const Entity&, Chunk&, std::uint32_t チャンク内インデックス)を受け取る。
+		* @note 作成、コンポーネントの追加や削除、親子関係の変更で条件を満たすようになり、今も満たしている
+		*		 エンティティに1度ずつ実行する。前回も満たしていたものは、途中で外れて戻っても対象にしない。
+		*		 記録は条件の境界をまたぐ組の分しか読まないので、手間はワールドの大きさではなく変化の数で決まる。
+		*		 関数の中で構成を変えた分は次回に読む。疎な集合に格納する型は構成を変えないので条件にできない。
+		*/
+		template <typename Func>
+		inline void ForEachAddedEntity(const Archetype& _archetype, StructuralEventLog::Sequence& _cursor, Func&& _func)
+		{
+			m_StructuralEvents.Enable();
+
+			// 関数の中から別の条件で呼ばれても壊れないように、作業領域は取り出して使い、終わったら戻す
+			std::vector<Entity> entities = std::move(m_vEventEntities);
+			entities.clear();
+			if (_cursor == 0)
 			{
-				if (_archetype.IsContain(chunk.GetArchetype()))
+				// 初回は記録がないので、今条件を満たすものを全て対象にする
+				_cursor = m_StructuralEvents.GetSequence();
+				GetContainChunkList(_archetype, m_pEventChunkList, m_EventQuery);
+				for (auto&& pChunk : m_pEventChunkList)
 				{
-					result.push_back(&chunk);
+					for (std::uint32_t i = 0; i < pChunk->GetSize(); i++)
+						entities.push_back(pChunk->GetEntity(i));
 				}
 			}
-			return result;
+			else
+			{
+				CollectStructuralEvents(_archetype, _cursor, true, entities);
+				_cursor = m_StructuralEvents.GetSequence();
+			}
+			InvokeForAddedEntities(_archetype, entities, _func);
+			m_vEventEntities = std::move(entities);
 		}
 
 		/**
-		* @brief w肳ꂽA[L^CvɑΉ`ÑCfbNX擾܂͍쐬܂B
-		* @param _archetype Ώۂ̃A[L^CvB
-		* @param _maxCheck `N̍őTCY`FbN邩ǂB
-		* @return Ή`ÑCfbNXB
+		* @brief 前回読んだ後に、アーキタイプの条件を満たさなくなったエンティティに関数を実行します。
+		* @param _archetype 条件のアーキタイプ。
+		* @param _cursor 前回読んだ通し番号。0の場合は記録を読み始めるだけで関数は実行しない。読んだ分まで進める。
+		* @param _func 実行する関数。(const Entity&)を受け取る。破棄されたエンティティも含むので、
+		*		 コンポーネントは読めない。
+		* @note 破棄、コンポーネントの追加や削除で条件を満たさなくなり、今も満たしていない
+		*		 エンティティに1度ずつ実行する。前回満たしていなかったものは、途中で満たしても対象にしない。
+		*		 ForEachAddedEntityと同じ通し番号から読めば、追加を通知したエンティティにだけ通知する。
 		*/
-		inline const std::uint32_t GetAndCreateChunkIndex(const Archetype& _archetype, bool _maxCheck = false) const
+		template <typename Func>
+		inline void ForEachRemovedEntity(const Archetype& _archetype, StructuralEventLog::Sequence& _cursor, Func&& _func)
 		{
-			std::uint32_t chunkIndex = 0;
-			for (auto&& chunk : m_pWorld->m_ChunkList)
+			m_StructuralEvents.Enable();
+			if (_cursor == 0)
 			{
-				if (chunk.GetArchetype().GetSignature() == _archetype.GetSignature())
-					if (_maxCheck && !chunk.IsMax())
-						return chunkIndex;
+				_cursor = m_StructuralEvents.GetSequence();
+				return;
+			}
 
-				++chunkIndex;
+			std::vector<Entity> entities = std::move(m_vEventEntities);
+			entities.clear();
+			CollectStructuralEvents(_archetype, _cursor, false, entities);
+			_cursor = m_StructuralEvents.GetSequence();
+			for (auto&& entity : entities)
+			{
+				// 外れた後に戻ったものは外れていない扱いにする
+				if (ExistEntity(entity) && GetArchetype(entity).IsContain(_archetype))
+					continue;
+				_func(entity);
 			}
+			m_vEventEntities = std::move(entities);
+		}
+
+		/**
+		* @brief 全ての読む側が読み終えた構成の変化の記録を捨てます。
+		* @param _sequence 読む側が前回読んだ通し番号の最小値。これより前の記録を捨てる。
+		*/
+		inline void TrimStructuralEvents(const StructuralEventLog::Sequence _sequence)
+		{
+			if (m_StructuralEvents.IsEnabled())
+				m_StructuralEvents.Trim(_sequence);
+		}
+
+		/**
+		* @brief 指定されたアーキタイプに対応するチャンクのインデックスを取得または作成します。
+		* @param _archetype 対象のアーキタイプ。
+		* @return 対応する、空きのあるチャンクのインデックス。
+		*/
+		inline const std::uint32_t GetAndCreateChunkIndex(const Archetype& _archetype) const
+		{
+			return GetAndCreateChunkIndex(m_pWorld->m_ArchetypeTable.GetOrCreateArchetype(_archetype));
+		}
+
+		/**
+		* @brief アーキタイプの空きのあるチャンクのインデックスを取得します。なければ作る。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return std::uint32_t チャンクのインデックス。
+		*/
+		inline const std::uint32_t GetAndCreateChunkIndex(const ArchetypeTable::ArchetypeIndex _archetypeIndex) const
+		{
+			ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			const std::uint32_t openChunkIndex = FindOpenChunkIndex(_archetypeIndex);
+			if (openChunkIndex != mc_InvalidChunkIndex)
+				return openChunkIndex;
 
-			m_pWorld->m_ChunkList.push_back(Chunk(_archetype));
+			const std::uint32_t chunkIndex =
+				static_cast<std::uint32_t>(m_pWorld->m_ChunkList.size());
+			m_pWorld->m_ChunkList.push_back(Chunk(table.GetArchetype(_archetypeIndex)));
+			table.AddChunk(_archetypeIndex, chunkIndex);
 			return chunkIndex;
 		}
 
 		/**
-		* @brief GeBeBz擾܂B
-		* @return std::vector<std::pair<EntityInfo, Entity>>> GeBeBzB
+		* @brief アーキタイプの空きのあるチャンクのインデックスを探します。チャンクは作らない。
+		* @param _archetypeIndex アーキタイプのインデックス。
+		* @return std::uint32_t 空きのあるチャンクのインデックス。ない場合はmc_InvalidChunkIndex。
 		*/
-		std::vector<std::pair<EntityInfo, Entity>>& GetEntities()
+		inline std::uint32_t FindOpenChunkIndex(const ArchetypeTable::ArchetypeIndex _archetypeIndex) const
 		{
-			return m_vEntities;
+			// 新しいチャンクほど空きがある可能性が高いので後ろから探す。
+			// セクションのチャンクは切り離すときにまとめて外すので、新しいエンティティは入れない
+			const auto& chunkIndices = m_pWorld->m_ArchetypeTable.GetChunkIndices(_archetypeIndex);
+			for (auto it = chunkIndices.rbegin(); it != chunkIndices.rend(); ++it)
+			{
+				const Chunk& chunk = m_pWorld->m_ChunkList[*it];
+				if (!chunk.IsMax() && chunk.GetSectionId() == 0)
+					return *it;
+			}
+			return mc_InvalidChunkIndex;
+		}
+
+		/**
+		* @brief エンティティの管理情報を取得します。
+		* @return const EntityDirectory& エンティティの管理情報。
+		*/
+		const EntityDirectory& GetEntities() const noexcept
+		{
+			return m_EntityDirectory;
 		}
 
 		/**
-		* @brief w肳ꂽGeBeB̃A[L^Cv擾܂B
-		* @param _entity A[L^Cv擾GeBeBB
-		* @return Archetype w̃GeBeB̃A[L^CvB
+		* @brief 指定されたエンティティのアーキタイプを取得します。
+		* @param _entity アーキタイプを取得するエンティティ。
+		* @return Archetype 指定のエンティティのアーキタイプ。
 		*/
 		Archetype GetArchetype(const Entity& _entity)
 		{
 			const std::uint32_t entityIndex = GetIndex(_entity.m_Identifier);
-			return m_pWorld->m_ChunkList[m_vEntities[entityIndex].first.first].GetArchetype();
+			return m_pWorld->m_ChunkList[m_EntityDirectory[entityIndex].GetChunkIndex()].GetArchetype();
 		}
 
 	private:
 		/**
-		* @brief VGeBeB쐬܂B
-		* @return 쐬ꂽGeBeB̃CfbNXƃo[W̃yAB
+		* @brief 新しいエンティティを作成します。
+		* @return 作成されたエンティティのインデックスとバージョンのペア。
 		*/
 		std::pair<std::uint32_t, std::uint32_t> CreateNewEntity()
 		{
 			if (m_vRecycleEntityIndices.size() != 0)
 				std::abort();
 
-			m_vEntities.push_back(
-				std::pair<EntityInfo, Entity>(
-					std::pair<ChunkIndex, ChunkInIndex>(0, 0),
-					Entity(m_vEntities.size(), 0))
-			);
+			// 他のスレッドが予約した範囲と重ならないように、予約と同じカウンタから取る
+			const EntityIndex index = ReserveEntityIndices(1);
+			ResizeEntities(index + 1);
+			m_EntityDirectory[index].SetVersion(0);
 			return std::pair<std::uint32_t, std::uint32_t>(
-				m_vEntities.size() - 1, 0
+				index, 0
 			);
 		}
 
 		/**
-		* @brief ėp\ȃGeBeB쐬܂B
-		* @return ėpꂽGeBeB̃CfbNXƐVo[W̃yAB
+		* @brief エンティティの管理情報を指定の数まで広げます。間の予約済みで未配置のインデックスは存在しない扱いにする。
+		* @param _size 必要な要素数。
+		*/
+		void ResizeEntities(const std::size_t _size)
+		{
+			m_EntityDirectory.Grow(_size, EntityRecord(0, 0, EntityRecord::cReservedVersion));
+		}
+
+		/**
+		* @brief 別の場所で作られたチャンクのエンティティをワールドに加え、管理情報を設定します。
+		* @param _chunk 加えるチャンク。エンティティのインデックスは予約済みである必要がある。空になって返る。
+		* @note 満杯のチャンクはメモリ領域ごとそのまま加える。途中までのチャンクは毎回加えると
+		*		 チャンクが増え続けるので、行をワールドの空きのあるチャンクに移す。
+		*/
+		void AdoptChunk(Chunk& _chunk)
+		{
+			if (_chunk.GetSize() == 0) return;
+
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			const ArchetypeTable::ArchetypeIndex archetypeIndex =
+				table.GetOrCreateArchetype(_chunk.GetArchetype());
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, archetypeIndex);
+			ResizeEntities(m_NextEntityIndex.load(std::memory_order_relaxed));
+
+			if (_chunk.IsMax())
+			{
+				const ChunkIndex chunkIndex =
+					static_cast<ChunkIndex>(m_pWorld->m_ChunkList.size());
+				m_pWorld->m_ChunkList.push_back(std::move(_chunk));
+				table.AddChunk(archetypeIndex, chunkIndex);
+
+				const Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+				for (ChunkInIndex row = 0; row < chunk.GetSize(); row++)
+				{
+					const Entity& entity = chunk.GetEntity(row);
+					const EntityIndex entityIndex = GetIndex(entity.m_Identifier);
+					m_EntityDirectory[entityIndex] = EntityRecord(chunkIndex, row, GetVersion(entity.m_Identifier));
+					RecordEntityChange(entityIndex);
+					RecordStructuralEvent(ArchetypeTable::cInvalidIndex, archetypeIndex, &entity);
+				}
+				return;
+			}
+
+			// 末尾から移すと、移し元の残りの行は動かない
+			while (_chunk.GetSize() != 0)
+			{
+				const std::uint32_t chunkIndex = GetAndCreateChunkIndex(_chunk.GetArchetype());
+				Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+				std::size_t row = _chunk.GetSize() - 1;
+				Entity entity = _chunk.GetEntity(row);
+				_chunk.MoveEntity(row, entity, chunk);
+
+				const EntityIndex entityIndex = GetIndex(entity.m_Identifier);
+				m_EntityDirectory[entityIndex] = EntityRecord(
+					chunkIndex, static_cast<ChunkInIndex>(row), GetVersion(entity.m_Identifier));
+				RecordEntityChange(entityIndex);
+				RecordStructuralEvent(ArchetypeTable::cInvalidIndex, archetypeIndex, &entity);
+			}
+		}
+
+		/**
+		* @brief 予約したまま使わなかったインデックスを再利用できるようにします。
+		* @param _first 範囲の先頭。
+		* @param _end 範囲の終端。
+		*/
+		void ReleaseReservedIndices(const EntityIndex _first, const EntityIndex _end)
+		{
+			StructureWriteScope structureScope(m_pWorld->m_ArchetypeLocks);
+			ResizeEntities(m_NextEntityIndex.load(std::memory_order_relaxed));
+			for (EntityIndex i = _first; i < _end; i++)
+			{
+				// ハンドルは渡していないのでバージョンは0から使う
+				m_EntityDirectory[i].SetVersion(0);
+				RecordEntityChange(i);
+				m_vRecycleEntityIndices.push_back(i);
+			}
+		}
+
+		/**
+		* @brief 再利用可能なエンティティを作成します。
+		* @return 再利用されたエンティティのインデックスと新しいバージョンのペア。
 		*/
 		std::pair<std::uint32_t, std::uint32_t> CreateRecycleEntity()
 		{
 			if (m_vRecycleEntityIndices.size() == 0)
 				std::abort();
-			std::uint32_t index = m_vRecycleEntityIndices[0];
-			m_vRecycleEntityIndices.erase(m_vRecycleEntityIndices.begin());
-			std::uint32_t version = GetVersion(m_vEntities[index].second.m_Identifier);
-			version++;
-			SetVersion(m_vEntities[index].second.m_Identifier, version);
+			// 末尾から取り出す。バージョンは破棄時に進めてある
+			std::uint32_t index = m_vRecycleEntityIndices.back();
+			m_vRecycleEntityIndices.pop_back();
+			std::uint32_t version = m_EntityDirectory[index].GetVersion();
 			return std::pair<std::uint32_t, std::uint32_t>(index, version);
 		}
 
+		/**
+		* @brief ロックが有効な場合、再利用するインデックスが尽きていれば新しいインデックスをまとめて用意します。
+		* @note 管理情報を広げるのは構成ロックを書き込みで取っている間に限るので、1つずつではなく
+		*		 まとめて広げて再利用の一覧に入れ、続く作成を読み取りのまま行えるようにする。
+		*		 構成ロックを書き込みで取っている間に呼ぶこと。
+		*/
+		void PrepareRecycleIndices()
+		{
+			if (!m_pWorld->m_ArchetypeLocks.IsEnabled() || !m_vRecycleEntityIndices.empty())
+				return;
+
+			const EntityIndex first = ReserveEntityIndices(mc_RecycleBlockSize);
+			ResizeEntities(first + mc_RecycleBlockSize);
+			// 末尾から取り出すので、逆順に入れて小さいインデックスから使う
+			for (EntityIndex i = first + mc_RecycleBlockSize; i-- > first;)
+			{
+				m_EntityDirectory[i].SetVersion(0);
+				RecordEntityChange(i);
+				m_vRecycleEntityIndices.push_back(i);
+			}
+		}
+
+		/**
+		* @brief エンティティが存在する場合に、その管理情報を不可分に読み取ります。
+		* @param _entity 対象のエンティティ。
+		* @param _record 読み取った管理情報を受け取る。
+		* @return bool 存在する場合はtrue。
+		*/
+		bool LoadAliveRecord(const Entity& _entity, EntityRecord& _record) const noexcept
+		{
+			const EntityIndex entityIndex = GetIndex(_entity.m_Identifier);
+			if (entityIndex >= m_EntityDirectory.GetSize()) return false;
+			_record = m_EntityDirectory.Load(entityIndex);
+			return _record.GetVersion() == GetVersion(_entity.m_Identifier);
+		}
+
+		/**
+		* @brief 構成ロックを読み取りで取ったまま、既存のチャンクの空きにエンティティを作成します。
+		* @param _archetype 作成するエンティティのアーキタイプ。
+		* @param _construct 行のコンポーネントを構築する関数。(Chunk&, ChunkInIndex)を受け取る。作成できる場合だけ呼ぶ。
+		* @param _entity 作成したエンティティを受け取る。
+		* @return bool 作成した場合はtrue。アーキタイプやチャンクの追加、インデックスの用意が要る場合はfalse。
+		*/
+		template <typename ConstructFunc>
+		bool TryCreateEntityShared(const Archetype& _archetype, ConstructFunc&& _construct, Entity& _entity)
+		{
+			const ArchetypeTable::ArchetypeIndex archetypeIndex = m_pWorld->m_ArchetypeTable.FindArchetype(_archetype);
+			if (archetypeIndex == ArchetypeTable::cInvalidIndex) return false;
+
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, archetypeIndex);
+			const std::uint32_t chunkIndex = FindOpenChunkIndex(archetypeIndex);
+			if (chunkIndex == mc_InvalidChunkIndex) return false;
+
+			EntityIndex entityIndex = 0;
+			{
+				auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+				if (m_vRecycleEntityIndices.empty()) return false;
+				entityIndex = m_vRecycleEntityIndices.back();
+				m_vRecycleEntityIndices.pop_back();
+			}
+
+			EntityRecord record = m_EntityDirectory.Load(entityIndex);
+			Chunk& chunk = m_pWorld->m_ChunkList[chunkIndex];
+			const ChunkInIndex chunkInIndex = chunk.CreateEntity(entityIndex, record.GetVersion());
+			_construct(chunk, chunkInIndex);
+
+			record.SetLocation(chunkIndex, chunkInIndex);
+			m_EntityDirectory.Store(entityIndex, record);
+			RecordEntityChange(entityIndex);
+			_entity = Entity(entityIndex, record.GetVersion());
+			RecordStructuralEvent(ArchetypeTable::cInvalidIndex, archetypeIndex, &_entity);
+			return true;
+		}
+
+		/**
+		* @brief 構成ロックを読み取りで取ったまま、エンティティを破棄します。
+		* @param _entity 破棄するエンティティ。
+		* @return bool 破棄したか、存在しなかった場合はtrue。親子関係を持つ場合はfalse。
+		*/
+		bool TryDestroyEntityShared(const Entity& _entity)
+		{
+			const EntityIndex entityIndex = GetIndex(_entity.m_Identifier);
+			while (true)
+			{
+				EntityRecord record;
+				if (!LoadAliveRecord(_entity, record)) return true;
+
+				// 親子関係を持つ場合は子の一覧を書き換えるので、書き込みで取り直す
+				const Chunk& chunk = m_pWorld->m_ChunkList[record.GetChunkIndex()];
+				if (chunk.GetArchetype().HasType<Parent>() || m_Children.contains(entityIndex)) return false;
+
+				const ArchetypeTable::ArchetypeIndex archetypeIndex = GetArchetypeIndexOfChunk(record.GetChunkIndex());
+				ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, archetypeIndex);
+				// ロックを取るまでに他のスレッドが行を動かしていたら引き直す
+				if (!(m_EntityDirectory.Load(entityIndex) == record)) continue;
+
+				{
+					auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+					for (auto&& [typeId, pSet] : m_pWorld->m_SparseSets)
+						pSet->Remove(entityIndex);
+				}
+
+				RecordStructuralEvent(archetypeIndex, ArchetypeTable::cInvalidIndex, &_entity);
+				m_pWorld->m_ChunkList[record.GetChunkIndex()].DestroyEntity(record.GetChunkInIndex());
+				UpdateMovedEntity(record.GetChunkIndex(), record.GetChunkInIndex());
+
+				// 行を手放す前にバージョンを進めて、他のスレッドから存在しない扱いにする
+				record.SetVersion(EntityRecord::NextVersion(record.GetVersion()));
+				m_EntityDirectory.Store(entityIndex, record);
+				RecordEntityChange(entityIndex);
+
+				auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+				m_vRecycleEntityIndices.push_back(entityIndex);
+				return true;
+			}
+		}
+
+		/**
+		* @brief 構成ロックを読み取りで取ったまま、エンティティを既存のチャンクの空きに移します。
+		* @tparam CompT 加える、または除くコンポーネントの型。
+		* @param _entity 移すエンティティ。
+		* @param _bAdd 加える場合はtrue。
+		* @return bool 移したか、移す必要がなかった場合はtrue。遷移の記録やチャンクの追加が要る場合はfalse。
+		*/
+		template <typename CompT>
+		bool TryMoveToArchetypeShared(const Entity& _entity, const bool _bAdd)
+		{
+			const EntityIndex entityIndex = GetIndex(_entity.m_Identifier);
+			while (true)
+			{
+				EntityRecord record;
+				if (!LoadAliveRecord(_entity, record)) return true;
+
+				if (m_pWorld->m_ChunkList[record.GetChunkIndex()].GetArchetype().HasType<CompT>() == _bAdd) return true;
+				const ArchetypeTable::ArchetypeIndex newArchetypeIndex = m_pWorld->m_ArchetypeTable.FindTransition(
+					GetArchetypeIndexOfChunk(record.GetChunkIndex()), TypeManager::TypeInfo<CompT>::GetID(), _bAdd);
+				if (newArchetypeIndex == ArchetypeTable::cInvalidIndex) return false;
+
+				ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks,
+					GetArchetypeIndexOfChunk(record.GetChunkIndex()), newArchetypeIndex);
+				if (!(m_EntityDirectory.Load(entityIndex) == record)) continue;
+
+				const std::uint32_t newChunkIndex = FindOpenChunkIndex(newArchetypeIndex);
+				if (newChunkIndex == mc_InvalidChunkIndex) return false;
+				MoveRow(entityIndex, record, newChunkIndex);
+				return true;
+			}
+		}
+
+		/**
+		* @brief チャンクの穴埋めで移動したエンティティの管理情報を更新します。
+		* @param _chunkIndex 穴が空いたチャンクのインデックス。
+		* @param _chunkInIndex 穴が空いたチャンク内インデックス。
+		*/
+		void UpdateMovedEntity(const ChunkIndex _chunkIndex, const ChunkInIndex _chunkInIndex)
+		{
+			const Chunk& chunk = m_pWorld->m_ChunkList[_chunkIndex];
+			if (_chunkInIndex >= chunk.GetSize()) return;
+
+			const EntityIndex movedIndex = GetIndex(chunk.GetEntity(_chunkInIndex).m_Identifier);
+			EntityRecord record = m_EntityDirectory.Load(movedIndex);
+			record.SetChunkInIndex(_chunkInIndex);
+			m_EntityDirectory.Store(movedIndex, record);
+			RecordEntityChange(movedIndex);
+		}
+
+		/**
+		* @brief エンティティを別のアーキタイプのチャンクに移し、共通のコンポーネントを引き継ぎます。
+		* @param _entityIndex 移すエンティティのインデックス。
+		* @param _archetype 移動先のアーキタイプ。
+		*/
+		void MoveToArchetype(const EntityIndex _entityIndex, const Archetype& _archetype)
+		{
+			MoveToArchetype(_entityIndex, m_pWorld->m_ArchetypeTable.GetOrCreateArchetype(_archetype));
+		}
+
+		/**
+		* @brief エンティティを別のアーキタイプのチャンクに移し、共通のコンポーネントを引き継ぎます。
+		* @param _entityIndex 移すエンティティのインデックス。
+		* @param _archetypeIndex 移動先のアーキタイプのインデックス。
+		*/
+		void MoveToArchetype(const EntityIndex _entityIndex, const ArchetypeTable::ArchetypeIndex _archetypeIndex)
+		{
+			const EntityRecord record = m_EntityDirectory[_entityIndex];
+
+			const std::uint32_t newChunkIndex =
+				GetAndCreateChunkIndex(_archetypeIndex);
+			ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks,
+				GetArchetypeIndexOfChunk(record.GetChunkIndex()), GetArchetypeIndexOfChunk(newChunkIndex));
+			MoveRow(_entityIndex, record, newChunkIndex);
+		}
+
+		/**
+		* @brief エンティティの行を別のチャンクに移し、管理情報を更新します。両方のアーキタイプのロックを取っている間に呼ぶ。
+		* @param _entityIndex 移すエンティティのインデックス。
+		* @param _record 移す前の管理情報。
+		* @param _newChunkIndex 移動先の、空きのあるチャンクのインデックス。
+		*/
+		void MoveRow(const EntityIndex _entityIndex, const EntityRecord& _record, const ChunkIndex _newChunkIndex)
+		{
+			Chunk& chunk = m_pWorld->m_ChunkList[_newChunkIndex];
+
+			std::size_t chunkInIndex = _record.GetChunkInIndex();
+			Entity entity = Entity(_entityIndex, _record.GetVersion());
+			m_pWorld->m_ChunkList[_record.GetChunkIndex()].MoveEntity(
+				chunkInIndex, entity, chunk
+			);
+			EntityRecord newRecord = _record;
+			newRecord.SetLocation(_newChunkIndex, static_cast<ChunkInIndex>(chunkInIndex));
+			m_EntityDirectory.Store(_entityIndex, newRecord);
+			RecordEntityChange(_entityIndex);
+			RecordStructuralEvent(GetArchetypeIndexOfChunk(_record.GetChunkIndex()),
+				GetArchetypeIndexOfChunk(_newChunkIndex), &entity);
+			UpdateMovedEntity(_record.GetChunkIndex(), _record.GetChunkInIndex());
+		}
+
+		/**
+		* @brief エンティティのParentを取得します。
+		* @param _entityIndex エンティティのインデックス。
+		* @return const Parent* Parent。親がいない場合はnullptr。
+		*/
+		const Parent* FindParent(const EntityIndex _entityIndex)
+		{
+			const EntityRecord& record = m_EntityDirectory[_entityIndex];
+			Chunk& chunk = m_pWorld->m_ChunkList[record.GetChunkIndex()];
+			if (!chunk.GetArchetype().HasType<Parent>()) return nullptr;
+			return &chunk.GetComponentList<const Parent>()[record.GetChunkInIndex()];
+		}
+
+		/**
+		* @brief 親の子の一覧からエンティティを外します。
+		* @param _entityIndex 外すエンティティのインデックス。
+		*/
+		void DetachFromParent(const EntityIndex _entityIndex)
+		{
+			const Parent* pParent = FindParent(_entityIndex);
+			if (!pParent) return;
+
+			auto it = m_Children.find(GetIndex(pParent->m_Entity.m_Identifier));
+			if (it == m_Children.end()) return;
+			auto& children = it->second;
+			for (std::size_t i = 0; i < children.size(); i++)
+			{
+				if (GetIndex(children[i].m_Identifier) == _entityIndex)
+				{
+					children[i] = children.back();
+					children.pop_back();
+					break;
+				}
+			}
+			if (children.empty())
+				m_Children.erase(it);
+		}
+
+		/**
+		* @brief 親と深さを設定し、深さに応じたアーキタイプに移します。子孫にも再帰的に適用する。
+		* @param _entityIndex 対象のエンティティのインデックス。
+		* @param _parent 親のエンティティ。
+		* @param _depth 階層の深さ。
+		*/
+		void UpdateHierarchy(const EntityIndex _entityIndex, const Entity& _parent, const std::uint32_t _depth)
+		{
+			Archetype newArchetype =
+				m_pWorld->m_ChunkList[m_EntityDirectory[_entityIndex].GetChunkIndex()].GetArchetype();
+			if (const Parent* pParent = FindParent(_entityIndex))
+				newArchetype.RemoveType(HierarchyDepth::GetTypeId(pParent->m_Depth));
+			newArchetype.AddType<Parent>();
+			newArchetype.AddType(HierarchyDepth::GetTypeId(_depth), 0, 1);
+			if (!(newArchetype == m_pWorld->m_ChunkList[m_EntityDirectory[_entityIndex].GetChunkIndex()].GetArchetype()))
+				MoveToArchetype(_entityIndex, newArchetype);
+
+			const EntityRecord& record = m_EntityDirectory[_entityIndex];
+			{
+				ArchetypeWriteScope archetypeScope(m_pWorld->m_ArchetypeLocks, GetArchetypeIndexOfChunk(record.GetChunkIndex()));
+				m_pWorld->m_ChunkList[record.GetChunkIndex()].SetComponentData(
+					record.GetChunkInIndex(), Parent{ {}, _parent, _depth });
+			}
+			m_MaxHierarchyDepth = (std::max)(m_MaxHierarchyDepth, _depth);
+
+			auto it = m_Children.find(_entityIndex);
+			if (it == m_Children.end()) return;
+			const Entity self = m_EntityDirectory.GetEntity(_entityIndex);
+			for (auto&& child : it->second)
+				UpdateHierarchy(GetIndex(child.m_Identifier), self, _depth + 1);
+		}
+
+		/**
+		* @brief Parentコンポーネントから子の一覧を作り直します。
+		* @note ファイルなどからエンティティの配列を直接復元した後に呼ぶ。
+		*/
+		void RebuildHierarchy()
+		{
+			m_Children.clear();
+			m_MaxHierarchyDepth = 0;
+			for (EntityIndex i = 0; i < m_EntityDirectory.GetSize(); i++)
+			{
+				const EntityRecord& record = m_EntityDirectory[i];
+				if (record.GetChunkIndex() >= m_pWorld->m_ChunkList.size() ||
+					record.GetChunkInIndex() >= m_pWorld->m_ChunkList[record.GetChunkIndex()].GetSize() ||
+					m_pWorld->m_ChunkList[record.GetChunkIndex()].GetEntity(record.GetChunkInIndex()).m_Identifier
+						!= m_EntityDirectory.GetEntity(i).m_Identifier)
+					continue;
+
+				const Parent* pParent = FindParent(i);
+				if (!pParent) continue;
+				m_Children[GetIndex(pParent->m_Entity.m_Identifier)].push_back(m_EntityDirectory.GetEntity(i));
+				m_MaxHierarchyDepth = (std::max)(m_MaxHierarchyDepth, pParent->m_Depth);
+			}
+		}
+
+		/**
+		* @brief 0から_count-1までの番号ごとに関数を並列に実行し、全て完了するまで待ちます。
+		* @param _count 実行する数。
+		* @param _func 実行する関数。番号を受け取る。
+		*/
+		template <typename Func>
+		void ExecuteParallel(const std::size_t _count, Func&& _func)
+		{
+			m_pWorld->m_pAsyncFunctionManager->ParallelFor(_count, 1, _func);
+		}
+
+		/**
+		* @brief チャンクが属するアーキタイプのインデックスを取得します。
+		* @param _chunkIndex チャンクのインデックス。
+		* @return ArchetypeTable::ArchetypeIndex アーキタイプのインデックス。
+		*/
+		inline ArchetypeTable::ArchetypeIndex GetArchetypeIndexOfChunk(const ChunkIndex _chunkIndex) const
+		{
+			return m_pWorld->m_ArchetypeTable.GetArchetypeIndexOfChunk(_chunkIndex);
+		}
+
+		/**
+		* @brief エンティティの管理情報が変わったことを記録します。
+		* @param _entityIndex 変更されたエンティティのインデックス。
+		*/
+		inline void RecordEntityChange(const EntityIndex _entityIndex)
+		{
+			if (!m_bRecordEntityChanges) return;
+			auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+			m_vChangedEntityIndices.push_back(_entityIndex);
+		}
+
+		/**
+		* @brief エンティティの構成の変化を記録します。読む側がいない間は何もしない。
+		* @param _from 移動元のアーキタイプのインデックス。作成の場合はcInvalidIndex。
+		* @param _to 移動先のアーキタイプのインデックス。破棄の場合はcInvalidIndex。
+		* @param _pEntities 対象のエンティティ。
+		* @param _count 対象の数。
+		*/
+		inline void RecordStructuralEvent(const ArchetypeTable::ArchetypeIndex _from,
+			const ArchetypeTable::ArchetypeIndex _to, const Entity* _pEntities, const std::size_t _count = 1)
+		{
+			if (!m_StructuralEvents.IsEnabled()) return;
+			auto bookkeepingLock = m_pWorld->m_ArchetypeLocks.LockBookkeeping();
+			m_StructuralEvents.Record(_from, _to, _pEntities, _count);
+		}
+
+		/**
+		* @brief 今も存在し、アーキタイプの条件を満たしているエンティティに関数を実行します。
+		* @param _archetype 条件のアーキタイプ。
+		* @param _entities 対象のエンティティ。
+		* @param _func 実行する関数。(const Entity&, Chunk&, std::uint32_t チャンク内インデックス)を受け取る。
+		*/
+		template <typename Func>
+		void InvokeForAddedEntities(const Archetype& _archetype, const std::vector<Entity>& _entities, Func& _func)
+		{
+			for (auto&& entity : _entities)
+			{
+				// 関数の中で構成が変わることがあるので、場所は1つずつ引き直す
+				if (!ExistEntity(entity)) continue;
+				const EntityRecord record = m_EntityDirectory[GetIndex(entity.m_Identifier)];
+				Chunk& chunk = m_pWorld->m_ChunkList[record.GetChunkIndex()];
+				if (!chunk.GetArchetype().IsContain(_archetype)) continue;
+				_func(entity, chunk, record.GetChunkInIndex());
+			}
+		}
+
+		/**
+		* @brief 前回読んだ後に、条件の境界をまたいだエンティティを集めます。
+		* @param _archetype 条件のアーキタイプ。
+		* @param _cursor 前回読んだ通し番号。
+		* @param _bAdded trueの場合は前回は条件を満たしていなかったもの、falseの場合は満たしていたものを集める。
+		* @param _result 集めたエンティティ。識別ビットの順に並べる。
+		* @note 前回の状態は、読んでいない記録のうち最初にまたいだ向きから判断する。
+		*/
+		void CollectStructuralEvents(const Archetype& _archetype, const StructuralEventLog::Sequence _cursor,
+			const bool _bAdded, std::vector<Entity>& _result)
+		{
+			const ArchetypeTable& table = m_pWorld->m_ArchetypeTable;
+			const auto isMatch = [&](const ArchetypeTable::ArchetypeIndex _archetypeIndex)
+				{
+					return _archetypeIndex < table.GetArchetypeCount() &&
+						table.GetArchetype(_archetypeIndex).IsContain(_archetype);
+				};
+
+			// 組ごとに境界をまたぐかを判定し、またぐ組の新しい分だけを読む。(記録, 条件を満たすようになったか)
+			auto& events = m_vEventScratch;
+			events.clear();
+			for (auto&& transition : m_StructuralEvents.GetTransitions())
+			{
+				const bool bToMatch = isMatch(transition.m_To);
+				if (isMatch(transition.m_From) == bToMatch)
+					continue;
+
+				for (auto it = StructuralEventLog::FindFrom(transition, _cursor); it != transition.m_Events.end(); ++it)
+					events.emplace_back(*it, bToMatch);
+			}
+
+			std::sort(events.begin(), events.end(), [](const auto& _a, const auto& _b) {
+				return _a.first.m_Entity.m_Identifier != _b.first.m_Entity.m_Identifier ?
+					_a.first.m_Entity.m_Identifier < _b.first.m_Entity.m_Identifier :
+					_a.first.m_Sequence < _b.first.m_Sequence; });
+			for (std::size_t i = 0; i < events.size(); i++)
+			{
+				if ((i == 0 || events[i - 1].first.m_Entity.m_Identifier != events[i].first.m_Entity.m_Identifier) &&
+					events[i].second == _bAdded)
+					_result.push_back(events[i].first.m_Entity);
+			}
+		}
+
 	private:
-		//! GeBeBƂ̏ێzB
-		std::vector<std::pair<EntityInfo, Entity>> m_vEntities;
-		//! ėp\ȃGeBeBCfbNX̔zB
+		//! エンティティの所属するチャンクと行、バージョンの管理情報。
+		EntityDirectory m_EntityDirectory;
+		//! 再利用可能なエンティティインデックスの配列。
 		std::vector<std::uint32_t> m_vRecycleEntityIndices;
-		//! 郏[hւ̃|C^B
+		//! 管理情報が変更されたエンティティインデックスの記録。重複を含む。
+		std::vector<EntityIndex> m_vChangedEntityIndices;
+		//! 管理情報の変更を記録するかどうか。
+		bool m_bRecordEntityChanges = false;
+		//! 作成、破棄、アーキタイプの移動の記録。
+		StructuralEventLog m_StructuralEvents;
+		//! 構成の変化を読むときに集めるエンティティ。確保を使い回すために保持する。
+		std::vector<Entity> m_vEventEntities;
+		//! 構成の変化を読むときに集める、境界をまたいだ記録と向き。同じく使い回す。
+		std::vector<std::pair<StructuralEventLog::Event, bool>> m_vEventScratch;
+		//! 初回に条件を満たすチャンクを集める配列。同じく使い回す。
+		std::vector<Chunk*> m_pEventChunkList;
+		//! 初回にチャンクを探すときの検索用のシグネチャ。同じく使い回す。
+		ArchetypeQuery m_EventQuery;
+		//! 親のエンティティインデックスごとの子の一覧。
+		std::unordered_map<EntityIndex, std::vector<Entity>> m_Children;
+		//! これまでに作られた階層の深さの最大値。
+		std::uint32_t m_MaxHierarchyDepth = 0;
+		//! 次に割り当てるエンティティのインデックス。予約はこのカウンタを進めるだけで行う。
+		std::atomic<EntityIndex> m_NextEntityIndex = 0;
+		//! 属するワールドへのポインタ。
 		World* m_pWorld = nullptr;
+		//! Instantiateで列の複製を並列に行うエンティティ数。
+		static constexpr std::size_t mc_ParallelInstantiateCount = 4096;
+		//! ロックが有効な場合に、まとめて用意する新しいインデックスの数。
+		static constexpr std::uint32_t mc_RecycleBlockSize = 256;
+		//! チャンクが見つからなかったことを表すインデックス。
+		static constexpr std::uint32_t mc_InvalidChunkIndex = ~std::uint32_t(0);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Entity.h"
+#include "Chunk.h"
+#include "StaticArchetype.h"
+#include "EntityManager.h"
+
+namespace ECS
+{
+	/**
+	* @class EntitySpawner
+	* @brief ワーカーのジョブからエンティティを作るための、ジョブごとの作成バッファ。
+	* @note インデックスはEntityManagerからブロック単位でアトミックに予約するので、
+	*		 作成したハンドルはその場で使える(他のエンティティのコンポーネントに保存するなど)。
+	*		 コンポーネントはこのオブジェクトが持つチャンクに直接構築し、Place()で満杯のチャンクは
+	*		 チャンクごと、途中までのチャンクは行をワールドの空きのあるチャンクに移して加える。Spawnは1つのスレッドからのみ呼び、Place()はワールドの更新の外
+	*		 (システムのジョブが動いていない間)にメインスレッドから呼ぶこと。
+	*		 Parentを持たせて作成したエンティティは、Place()でSetParentと同じく親の子として登録する。
+	*/
+	class EntitySpawner
+	{
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _entityManager 作成先のエンティティマネージャー。
+		*/
+		explicit EntitySpawner(EntityManager& _entityManager)
+			: m_pEntityManager(&_entityManager)
+		{}
+
+		/**
+		* @brief デストラクタ。
+		* @note 配置していないエンティティが残っている場合は停止する。ジョブの中で破棄されても
+		*		 ワールドに触れないように、配置は必ずPlace()で行う。
+		*/
+		~EntitySpawner()
+		{
+			if (!m_Chunks.empty() || m_NextIndex != m_EndIndex)
+				std::abort();
+		}
+
+		EntitySpawner(const EntitySpawner&) = delete;
+		EntitySpawner& operator=(const EntitySpawner&) = delete;
+
+		/**
+		* @brief 指定されたコンポーネントの値を持つエンティティを作成します。
+		* @tparam CompTs エンティティが持つコンポーネントの型。
+		* @param _values 各コンポーネントの初期値。
+		* @return Entity 作成したエンティティ。Place()までは存在しない扱いになる。
+		*/
+		template <typename... CompTs>
+			requires (sizeof...(CompTs) > 0)
+		Entity Spawn(CompTs&&... _values)
+		{
+			using StaticArchetypeT = StaticArchetype<std::remove_cvref_t<CompTs>...>;
+
+			if (m_NextIndex == m_EndIndex)
+			{
+				m_NextIndex = m_pEntityManager->ReserveEntityIndices(mc_BlockSize);
+				m_EndIndex = m_NextIndex + mc_BlockSize;
+			}
+			const EntityIndex entityIndex = m_NextIndex++;
+
+			Chunk& chunk = GetOpenChunk(StaticArchetypeT::cArchetype);
+			const std::uint32_t chunkInIndex = chunk.CreateEntity(entityIndex, 0);
+			StaticArchetypeT::Construct(chunk, chunkInIndex, std::forward<CompTs>(_values)...);
+			return Entity(entityIndex, 0);
+		}
+
+		/**
+		* @brief 作成したエンティティをワールドに配置します。
+		* @note 満杯のチャンクは複製せずにそのままワールドに加え、途中までのチャンクは行を
+		*		 ワールドの空きのあるチャンクに移す。予約したまま使わなかった
+		*		 インデックスは再利用できるように返す。Parentを持つエンティティは親の子として
+		*		 登録し直し、深さごとのアーキタイプに移す。親が存在しないか循環する場合はParentを外す。
+		*/
+		void Place()
+		{
+			m_vParentLinks.clear();
+			for (auto&& chunk : m_Chunks)
+			{
+				// 加えるとチャンクは空になるので、先に親の指定を全て読んでおく
+				if (chunk.GetArchetype().HasType<Parent>())
+				{
+					auto parents = chunk.GetComponentList<const Parent>();
+					for (std::uint32_t row = 0; row < chunk.GetSize(); row++)
+						m_vParentLinks.emplace_back(chunk.GetEntity(row), parents[row].m_Entity);
+				}
+				m_pEntityManager->AdoptChunk(chunk);
+			}
+			m_Chunks.clear();
+			m_OpenChunks.clear();
+
+			for (auto&& [child, parent] : m_vParentLinks)
+			{
+				if (!m_pEntityManager->SetParent(child, parent))
+					m_pEntityManager->RemoveComponent<Parent>(child);
+			}
+			m_vParentLinks.clear();
+
+			if (m_NextIndex != m_EndIndex)
+				m_pEntityManager->ReleaseReservedIndices(m_NextIndex, m_EndIndex);
+			m_NextIndex = m_EndIndex = 0;
+		}
+
+	private:
+		/**
+		* @brief アーキタイプの空きのあるチャンクを取得します。なければ作る。
+		* @param _archetype StaticArchetypeのアーキタイプ。アドレスで同じ型リストかを判定する。
+		* @return Chunk& 空きのあるチャンク。
+		*/
+		Chunk& GetOpenChunk(const Archetype& _archetype)
+		{
+			for (auto&& [pArchetype, chunkIndex] : m_OpenChunks)
+			{
+				if (pArchetype != &_archetype)
+					continue;
+				if (!m_Chunks[chunkIndex].IsMax())
+					return m_Chunks[chunkIndex];
+
+				chunkIndex = m_Chunks.size();
+				m_Chunks.emplace_back(_archetype);
+				return m_Chunks.back();
+			}
+
+			m_OpenChunks.emplace_back(&_archetype, m_Chunks.size());
+			m_Chunks.emplace_back(_archetype);
+			return m_Chunks.back();
+		}
+
+	private:
+		//! 作成先のエンティティマネージャー。
+		EntityManager* m_pEntityManager = nullptr;
+		//! 作成したエンティティを格納するチャンク。
+		std::vector<Chunk> m_Chunks;
+		//! Place()で登録する子と親の組。確保を使い回すために保持する。
+		std::vector<std::pair<Entity, Entity>> m_vParentLinks;
+		//! アーキタイプごとの、空きのあるチャンクのm_Chunks内の位置。
+		std::vector<std::pair<const Archetype*, std::size_t>> m_OpenChunks;
+		//! 予約済みのブロックで次に使うインデックス。
+		EntityIndex m_NextIndex = 0;
+		//! 予約済みのブロックの終端。
+		EntityIndex m_EndIndex = 0;
+		//! 1度に予約するインデックスの数。
+		static constexpr std::uint32_t mc_BlockSize = 256;
+	};
+}
@@ -1,11 +1,26 @@
 #pragma once
 
+#include <type_traits>
 
 namespace ECS
 {
 	/**
 	* @struct IComponentData
-	* @brief C^[tFCXNXBSẴR|[lg͂pB
+	* @brief インターフェイスクラス。全てのコンポーネントはこれを継承する。
 	*/
 	struct IComponentData {};
-}
\ No newline at end of file
+
+	/**
+	* @struct ISparseComponentData
+	* @brief チャンクではなく、エンティティのインデックスで引く疎な集合に格納するコンポーネントのインターフェイス。
+	* @note アーキタイプには含まれないので、追加や削除でエンティティがチャンク間を移動しない。
+	*		 短い間だけ付くバフや目印など、頻繁に付け外しするコンポーネントに使う。
+	*/
+	struct ISparseComponentData : IComponentData {};
+
+	/**
+	* @brief 疎な集合に格納するコンポーネントかどうか。
+	*/
+	template <typename T>
+	concept SparseComponent = std::is_base_of_v<ISparseComponentData, std::remove_cvref_t<T>>;
+}
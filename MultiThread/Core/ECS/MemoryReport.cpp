@@ -0,0 +1,154 @@
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "World.h"
+#include "EntityManager.h"
+#include "Chunk.h"
+
+namespace ECS
+{
+	MemoryReport MemoryReport::Create(const World& _world)
+	{
+		MemoryReport result;
+		const ArchetypeTable& archetypeTable = _world.m_ArchetypeTable;
+
+		for (ArchetypeTable::ArchetypeIndex archetypeIndex = 0;
+			archetypeIndex < archetypeTable.GetArchetypeCount(); archetypeIndex++)
+		{
+			const std::vector<std::uint32_t>& chunkIndices = archetypeTable.GetChunkIndices(archetypeIndex);
+			if (chunkIndices.empty())
+				continue;
+
+			const Archetype& archetype = archetypeTable.GetArchetype(archetypeIndex);
+			ArchetypeMemoryInfo info;
+			info.m_ArchetypeIndex = archetypeIndex;
+			info.m_ComponentCount = archetype.GetArchetypeSize();
+			info.m_ChunkCount = chunkIndices.size();
+			info.m_RowsPerChunk = Chunk::CalculateMaxSize(archetype);
+			info.m_RowSize = sizeof(Entity) + archetype.GetArchetypeMemorySize();
+			for (const std::uint32_t chunkIndex : chunkIndices)
+			{
+				const Chunk& chunk = _world.m_ChunkList[chunkIndex];
+				const std::uint32_t size = chunk.GetSize();
+				info.m_RowCount += size;
+				if (size == 0)
+					info.m_EmptyChunkCount++;
+				if (chunk.IsCompressed())
+				{
+					info.m_CompressedChunkCount++;
+					info.m_CompressedBytes += chunk.GetCompressedSize();
+				}
+			}
+
+			const std::size_t rowCapacity = info.m_ChunkCount * info.m_RowsPerChunk;
+			info.m_RowCapacity = rowCapacity;
+			info.m_AllocatedBytes = (info.m_ChunkCount - info.m_CompressedChunkCount) * Chunk::GetCapacity() +
+				info.m_CompressedBytes;
+			info.m_UsedBytes = info.m_RowCount * info.m_RowSize;
+			info.m_PaddingBytes = info.m_ChunkCount * (Chunk::GetCapacity() - info.m_RowsPerChunk * info.m_RowSize);
+			info.m_EmptyRowBytes = (rowCapacity - info.m_RowCount) * info.m_RowSize;
+			const std::size_t requiredChunkCount = info.m_RowsPerChunk > 0 ?
+				(info.m_RowCount + info.m_RowsPerChunk - 1) / info.m_RowsPerChunk : 0;
+			info.m_ReclaimableChunkCount = info.m_ChunkCount - requiredChunkCount;
+
+			//=== 列ごとの確保量。Entityの列も含めて多い順に残す
+			std::vector<ColumnMemoryInfo> columns;
+			columns.reserve(info.m_ComponentCount + 1);
+			columns.push_back({ 0, sizeof(Entity), sizeof(Entity) * rowCapacity });
+			for (std::size_t i = 0; i < info.m_ComponentCount; i++)
+			{
+				const std::size_t elementSize = archetype.GetMemorySizeByIndex(i);
+				columns.push_back({ archetype.GetComponentIdByIndex(i), elementSize, elementSize * rowCapacity });
+			}
+			std::stable_sort(columns.begin(), columns.end(), [](const ColumnMemoryInfo& _a, const ColumnMemoryInfo& _b) {
+				return _a.m_AllocatedBytes > _b.m_AllocatedBytes; });
+			columns.resize((std::min)(columns.size(), cLargestColumnCount));
+			info.m_LargestColumns = std::move(columns);
+
+			//=== 合計に加える
+			ArchetypeMemoryInfo& total = result.m_Total;
+			total.m_ChunkCount += info.m_ChunkCount;
+			total.m_EmptyChunkCount += info.m_EmptyChunkCount;
+			total.m_RowCount += info.m_RowCount;
+			total.m_RowCapacity += info.m_RowCapacity;
+			total.m_AllocatedBytes += info.m_AllocatedBytes;
+			total.m_UsedBytes += info.m_UsedBytes;
+			total.m_PaddingBytes += info.m_PaddingBytes;
+			total.m_EmptyRowBytes += info.m_EmptyRowBytes;
+			total.m_ReclaimableChunkCount += info.m_ReclaimableChunkCount;
+			total.m_CompressedChunkCount += info.m_CompressedChunkCount;
+			total.m_CompressedBytes += info.m_CompressedBytes;
+
+			result.m_Archetypes.push_back(std::move(info));
+		}
+
+		//=== エンティティの管理情報
+		const EntityManager& entityManager = *_world.m_pEntityManager;
+		result.m_EntityDirectoryCount = entityManager.m_EntityDirectory.GetSize();
+		result.m_EntityDirectoryBytes = entityManager.m_EntityDirectory.GetMemorySize();
+		result.m_FreeListLength = entityManager.m_vRecycleEntityIndices.size();
+		result.m_EntityDirectoryBytes +=
+			entityManager.m_vRecycleEntityIndices.capacity() * sizeof(entityManager.m_vRecycleEntityIndices[0]);
+
+		for (auto&& [typeId, pSet] : _world.m_SparseSets)
+			result.m_SparseSetBytes += pSet->GetMemorySize();
+
+		return result;
+	}
+
+	void MemoryReport::Dump(std::ostream& _stream) const
+	{
+		const auto flags = _stream.flags();
+		const auto precision = _stream.precision();
+		_stream << std::fixed << std::setprecision(1);
+
+		_stream << "[MemoryReport] chunk capacity " << Chunk::GetCapacity() << " bytes\n";
+		for (const ArchetypeMemoryInfo& info : m_Archetypes)
+		{
+			_stream << "archetype " << info.m_ArchetypeIndex
+				<< ": components " << info.m_ComponentCount
+				<< ", chunks " << info.m_ChunkCount << " (empty " << info.m_EmptyChunkCount
+				<< ", reclaimable " << info.m_ReclaimableChunkCount << ")"
+				<< ", rows " << info.m_RowCount << " / " << info.m_RowCapacity
+				<< " (" << info.m_RowsPerChunk << " per chunk, " << info.m_RowSize << " bytes)"
+				<< ", fill " << info.GetFillRatio() * 100.0f << "%\n";
+			_stream << "    allocated " << info.m_AllocatedBytes
+				<< ", used " << info.m_UsedBytes
+				<< ", padding " << info.m_PaddingBytes
+				<< ", empty rows " << info.m_EmptyRowBytes << " bytes\n";
+			if (info.m_CompressedChunkCount > 0)
+				_stream << "    compressed chunks " << info.m_CompressedChunkCount
+					<< ", " << info.m_CompressedBytes << " bytes\n";
+			_stream << "    largest columns:";
+			for (const ColumnMemoryInfo& column : info.m_LargestColumns)
+			{
+				if (column.m_TypeId == 0)
+					_stream << " [Entity";
+				else
+					_stream << " [0x" << std::hex << column.m_TypeId << std::dec;
+				_stream << " " << column.m_ElementSize << "B, " << column.m_AllocatedBytes << " bytes]";
+			}
+			_stream << "\n";
+		}
+
+		_stream << "total: chunks " << m_Total.m_ChunkCount << " (empty " << m_Total.m_EmptyChunkCount
+			<< ", reclaimable " << m_Total.m_ReclaimableChunkCount << ")"
+			<< ", rows " << m_Total.m_RowCount << " / " << m_Total.m_RowCapacity
+			<< ", fill " << m_Total.GetFillRatio() * 100.0f << "%"
+			<< ", allocated " << m_Total.m_AllocatedBytes
+			<< ", used " << m_Total.m_UsedBytes
+			<< ", padding " << m_Total.m_PaddingBytes
+			<< ", empty rows " << m_Total.m_EmptyRowBytes << " bytes\n";
+		if (m_Total.m_CompressedChunkCount > 0)
+			_stream << "compressed: chunks " << m_Total.m_CompressedChunkCount
+				<< ", " << m_Total.m_CompressedBytes << " bytes\n";
+		_stream << "entity directory: " << m_EntityDirectoryCount << " entries, "
+			<< m_EntityDirectoryBytes << " bytes, free list " << m_FreeListLength << "\n";
+		_stream << "sparse sets: " << m_SparseSetBytes << " bytes\n";
+
+		_stream.flags(flags);
+		_stream.precision(precision);
+	}
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Archetype.h"
+#include "ArchetypeTable.h"
+
+namespace ECS
+{
+	class World;
+
+	/**
+	* @struct ColumnMemoryInfo
+	* @brief 1つの列が確保しているメモリ量。
+	*/
+	struct ColumnMemoryInfo
+	{
+		//! コンポーネントの型ID。Entityの列は0。
+		TypeId m_TypeId = 0;
+		//! 1要素のサイズ[byte]。
+		std::size_t m_ElementSize = 0;
+		//! 全チャンクでこの列が確保しているメモリ量[byte]。
+		std::size_t m_AllocatedBytes = 0;
+	};
+
+	/**
+	* @struct ArchetypeMemoryInfo
+	* @brief 1つのアーキタイプのチャンクの使用状況。
+	*/
+	struct ArchetypeMemoryInfo
+	{
+		//! アーキタイプのインデックス。
+		ArchetypeTable::ArchetypeIndex m_ArchetypeIndex = ArchetypeTable::cInvalidIndex;
+		//! コンポーネントの種類の数。
+		std::size_t m_ComponentCount = 0;
+		//! チャンクの数。
+		std::size_t m_ChunkCount = 0;
+		//! 空のチャンクの数。
+		std::size_t m_EmptyChunkCount = 0;
+		//! 1チャンクに格納できるエンティティ数。
+		std::uint32_t m_RowsPerChunk = 0;
+		//! 格納しているエンティティ数。
+		std::size_t m_RowCount = 0;
+		//! 全チャンクに格納できるエンティティ数。
+		std::size_t m_RowCapacity = 0;
+		//! 1行のサイズ[byte]。Entityの分を含む。
+		std::size_t m_RowSize = 0;
+		//! 確保しているメモリ量[byte]。
+		std::size_t m_AllocatedBytes = 0;
+		//! エンティティが使っているメモリ量[byte]。
+		std::size_t m_UsedBytes = 0;
+		//! 行に満たずに余るチャンク末尾のメモリ量[byte]。
+		std::size_t m_PaddingBytes = 0;
+		//! 空いている行のメモリ量[byte]。
+		std::size_t m_EmptyRowBytes = 0;
+		//! 詰め直した場合に解放できるチャンクの数。
+		std::size_t m_ReclaimableChunkCount = 0;
+		//! 圧縮しているチャンクの数。
+		std::size_t m_CompressedChunkCount = 0;
+		//! 圧縮したチャンクが使っているメモリ量[byte]。m_AllocatedBytesに含む。
+		std::size_t m_CompressedBytes = 0;
+		//! 確保量の多い順に並べた列。最大でMemoryReport::cLargestColumnCount個。
+		std::vector<ColumnMemoryInfo> m_LargestColumns;
+
+		/**
+		* @brief 充填率を取得します。
+		* @return float 格納しているエンティティ数を、チャンクに格納できるエンティティ数で割った値。
+		*/
+		float GetFillRatio() const noexcept
+		{
+			return m_RowCapacity > 0 ? static_cast<float>(m_RowCount) / static_cast<float>(m_RowCapacity) : 0.0f;
+		}
+	};
+
+	/**
+	* @class MemoryReport
+	* @brief ワールドのメモリの使用状況を集計するクラス。
+	* @note チャンクサイズの調整や、詰め直しを行う時期の判断に使う。
+	*		 集計はワールドを変更しない時点で行うこと。
+	*/
+	class MemoryReport
+	{
+	public:
+		//! アーキタイプごとに記録する、確保量の多い列の数。
+		static constexpr std::size_t cLargestColumnCount = 3;
+
+		/**
+		* @brief ワールドのメモリの使用状況を集計します。
+		* @param _world 集計するワールド。
+		* @return MemoryReport 集計結果。
+		*/
+		static MemoryReport Create(const World& _world);
+
+		/**
+		* @brief 集計結果を文字列で書き出します。
+		* @param _stream 書き出し先。
+		*/
+		void Dump(std::ostream& _stream) const;
+
+		/**
+		* @brief アーキタイプごとの集計結果を取得します。
+		* @return const std::vector<ArchetypeMemoryInfo>& 集計結果。チャンクを持つアーキタイプのみ。
+		*/
+		const std::vector<ArchetypeMemoryInfo>& GetArchetypes() const noexcept
+		{
+			return m_Archetypes;
+		}
+
+		/**
+		* @brief 全アーキタイプの合計を取得します。
+		* @return const ArchetypeMemoryInfo& 合計。行のサイズや列の内訳など、アーキタイプごとの値は持たない。
+		*/
+		const ArchetypeMemoryInfo& GetTotal() const noexcept
+		{
+			return m_Total;
+		}
+
+		/**
+		* @brief エンティティの管理情報の数を取得します。
+		* @return std::size_t 管理情報の数。破棄済みで再利用待ちのものを含む。
+		*/
+		std::size_t GetEntityDirectoryCount() const noexcept
+		{
+			return m_EntityDirectoryCount;
+		}
+
+		/**
+		* @brief エンティティの管理情報が確保しているメモリ量を取得します。
+		* @return std::size_t メモリ量[byte]。
+		*/
+		std::size_t GetEntityDirectoryBytes() const noexcept
+		{
+			return m_EntityDirectoryBytes;
+		}
+
+		/**
+		* @brief 再利用可能なエンティティインデックスの数を取得します。
+		* @return std::size_t 再利用可能なインデックスの数。
+		*/
+		std::size_t GetFreeListLength() const noexcept
+		{
+			return m_FreeListLength;
+		}
+
+		/**
+		* @brief 疎な集合が確保しているメモリ量を取得します。
+		* @return std::size_t メモリ量[byte]。
+		*/
+		std::size_t GetSparseSetBytes() const noexcept
+		{
+			return m_SparseSetBytes;
+		}
+
+	private:
+		//! アーキタイプごとの集計結果。
+		std::vector<ArchetypeMemoryInfo> m_Archetypes;
+		//! 全アーキタイプの合計。
+		ArchetypeMemoryInfo m_Total;
+		//! エンティティの管理情報の数。
+		std::size_t m_EntityDirectoryCount = 0;
+		//! エンティティの管理情報が確保しているメモリ量[byte]。
+		std::size_t m_EntityDirectoryBytes = 0;
+		//! 再利用可能なエンティティインデックスの数。
+		std::size_t m_FreeListLength = 0;
+		//! 疎な集合が確保しているメモリ量[byte]。
+		std::size_t m_SparseSetBytes = 0;
+	};
+}
@@ -0,0 +1,112 @@
+#include "RenderState.h"
+
+#include <cstring>
+
+#include "Chunk.h"
+
+#include "../../AsyncFunctionManager.h"
+
+namespace ECS
+{
+	void RenderState::Extract(const ChunkList& _chunkList, const Archetype& _renderArchetype,
+		const std::uint64_t _stateEpoch, AsyncFunctionManager& _asyncManager)
+	{
+		// これ以降の書き込みは次回の抽出で拾えるように、変更バージョンを進めておく
+		const ChangeVersion version = GlobalChangeVersion::Advance();
+
+		// 描画用コンポーネントが増えた場合は抽出する列が変わり、
+		// チャンクが丸ごと置き換わった場合は同じインデックスでも別のチャンクなので、全て作り直す
+		if (m_RenderTypeCount != _renderArchetype.GetArchetypeSize() || m_StateEpoch != _stateEpoch)
+		{
+			m_Chunks.clear();
+			m_RenderTypeCount = _renderArchetype.GetArchetypeSize();
+			m_StateEpoch = _stateEpoch;
+		}
+		m_Chunks.resize(_chunkList.size());
+
+		//=== 複製が必要なチャンクを集める
+		std::vector<std::uint32_t>& dirtyChunks = m_DirtyChunks;
+		dirtyChunks.clear();
+		for (std::uint32_t i = 0; i < _chunkList.size(); i++)
+		{
+			ExtractedChunk& extracted = m_Chunks[i];
+			const Chunk& chunk = _chunkList[i];
+			// 圧縮中のチャンクは、前回の抽出から触れられていなければ抽出済みの内容のままなので展開しない
+			if (chunk.IsCompressed() && extracted.m_pSource && extracted.m_pArchetype == &chunk.GetArchetype()
+				&& chunk.GetLastTouchedVersion() <= m_Version)
+				continue;
+			if (extracted.m_pSource != chunk.GetBuffer() || extracted.m_pArchetype != &chunk.GetArchetype())
+				Rebuild(extracted, chunk, _renderArchetype);
+			if (extracted.m_Columns.empty())
+				continue;
+
+			bool bChanged = chunk.GetStructureVersion() > extracted.m_Version;
+			for (auto&& column : extracted.m_Columns)
+				bChanged = bChanged || chunk.GetColumnVersion(column.m_ColumnIndex) > extracted.m_Version;
+			if (bChanged)
+				dirtyChunks.push_back(i);
+		}
+
+		//=== チャンク単位で並列に複製する
+		_asyncManager.ParallelFor(dirtyChunks.size(), 1, [this, &_chunkList, &dirtyChunks](std::size_t _index) {
+				ExtractedChunk* pExtracted = &m_Chunks[dirtyChunks[_index]];
+				const Chunk* pChunk = &_chunkList[dirtyChunks[_index]];
+				const std::uint32_t size = pChunk->GetSize();
+				const bool bStructureChanged = pChunk->GetStructureVersion() > pExtracted->m_Version;
+
+				if (bStructureChanged)
+					std::memcpy(pExtracted->m_pBuffer.get(), pChunk->GetBuffer(), sizeof(Entity) * size);
+				for (auto&& column : pExtracted->m_Columns)
+				{
+					if (!bStructureChanged && pChunk->GetColumnVersion(column.m_ColumnIndex) <= pExtracted->m_Version)
+						continue;
+					std::memcpy(pExtracted->m_pBuffer.get() + column.m_Offset,
+						pChunk->GetBuffer() + column.m_Offset, column.m_ElementSize * size);
+				}
+				pExtracted->m_Size = size;
+			});
+
+		for (auto&& chunkIndex : dirtyChunks)
+			m_Chunks[chunkIndex].m_Version = version;
+		m_Version = version;
+	}
+
+	void RenderState::Rebuild(ExtractedChunk& _extracted, const Chunk& _chunk, const Archetype& _renderArchetype)
+	{
+		_extracted = ExtractedChunk();
+		_extracted.m_pSource = _chunk.GetBuffer();
+		_extracted.m_pArchetype = &_chunk.GetArchetype();
+
+		// 両方とも型IDの昇順に並んでいるので、先頭から照合して描画用コンポーネントの列だけを拾う
+		const Archetype& archetype = _chunk.GetArchetype();
+		const std::uint32_t maxSize = Chunk::CalculateMaxSize(archetype);
+		std::size_t index = 0;
+		std::size_t renderIndex = 0;
+		while (index < archetype.GetArchetypeSize() && renderIndex < _renderArchetype.GetArchetypeSize())
+		{
+			const TypeId id = archetype.GetComponentIdByIndex(index);
+			const TypeId renderId = _renderArchetype.GetComponentIdByIndex(renderIndex);
+			if (id == renderId)
+			{
+				_extracted.m_Columns.push_back(ExtractedColumn{
+					id,
+					static_cast<std::uint32_t>(index + 1),
+					Chunk::CalculateColumnOffset(archetype.GetMemroyOffsetByIndex(index), maxSize),
+					archetype.GetMemorySizeByIndex(index) });
+				index++;
+				renderIndex++;
+			}
+			else if (id < renderId)
+			{
+				index++;
+			}
+			else
+			{
+				renderIndex++;
+			}
+		}
+
+		if (!_extracted.m_Columns.empty())
+			_extracted.m_pBuffer = Chunk::AllocateBuffer();
+	}
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "Entity.h"
+#include "Archetype.h"
+#include "Chunk.h"
+#include "Common/ChangeVersion.h"
+#include "Utilities/TypeInfo.h"
+
+class AsyncFunctionManager;
+
+namespace ECS
+{
+	/**
+	* @class RenderState
+	* @brief 描画用に抽出したコンポーネントの読み取り専用の複製。
+	* @note World::Updateの最後に、登録された描画用コンポーネントの列だけをチャンク単位で複製する。
+	*		 描画はこの複製を読むので、次のUpdateと並行して実行できる。
+	*		 チャンク内のオフセットはそのまま使うので、列の位置はワールドのチャンクと同じ。
+	*/
+	class RenderState
+	{
+	public:
+		/**
+		* @brief 抽出したコンポーネントを持つ全てのエンティティに関数を実行します。
+		* @tparam CompTs 読み取るコンポーネントの型。
+		* @param _func 実行する関数。(const Entity&, const CompTs&...)を受け取る。
+		*/
+		template <class... CompTs, typename Func>
+		void ForEach(Func&& _func) const
+		{
+			for (auto&& chunk : m_Chunks)
+			{
+				if (chunk.m_Size == 0)
+					continue;
+
+				const std::byte* pColumns[] = { chunk.FindColumn(TypeManager::TypeInfo<CompTs>::GetID())..., nullptr };
+				bool bHasAll = true;
+				for (std::size_t i = 0; i < sizeof...(CompTs); i++)
+					bHasAll = bHasAll && pColumns[i];
+				if (!bHasAll)
+					continue;
+
+				const Entity* pEntities = reinterpret_cast<const Entity*>(chunk.m_pBuffer.get());
+				for (std::uint32_t row = 0; row < chunk.m_Size; row++)
+				{
+					InvokeRow<CompTs...>(_func, pEntities[row], pColumns, row, std::index_sequence_for<CompTs...>{});
+				}
+			}
+		}
+
+		/**
+		* @brief 抽出した時点の変更バージョンを取得します。
+		* @return ChangeVersion 変更バージョン。これ以前の書き込みは全て反映されている。
+		*/
+		ChangeVersion GetVersion() const noexcept
+		{
+			return m_Version;
+		}
+
+		/**
+		* @brief ワールドのチャンクから描画用コンポーネントの列を抽出します。
+		* @param _chunkList ワールドのチャンクリスト。
+		* @param _renderArchetype 抽出するコンポーネントを並べたアーキタイプ。
+		* @param _stateEpoch ワールドのWorld::m_StateEpoch。
+		* @param _asyncManager チャンク単位の複製を並列に実行するマネージャ。
+		* @note 前回抽出した後に書き込まれた列だけを複製する。
+		*		 _stateEpochが変わった場合は、チャンクが丸ごと置き換わっているので全て作り直す。
+		*/
+		void Extract(const ChunkList& _chunkList, const Archetype& _renderArchetype,
+			const std::uint64_t _stateEpoch, AsyncFunctionManager& _asyncManager);
+
+	private:
+		/**
+		* @brief 1行分のコンポーネントを取り出して関数を実行します。
+		*/
+		template <class... CompTs, typename Func, std::size_t... Indices>
+		static inline void InvokeRow(Func& _func, const Entity& _entity,
+			const std::byte* const* _pColumns, const std::uint32_t _row, std::index_sequence<Indices...>)
+		{
+			_func(_entity, reinterpret_cast<const CompTs*>(_pColumns[Indices])[_row]...);
+		}
+
+		/**
+		* @struct ExtractedColumn
+		* @brief 抽出する1列の情報。
+		*/
+		struct ExtractedColumn
+		{
+			//! コンポーネントの型ID。
+			TypeId m_Id;
+			//! チャンク内での列のインデックス。0はEntityの列。
+			std::uint32_t m_ColumnIndex;
+			//! チャンクの先頭から列までのオフセット。
+			std::size_t m_Offset;
+			//! 1要素のサイズ[byte]。
+			std::size_t m_ElementSize;
+		};
+
+		/**
+		* @struct ExtractedChunk
+		* @brief 1チャンク分の抽出結果。ワールドのチャンクと同じインデックスに置く。
+		*/
+		struct ExtractedChunk
+		{
+			/**
+			* @brief 指定された型の列の先頭を取得する。
+			* @return const std::byte* 列の先頭。抽出していない型の場合はnullptr。
+			*/
+			const std::byte* FindColumn(const TypeId _id) const noexcept
+			{
+				for (auto&& column : m_Columns)
+				{
+					if (column.m_Id == _id)
+						return m_pBuffer.get() + column.m_Offset;
+				}
+				return nullptr;
+			}
+
+			//! 抽出元のチャンクのメモリ領域。変わった場合は作り直す。
+			const std::byte* m_pSource = nullptr;
+			//! 抽出元のチャンクのアーキタイプ。ArchetypeTable::Intern()の実体を指すので、変わった場合は作り直す。
+			const Archetype* m_pArchetype = nullptr;
+			//! 抽出する列。Entityの列を除く。空なら抽出対象外のチャンク。
+			std::vector<ExtractedColumn> m_Columns;
+			//! 抽出先のメモリ領域。列を型として読むので、チャンクと同じ境界で確保する。
+			std::shared_ptr<std::byte[]> m_pBuffer;
+			//! 抽出したエンティティ数。
+			std::uint32_t m_Size = 0;
+			//! 最後に抽出した時点の変更バージョン。
+			ChangeVersion m_Version = 0;
+		};
+
+		/**
+		* @brief 抽出先のチャンクをワールドのチャンクに合わせて作り直します。
+		* @param _extracted 抽出先。
+		* @param _chunk 抽出元のチャンク。
+		* @param _renderArchetype 抽出するコンポーネントを並べたアーキタイプ。
+		*/
+		static void Rebuild(ExtractedChunk& _extracted, const Chunk& _chunk, const Archetype& _renderArchetype);
+
+	private:
+		//! チャンクごとの抽出結果。
+		std::vector<ExtractedChunk> m_Chunks;
+		//! 複製が必要なチャンクのインデックス。毎回の確保を避けるために使い回す。
+		std::vector<std::uint32_t> m_DirtyChunks;
+		//! 前回抽出したときの描画用コンポーネントの数。変わった場合は全て作り直す。
+		std::size_t m_RenderTypeCount = 0;
+		//! 前回抽出したときのワールドのWorld::m_StateEpoch。変わった場合は全て作り直す。
+		std::uint64_t m_StateEpoch = 0;
+		//! 抽出した時点の変更バージョン。
+		ChangeVersion m_Version = 0;
+	};
+}
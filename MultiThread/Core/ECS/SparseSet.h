@@ -0,0 +1,431 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <type_traits>
+
+#include "Entity.h"
+#include "IComponentData.h"
+#include "Common/Id.h"
+#include "Utilities/TypeInfo.h"
+
+namespace ECS
+{
+	/**
+	* @class SparseSetBase
+	* @brief 型を問わずに疎な集合を操作するための基底クラス。
+	* @note エンティティの破棄や複製のように、型の分からない全ての集合に同じ操作をするときに使う。
+	*		 クエリが集合を読んでいる間(BeginQueryからEndQueryまで)の追加と削除は保留し、
+	*		 最後のクエリが終わるときにまとめて適用する。クエリはロックを取らずに集合を読める。
+	*/
+	class SparseSetBase
+	{
+	public:
+		virtual ~SparseSetBase() = default;
+
+		/**
+		* @brief エンティティのコンポーネントを取り除きます。
+		* @param _entityIndex エンティティのインデックス。
+		* @return bool 取り除いた場合はtrue。持っていなかった場合と、クエリの実行中で保留した場合はfalse。
+		*/
+		virtual bool Remove(const EntityIndex _entityIndex) = 0;
+
+		/**
+		* @brief エンティティのコンポーネントを別のエンティティに複製します。
+		* @param _sourceIndex 複製元のエンティティのインデックス。
+		* @param _pDestinations 複製先のエンティティ。
+		* @param _count 複製先の数。
+		* @note クエリの実行中は、複製元の値を取っておいて複製を保留する。
+		*/
+		virtual void CopyTo(const EntityIndex _sourceIndex, const Entity* _pDestinations, const std::size_t _count) = 0;
+
+		/**
+		* @brief 全てのコンポーネントを取り除きます。
+		*/
+		virtual void Clear() = 0;
+
+		/**
+		* @brief 確保しているメモリ量を取得します。
+		* @return std::size_t メモリ量[byte]。
+		*/
+		virtual std::size_t GetMemorySize() const noexcept = 0;
+
+		/**
+		* @brief 同じ型の空の集合を作成します。
+		* @return std::unique_ptr<SparseSetBase> 作成した集合。
+		*/
+		virtual std::unique_ptr<SparseSetBase> CreateEmpty() const = 0;
+
+		/**
+		* @brief 同じ内容の集合を作成します。
+		* @return std::unique_ptr<SparseSetBase> 作成した集合。
+		*/
+		virtual std::unique_ptr<SparseSetBase> Clone() const = 0;
+
+		/**
+		* @brief 同じ型の別の集合と同じ内容にします。
+		* @param _other 複製元の集合。同じ型である必要がある。
+		* @note 確保済みのページと配列は使い回すので、同じ程度の大きさの集合同士であれば確保は起きない。
+		*/
+		virtual void CopyFrom(const SparseSetBase& _other) = 0;
+
+		/**
+		* @brief エンティティのコンポーネントを、同じ型の別の集合の別のエンティティに複製します。
+		* @param _sourceIndex 複製元のエンティティのインデックス。
+		* @param _destination 複製先の集合。CreateEmptyで作った同じ型の集合である必要がある。
+		* @param _destinationEntity 複製先のエンティティ。
+		*/
+		virtual void CopyEntryTo(const EntityIndex _sourceIndex, SparseSetBase& _destination,
+			const Entity& _destinationEntity) const = 0;
+
+		/**
+		* @brief 格納しているコンポーネントの数を取得します。
+		* @return std::size_t コンポーネントの数。
+		*/
+		std::size_t GetSize() const noexcept
+		{
+			return m_Entities.size();
+		}
+
+		/**
+		* @brief 格納しているコンポーネントを持つエンティティを取得します。
+		* @return const std::vector<Entity>& エンティティ。コンポーネントと同じ順に並ぶ。
+		*/
+		const std::vector<Entity>& GetEntities() const noexcept
+		{
+			return m_Entities;
+		}
+
+		/**
+		* @brief エンティティがコンポーネントを持つかどうかを判定します。
+		* @param _entity 判定するエンティティ。バージョンが一致しない場合は持たない扱い。
+		* @return bool 持つ場合はtrue。
+		*/
+		bool Contains(const Entity& _entity) const noexcept
+		{
+			const std::uint32_t denseIndex = FindDenseIndex(GetIndex(_entity.m_Identifier));
+			return denseIndex != cInvalidIndex && m_Entities[denseIndex].m_Identifier == _entity.m_Identifier;
+		}
+
+		/**
+		* @brief 集合を読むクエリを始めます。EndQueryを呼ぶまで、追加と削除は保留する。
+		* @note 入れ子にしてよい。保留した変更は、最後のEndQueryで適用する。
+		*/
+		void BeginQuery()
+		{
+			std::lock_guard<std::mutex> lock(m_ChangeMutex);
+			m_QueryCount++;
+		}
+
+		/**
+		* @brief 集合を読むクエリを終えます。最後のクエリであれば、保留した追加と削除を適用する。
+		*/
+		void EndQuery()
+		{
+			std::lock_guard<std::mutex> lock(m_ChangeMutex);
+			if (--m_QueryCount == 0)
+				ApplyPendingChanges();
+		}
+
+	protected:
+		/**
+		* @brief 保留した追加と削除を、保留した順に適用します。m_ChangeMutexを取った状態で呼ぶ。
+		*/
+		virtual void ApplyPendingChanges() = 0;
+
+		//! 疎な配列で、コンポーネントを持たないことを表す値。
+		static constexpr std::uint32_t cInvalidIndex = std::uint32_t(-1);
+		//! 疎な配列の1ページの要素数。
+		static constexpr std::uint32_t cPageSize = 1024;
+
+		/**
+		* @brief エンティティのインデックスから密な配列の位置を取得します。
+		* @param _entityIndex エンティティのインデックス。
+		* @return std::uint32_t 密な配列の位置。持たない場合はcInvalidIndex。
+		*/
+		std::uint32_t FindDenseIndex(const EntityIndex _entityIndex) const noexcept
+		{
+			const std::size_t pageIndex = _entityIndex / cPageSize;
+			if (pageIndex >= m_Pages.size() || !m_Pages[pageIndex])
+				return cInvalidIndex;
+			return m_Pages[pageIndex][_entityIndex % cPageSize];
+		}
+
+		/**
+		* @brief エンティティのインデックスに対応する疎な配列の要素を取得します。ページがなければ作る。
+		* @param _entityIndex エンティティのインデックス。
+		* @return std::uint32_t& 密な配列の位置を格納する要素。
+		*/
+		std::uint32_t& GetOrCreateSlot(const EntityIndex _entityIndex)
+		{
+			const std::size_t pageIndex = _entityIndex / cPageSize;
+			if (pageIndex >= m_Pages.size())
+				m_Pages.resize(pageIndex + 1);
+			if (!m_Pages[pageIndex])
+			{
+				m_Pages[pageIndex] = std::make_unique<std::uint32_t[]>(cPageSize);
+				std::fill_n(m_Pages[pageIndex].get(), cPageSize, cInvalidIndex);
+			}
+			return m_Pages[pageIndex][_entityIndex % cPageSize];
+		}
+
+		/**
+		* @brief 別の集合のエンティティと、エンティティから位置を引くページを複製します。
+		* @param _other 複製元の集合。
+		* @note 確保済みのページは使い回す。複製元にないページは、確保したまま空にする。
+		*/
+		void CopyIndexFrom(const SparseSetBase& _other)
+		{
+			if (m_Pages.size() < _other.m_Pages.size())
+				m_Pages.resize(_other.m_Pages.size());
+			for (std::size_t i = 0; i < m_Pages.size(); i++)
+			{
+				if (i >= _other.m_Pages.size() || !_other.m_Pages[i])
+				{
+					if (m_Pages[i])
+						std::fill_n(m_Pages[i].get(), cPageSize, cInvalidIndex);
+					continue;
+				}
+				if (!m_Pages[i])
+					m_Pages[i] = std::make_unique<std::uint32_t[]>(cPageSize);
+				std::copy_n(_other.m_Pages[i].get(), cPageSize, m_Pages[i].get());
+			}
+			m_Entities = _other.m_Entities;
+		}
+
+	protected:
+		//! エンティティのインデックスから密な配列の位置を引くページ。使われた範囲だけ確保する。
+		std::vector<std::unique_ptr<std::uint32_t[]>> m_Pages;
+		//! コンポーネントを持つエンティティ。コンポーネントと同じ順に詰めて並べる。
+		std::vector<Entity> m_Entities;
+		//! 追加と削除、クエリの数、保留した変更を守るロック。
+		std::mutex m_ChangeMutex;
+		//! 集合を読んでいるクエリの数。0でない間の追加と削除は保留する。
+		std::uint32_t m_QueryCount = 0;
+	};
+
+	/**
+	* @class SparseSet
+	* @brief エンティティのインデックスで引く、1つの型のコンポーネントの疎な集合。
+	* @tparam CompT 格納するコンポーネントの型。
+	* @note コンポーネントは密な配列に詰めて並べ、削除は末尾の要素で埋める。
+	*		 追加、削除、検索はいずれも定数時間で、他のコンポーネントは動かさない。
+	*/
+	template <SparseComponent CompT>
+	class SparseSet final : public SparseSetBase
+	{
+	public:
+		/**
+		* @brief エンティティにコンポーネントを設定します。持っていない場合は追加する。
+		* @param _entity 対象のエンティティ。
+		* @param _args コンポーネントの構築に使う引数。
+		* @return CompT& 設定したコンポーネント。
+		*/
+		template <typename... Args>
+		CompT& Emplace(const Entity& _entity, Args&&... _args)
+		{
+			std::uint32_t& slot = GetOrCreateSlot(GetIndex(_entity.m_Identifier));
+			if (slot != cInvalidIndex)
+			{
+				// 破棄済みのエンティティの残りであれば上書きする
+				m_Entities[slot] = _entity;
+				m_Components[slot] = CompT(std::forward<Args>(_args)...);
+				return m_Components[slot];
+			}
+
+			slot = static_cast<std::uint32_t>(m_Entities.size());
+			m_Entities.push_back(_entity);
+			m_Components.emplace_back(std::forward<Args>(_args)...);
+			return m_Components.back();
+		}
+
+		/**
+		* @brief エンティティがコンポーネントを持っていない場合だけ、既定値で追加します。
+		* @param _entity 対象のエンティティ。
+		* @note クエリの実行中は保留し、適用する時点で持っていない場合に追加する。
+		*/
+		void Add(const Entity& _entity)
+		{
+			std::lock_guard<std::mutex> lock(m_ChangeMutex);
+			if (m_QueryCount > 0)
+			{
+				m_PendingChanges.push_back(PendingChange{ _entity, false, std::nullopt });
+				return;
+			}
+			if (!Contains(_entity))
+				Emplace(_entity);
+		}
+
+		/**
+		* @brief エンティティのコンポーネントを取得します。
+		* @param _entity 対象のエンティティ。
+		* @return CompT* コンポーネント。持っていない場合はnullptr。
+		*/
+		CompT* Find(const Entity& _entity) noexcept
+		{
+			const std::uint32_t denseIndex = FindDenseIndex(GetIndex(_entity.m_Identifier));
+			if (denseIndex == cInvalidIndex || m_Entities[denseIndex].m_Identifier != _entity.m_Identifier)
+				return nullptr;
+			return &m_Components[denseIndex];
+		}
+
+		/**
+		* @brief エンティティのコンポーネントを取得します。
+		* @param _entity 対象のエンティティ。
+		* @return const CompT* コンポーネント。持っていない場合はnullptr。
+		*/
+		const CompT* Find(const Entity& _entity) const noexcept
+		{
+			return const_cast<SparseSet*>(this)->Find(_entity);
+		}
+
+		/**
+		* @brief 格納しているコンポーネントを取得します。
+		* @return std::vector<CompT>& コンポーネント。GetEntities()と同じ順に並ぶ。
+		*/
+		std::vector<CompT>& GetComponents() noexcept
+		{
+			return m_Components;
+		}
+
+		bool Remove(const EntityIndex _entityIndex) override
+		{
+			std::lock_guard<std::mutex> lock(m_ChangeMutex);
+			if (m_QueryCount > 0)
+			{
+				m_PendingChanges.push_back(PendingChange{ Entity(_entityIndex, 0), true, std::nullopt });
+				return false;
+			}
+			return RemoveNow(_entityIndex);
+		}
+
+		void CopyTo(const EntityIndex _sourceIndex, const Entity* _pDestinations, const std::size_t _count) override
+		{
+			std::lock_guard<std::mutex> lock(m_ChangeMutex);
+			const std::uint32_t denseIndex = FindDenseIndex(_sourceIndex);
+			if (denseIndex == cInvalidIndex)
+				return;
+
+			// 追加で配列が伸びても参照が切れないように、値で取っておく
+			const CompT source = m_Components[denseIndex];
+			if (m_QueryCount > 0)
+			{
+				for (std::size_t i = 0; i < _count; i++)
+					m_PendingChanges.push_back(PendingChange{ _pDestinations[i], false, source });
+				return;
+			}
+			m_Entities.reserve(m_Entities.size() + _count);
+			m_Components.reserve(m_Components.size() + _count);
+			for (std::size_t i = 0; i < _count; i++)
+				Emplace(_pDestinations[i], source);
+		}
+
+		void Clear() override
+		{
+			m_Pages.clear();
+			m_Entities.clear();
+			m_Components.clear();
+		}
+
+		std::unique_ptr<SparseSetBase> CreateEmpty() const override
+		{
+			return std::make_unique<SparseSet>();
+		}
+
+		std::unique_ptr<SparseSetBase> Clone() const override
+		{
+			auto pClone = std::make_unique<SparseSet>();
+			pClone->CopyIndexFrom(*this);
+			pClone->m_Components = m_Components;
+			return pClone;
+		}
+
+		void CopyFrom(const SparseSetBase& _other) override
+		{
+			CopyIndexFrom(_other);
+			m_Components = static_cast<const SparseSet&>(_other).m_Components;
+		}
+
+		void CopyEntryTo(const EntityIndex _sourceIndex, SparseSetBase& _destination,
+			const Entity& _destinationEntity) const override
+		{
+			const std::uint32_t denseIndex = FindDenseIndex(_sourceIndex);
+			if (denseIndex == cInvalidIndex)
+				return;
+			static_cast<SparseSet&>(_destination).Emplace(_destinationEntity, m_Components[denseIndex]);
+		}
+
+		std::size_t GetMemorySize() const noexcept override
+		{
+			const std::size_t pageCount = std::count_if(m_Pages.begin(), m_Pages.end(),
+				[](const auto& _pPage) { return _pPage != nullptr; });
+			return m_Pages.capacity() * sizeof(m_Pages[0]) + pageCount * cPageSize * sizeof(std::uint32_t) +
+				m_Entities.capacity() * sizeof(Entity) + m_Components.capacity() * sizeof(CompT);
+		}
+
+	protected:
+		void ApplyPendingChanges() override
+		{
+			for (auto&& change : m_PendingChanges)
+			{
+				if (change.m_bRemove)
+					RemoveNow(GetIndex(change.m_Entity.m_Identifier));
+				else if (change.m_Value)
+					Emplace(change.m_Entity, *change.m_Value);
+				else if (!Contains(change.m_Entity))
+					Emplace(change.m_Entity);
+			}
+			m_PendingChanges.clear();
+		}
+
+	private:
+		/**
+		* @struct PendingChange
+		* @brief クエリの実行中に保留した追加、または削除。
+		*/
+		struct PendingChange
+		{
+			//! 対象のエンティティ。削除ではインデックスだけを使う。
+			Entity m_Entity;
+			//! 削除かどうか。
+			bool m_bRemove;
+			//! 設定する値。ない場合は、持っていなければ既定値で追加する。
+			std::optional<CompT> m_Value;
+		};
+
+		/**
+		* @brief エンティティのコンポーネントをすぐに取り除きます。
+		* @param _entityIndex エンティティのインデックス。
+		* @return bool 取り除いた場合はtrue。持っていなかった場合はfalse。
+		*/
+		bool RemoveNow(const EntityIndex _entityIndex)
+		{
+			const std::uint32_t denseIndex = FindDenseIndex(_entityIndex);
+			if (denseIndex == cInvalidIndex)
+				return false;
+
+			// 末尾の要素で穴を埋める
+			const std::uint32_t lastIndex = static_cast<std::uint32_t>(m_Entities.size() - 1);
+			if (denseIndex != lastIndex)
+			{
+				m_Entities[denseIndex] = m_Entities[lastIndex];
+				m_Components[denseIndex] = std::move(m_Components[lastIndex]);
+				GetOrCreateSlot(GetIndex(m_Entities[denseIndex].m_Identifier)) = denseIndex;
+			}
+			m_Entities.pop_back();
+			m_Components.pop_back();
+			GetOrCreateSlot(_entityIndex) = cInvalidIndex;
+			return true;
+		}
+
+		//! クエリの実行中に保留した追加と削除。保留した順に並べる。
+		std::vector<PendingChange> m_PendingChanges;
+		//! コンポーネント。m_Entitiesと同じ順に詰めて並べる。
+		std::vector<CompT> m_Components;
+	};
+}
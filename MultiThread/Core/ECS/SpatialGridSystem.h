@@ -0,0 +1,280 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "SystemBase.h"
+#include "Transform.h"
+
+namespace ECS
+{
+	/**
+	* @class SpatialGridSystem
+	* @brief LocalToWorldの位置から一様なハッシュグリッドを毎フレーム構築し、範囲検索を提供するシステム。
+	* @note 構築はチャンク単位で並列に行う。セルごとの数を数えて位置を決め、
+	*		 バケット順に詰めた配列にするので、検索はバケットの連続領域を読むだけになる。
+	*		 検索はconstで、構築中でなければ他のシステムのジョブから同時に呼び出せる。
+	*		 TransformSystemより後に更新されるように追加する。
+	*/
+	class SpatialGridSystem : public SystemBase
+	{
+	public:
+		/**
+		* @struct Entry
+		* @brief グリッドに登録された1エンティティ。
+		*/
+		struct Entry
+		{
+			//! エンティティ。
+			Entity m_Entity = Entity(0);
+			//! 構築時のワールド座標。
+			float m_Position[3];
+			//! 属するセルの座標。
+			std::int32_t m_Cell[3];
+		};
+
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _pWorld ワールドポインタ。
+		* @param _Id 一意のID。
+		*/
+		SpatialGridSystem(World* _pWorld, std::size_t _Id)
+			: SystemBase(_pWorld, _Id)
+		{}
+
+		/**
+		* @brief 初期化処理をします。
+		*/
+		void Init() override
+		{
+			m_Archetype.AddType<LocalToWorld>();
+		}
+
+		/**
+		* @brief セルの一辺の長さを設定します。次の更新から反映される。
+		* @param _cellSize セルの一辺の長さ。検索半径と同程度にすると効率がよい。
+		*/
+		void SetCellSize(const float _cellSize) noexcept
+		{
+			m_CellSize = _cellSize;
+		}
+
+		/**
+		* @brief 更新処理をします。グリッドを構築し直す。
+		*/
+		void Update(float _deltaTime, std::shared_ptr<AsyncFunctionManager> _pAsyncManager) override
+		{
+			m_InvCellSize = 1.0f / m_CellSize;
+
+			//=== チャンクごとの書き込み位置を決める
+			std::vector<Chunk*> pChunkList;
+			std::vector<std::size_t> chunkOffsets;
+			std::size_t entryCount = 0;
+			for (auto&& pChunk : GetEntityManager()->GetContainChunkList(m_Archetype))
+			{
+				if (pChunk->GetSize() == 0)
+					continue;
+				pChunkList.push_back(pChunk);
+				chunkOffsets.push_back(entryCount);
+				entryCount += pChunk->GetSize();
+			}
+
+			// バケット数はエンティティ数の2倍以上の2のべき乗
+			std::size_t bucketCount = 64;
+			while (bucketCount < entryCount * 2)
+				bucketCount *= 2;
+			m_BucketMask = bucketCount - 1;
+
+			m_UnsortedEntries.resize(entryCount);
+			m_EntryBuckets.resize(entryCount);
+			m_Entries.resize(entryCount);
+			m_BucketStarts.assign(bucketCount + 1, 0);
+
+			//=== セルを求めて、バケットごとの数を数える
+			ExecuteForChunks(_pAsyncManager, pChunkList, [this, &chunkOffsets](std::size_t _chunkIndex, Chunk* _pChunk) {
+				auto worlds = _pChunk->GetComponentList<const LocalToWorld>();
+				const std::size_t offset = chunkOffsets[_chunkIndex];
+				for (std::uint32_t i = 0; i < _pChunk->GetSize(); i++)
+				{
+					Entry& entry = m_UnsortedEntries[offset + i];
+					entry.m_Entity = _pChunk->GetEntity(i);
+					for (int axis = 0; axis < 3; axis++)
+					{
+						entry.m_Position[axis] = worlds[i].m_Matrix.m[3][axis];
+						entry.m_Cell[axis] = ToCell(entry.m_Position[axis]);
+					}
+					const std::uint32_t bucket = GetBucket(entry.m_Cell[0], entry.m_Cell[1], entry.m_Cell[2]);
+					m_EntryBuckets[offset + i] = bucket;
+					std::atomic_ref<std::uint32_t>(m_BucketStarts[bucket + 1]).fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+
+			for (std::size_t i = 0; i < bucketCount; i++)
+				m_BucketStarts[i + 1] += m_BucketStarts[i];
+
+			//=== バケット順に詰める
+			m_BucketCursors.assign(m_BucketStarts.begin(), m_BucketStarts.end() - 1);
+			ExecuteForChunks(_pAsyncManager, pChunkList, [this, &chunkOffsets](std::size_t _chunkIndex, Chunk* _pChunk) {
+				const std::size_t offset = chunkOffsets[_chunkIndex];
+				for (std::uint32_t i = 0; i < _pChunk->GetSize(); i++)
+				{
+					const std::uint32_t position = std::atomic_ref<std::uint32_t>(
+						m_BucketCursors[m_EntryBuckets[offset + i]]).fetch_add(1, std::memory_order_relaxed);
+					m_Entries[position] = m_UnsortedEntries[offset + i];
+				}
+			});
+		}
+
+		/**
+		* @brief 軸平行な箱の中にいるエンティティに関数を実行します。
+		* @param _min 箱の最小座標。
+		* @param _max 箱の最大座標。
+		* @param _func 実行する関数。(const Entry&)を受け取る。
+		*/
+		template <typename Func>
+		void QueryAABB(const float (&_min)[3], const float (&_max)[3], Func&& _func) const
+		{
+			ForEachCandidate(_min, _max, [&](const Entry& _entry)
+				{
+					for (int axis = 0; axis < 3; axis++)
+					{
+						if (_entry.m_Position[axis] < _min[axis] || _max[axis] < _entry.m_Position[axis])
+							return;
+					}
+					_func(_entry);
+				});
+		}
+
+		/**
+		* @brief 球の中にいるエンティティに関数を実行します。
+		* @param _center 球の中心。
+		* @param _radius 球の半径。
+		* @param _func 実行する関数。(const Entry&)を受け取る。
+		*/
+		template <typename Func>
+		void QueryRadius(const float (&_center)[3], const float _radius, Func&& _func) const
+		{
+			const float min[3] = { _center[0] - _radius, _center[1] - _radius, _center[2] - _radius };
+			const float max[3] = { _center[0] + _radius, _center[1] + _radius, _center[2] + _radius };
+			const float radiusSq = _radius * _radius;
+			ForEachCandidate(min, max, [&](const Entry& _entry)
+				{
+					float distanceSq = 0.0f;
+					for (int axis = 0; axis < 3; axis++)
+					{
+						const float d = _entry.m_Position[axis] - _center[axis];
+						distanceSq += d * d;
+					}
+					if (distanceSq <= radiusSq)
+						_func(_entry);
+				});
+		}
+
+		/**
+		* @brief 登録されているエンティティの数を取得します。
+		* @return std::size_t エンティティの数。
+		*/
+		std::size_t GetEntryCount() const noexcept
+		{
+			return m_Entries.size();
+		}
+
+	private:
+		/**
+		* @brief チャンクごとに関数を並列に実行し、全て完了するまで待ちます。
+		*/
+		template <typename Func>
+		static void ExecuteForChunks(std::shared_ptr<AsyncFunctionManager> _pAsyncManager,
+			const std::vector<Chunk*>& _pChunkList, Func _func)
+		{
+			_pAsyncManager->ParallelFor(_pChunkList.size(), 1,
+				[&_pChunkList, &_func](std::size_t _index) { _func(_index, _pChunkList[_index]); });
+		}
+
+		/**
+		* @brief 箱と重なるセルに登録されたエンティティに関数を実行します。
+		* @note 箱が覆うセルの数がエンティティ数より多い場合は、全体を走査する。
+		*/
+		template <typename Func>
+		void ForEachCandidate(const float (&_min)[3], const float (&_max)[3], Func&& _func) const
+		{
+			if (m_Entries.empty())
+				return;
+
+			std::int32_t minCell[3], maxCell[3];
+			double cellCount = 1.0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				minCell[axis] = ToCell(_min[axis]);
+				maxCell[axis] = ToCell(_max[axis]);
+				cellCount *= double(maxCell[axis]) - double(minCell[axis]) + 1.0;
+			}
+
+			if (cellCount > double(m_Entries.size()))
+			{
+				for (auto&& entry : m_Entries)
+					_func(entry);
+				return;
+			}
+
+			for (std::int32_t z = minCell[2]; z <= maxCell[2]; z++)
+			{
+				for (std::int32_t y = minCell[1]; y <= maxCell[1]; y++)
+				{
+					for (std::int32_t x = minCell[0]; x <= maxCell[0]; x++)
+					{
+						const std::uint32_t bucket = GetBucket(x, y, z);
+						for (std::uint32_t i = m_BucketStarts[bucket]; i < m_BucketStarts[bucket + 1]; i++)
+						{
+							// 同じバケットに入った別のセルは除く
+							const Entry& entry = m_Entries[i];
+							if (entry.m_Cell[0] == x && entry.m_Cell[1] == y && entry.m_Cell[2] == z)
+								_func(entry);
+						}
+					}
+				}
+			}
+		}
+
+		/**
+		* @brief 座標からセルの座標を求めます。
+		*/
+		std::int32_t ToCell(const float _position) const noexcept
+		{
+			return static_cast<std::int32_t>(std::floor(_position * m_InvCellSize));
+		}
+
+		/**
+		* @brief セルの座標からバケットを求めます。
+		*/
+		std::uint32_t GetBucket(const std::int32_t _x, const std::int32_t _y, const std::int32_t _z) const noexcept
+		{
+			const std::uint64_t hash =
+				(std::uint64_t(std::uint32_t(_x)) * 73856093u) ^
+				(std::uint64_t(std::uint32_t(_y)) * 19349663u) ^
+				(std::uint64_t(std::uint32_t(_z)) * 83492791u);
+			return static_cast<std::uint32_t>(hash & m_BucketMask);
+		}
+
+	private:
+		//! セルの一辺の長さ。
+		float m_CellSize = 1.0f;
+		//! 構築時のセルの一辺の長さの逆数。
+		float m_InvCellSize = 1.0f;
+		//! バケット数-1。
+		std::size_t m_BucketMask = 0;
+		//! バケット順に詰めたエンティティ。
+		std::vector<Entry> m_Entries;
+		//! 各バケットの先頭位置。末尾に番兵を持つ。
+		std::vector<std::uint32_t> m_BucketStarts;
+		//! 構築用の、チャンク順のエンティティ。
+		std::vector<Entry> m_UnsortedEntries;
+		//! 構築用の、m_UnsortedEntriesの各要素のバケット。
+		std::vector<std::uint32_t> m_EntryBuckets;
+		//! 構築用の、各バケットの書き込み位置。
+		std::vector<std::uint32_t> m_BucketCursors;
+	};
+}
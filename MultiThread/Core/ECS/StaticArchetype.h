@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Entity.h"
+#include "Archetype.h"
+#include "Chunk.h"
+
+namespace ECS
+{
+	/**
+	* @struct StaticArchetype
+	* @brief コンポーネントの型リストが固定のアーキタイプ。
+	*		 チャンク内のレイアウトを全てコンパイル時に求める。
+	* @tparam CompTs アーキタイプに含まれるコンポーネントの型。
+	* @note 同じ構成の実行時アーキタイプを持つチャンクとレイアウトは一致する。
+	*/
+	template <typename... CompTs>
+	struct StaticArchetype
+	{
+		static_assert(sizeof...(CompTs) > 0, "StaticArchetype requires at least one component.");
+		static_assert((std::is_same_v<CompTs, std::remove_cvref_t<CompTs>> && ...),
+			"StaticArchetype components must not be cv or reference qualified.");
+		static_assert((!SparseComponent<CompTs> && ...),
+			"StaticArchetype components must be stored in chunks, not in sparse sets.");
+
+		//! 同じ構成の実行時アーキタイプ。
+		static constexpr Archetype cArchetype = Archetype::Create<CompTs...>();
+
+		static_assert(cArchetype.GetArchetypeSize() == sizeof...(CompTs),
+			"StaticArchetype components must be unique.");
+
+		//! 1チャンクに格納できるエンティティ数。
+		static constexpr std::uint32_t cMaxSize = Chunk::CalculateMaxSize(cArchetype);
+
+		//! チャンク内での型IDの並び順。
+		static constexpr std::array<TypeId, sizeof...(CompTs)> cComponentIds = []()
+			{
+				std::array<TypeId, sizeof...(CompTs)> result{};
+				for (std::size_t i = 0; i < result.size(); i++)
+					result[i] = cArchetype.GetComponentIdByIndex(i);
+				return result;
+			}();
+
+		//! チャンクの先頭から各コンポーネントの列までのオフセット。
+		template <typename CompT>
+		static constexpr std::size_t cColumnOffset =
+			Chunk::CalculateColumnOffset(cArchetype.GetMemoryOffset<CompT>(), cMaxSize);
+
+		//! 各コンポーネントの列のインデックス。0はEntityの列。
+		template <typename CompT>
+		static constexpr std::size_t cColumnIndex = cArchetype.GetComponentIndex<CompT>() + 1;
+
+		/**
+		* @brief チャンクが持つ指定コンポーネントの列の先頭を取得します。
+		* @tparam CompT 取得するコンポーネントの型。
+		* @param _chunk 対象のチャンク。アーキタイプがcArchetypeと一致している必要がある。
+		* @return CompT* 列の先頭。
+		* @note constでない型で取得した場合は、列を書き込み済みとして記録する。
+		*/
+		template <typename CompT>
+		static inline CompT* GetColumn(Chunk& _chunk) noexcept
+		{
+			if constexpr (!std::is_const_v<CompT>)
+				_chunk.MarkColumnChanged(cColumnIndex<CompT>);
+
+			return reinterpret_cast<CompT*>(_chunk.GetBuffer() + cColumnOffset<CompT>);
+		}
+
+		/**
+		* @brief 指定行にコンポーネントを直接構築します。
+		* @param _chunk 対象のチャンク。
+		* @param _chunkIndex 構築するチャンク内インデックス。
+		* @param _values 構築に使う値。
+		*/
+		template <typename... ValueTs>
+		static inline void Construct(Chunk& _chunk, const std::uint32_t _chunkIndex, ValueTs&&... _values)
+		{
+			static_assert((cArchetype.HasType<ValueTs>() && ...),
+				"StaticArchetype::Construct got a component that is not part of the archetype.");
+
+			std::byte* pBegin = _chunk.GetBuffer();
+			(new (pBegin + cColumnOffset<std::remove_cvref_t<ValueTs>>
+				+ sizeof(std::remove_cvref_t<ValueTs>) * _chunkIndex)
+				std::remove_cvref_t<ValueTs>(std::forward<ValueTs>(_values)), ...);
+		}
+
+		/**
+		* @brief チャンク内の全てのエンティティに関数を実行します。
+		* @param _chunk 対象のチャンク。
+		* @param _func 実行する関数。CompTsの順にコンポーネントの参照を受け取る。
+		*/
+		template <typename Func>
+		static inline void ForEach(Chunk& _chunk, Func&& _func)
+		{
+			ForEachImpl(_chunk.GetSize(), _func, GetColumn<CompTs>(_chunk)...);
+		}
+
+	private:
+		/**
+		* @brief ForEachの実装。
+		* @param _size チャンク内のエンティティ数。
+		* @param _func 実行する関数。
+		* @param _pColumns 各コンポーネントの列の先頭。
+		*/
+		template <typename Func>
+		static inline void ForEachImpl(const std::uint32_t _size, Func& _func, CompTs*... _pColumns)
+		{
+			for (std::uint32_t i = 0; i < _size; ++i)
+			{
+				_func(_pColumns[i]...);
+			}
+		}
+	};
+}
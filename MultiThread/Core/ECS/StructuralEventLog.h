@@ -0,0 +1,174 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+#include "Entity.h"
+#include "ArchetypeTable.h"
+
+namespace ECS
+{
+	/**
+	* @class StructuralEventLog
+	* @brief エンティティの作成、破棄、アーキタイプの移動を、移動元と移動先のアーキタイプの組ごとに記録するクラス。
+	* @note 記録は通し番号付きで組ごとの配列に追記するだけなので、構成を変える操作の負担は小さい。
+	*		 読む側は前回読んだ通し番号を持ち、それ以降の分だけを組単位で選んで読む。
+	*		 有効にするまでは何も記録しない。
+	*/
+	class StructuralEventLog
+	{
+	public:
+		//! 記録の通し番号の型。
+		using Sequence = std::uint64_t;
+
+		/**
+		* @struct Event
+		* @brief 1エンティティ分の記録。
+		*/
+		struct Event
+		{
+			//! 対象のエンティティ。破棄の場合は破棄する前のハンドル。
+			Entity m_Entity;
+			//! 記録の通し番号。
+			Sequence m_Sequence;
+		};
+
+		/**
+		* @struct Transition
+		* @brief 移動元と移動先のアーキタイプの組と、その組の記録。
+		*/
+		struct Transition
+		{
+			//! 移動元のアーキタイプのインデックス。作成の場合はcInvalidIndex。
+			ArchetypeTable::ArchetypeIndex m_From;
+			//! 移動先のアーキタイプのインデックス。破棄の場合はcInvalidIndex。
+			ArchetypeTable::ArchetypeIndex m_To;
+			//! 記録。通し番号の昇順に並ぶ。
+			std::vector<Event> m_Events;
+		};
+
+	public:
+		/**
+		* @brief 記録が有効かどうかを取得します。
+		* @return bool 有効な場合はtrue。
+		*/
+		bool IsEnabled() const noexcept
+		{
+			return m_bEnabled;
+		}
+
+		/**
+		* @brief 記録を有効にします。有効にする前の操作は記録されない。
+		*/
+		void Enable() noexcept
+		{
+			m_bEnabled = true;
+		}
+
+		/**
+		* @brief 次に記録する通し番号を取得します。
+		* @return Sequence 通し番号。これ未満の記録は全て記録済み。
+		*/
+		Sequence GetSequence() const noexcept
+		{
+			return m_NextSequence;
+		}
+
+		/**
+		* @brief エンティティの構成の変化を記録します。
+		* @param _from 移動元のアーキタイプのインデックス。作成の場合はcInvalidIndex。
+		* @param _to 移動先のアーキタイプのインデックス。破棄の場合はcInvalidIndex。
+		* @param _pEntities 対象のエンティティ。
+		* @param _count 対象の数。
+		*/
+		void Record(const ArchetypeTable::ArchetypeIndex _from, const ArchetypeTable::ArchetypeIndex _to,
+			const Entity* _pEntities, const std::size_t _count)
+		{
+			if (!m_bEnabled || _from == _to || _count == 0)
+				return;
+
+			// 同じ組が続くことが多いので、前回の組であれば表を引かない
+			Transition* pTransition = m_LastTransitionIndex < m_Transitions.size() ?
+				&m_Transitions[m_LastTransitionIndex] : nullptr;
+			if (!pTransition || pTransition->m_From != _from || pTransition->m_To != _to)
+			{
+				const std::uint64_t key = (std::uint64_t(_from) << 32) | _to;
+				auto result = m_TransitionIndices.emplace(key, static_cast<std::uint32_t>(m_Transitions.size()));
+				if (result.second)
+					m_Transitions.push_back(Transition{ _from, _to, {} });
+				m_LastTransitionIndex = result.first->second;
+				pTransition = &m_Transitions[m_LastTransitionIndex];
+			}
+
+			for (std::size_t i = 0; i < _count; i++)
+				pTransition->m_Events.push_back(Event{ _pEntities[i], m_NextSequence++ });
+		}
+
+		/**
+		* @brief 組ごとの記録を取得します。
+		* @return const std::vector<Transition>& 組ごとの記録。記録のない組も残る。
+		*/
+		const std::vector<Transition>& GetTransitions() const noexcept
+		{
+			return m_Transitions;
+		}
+
+		/**
+		* @brief 組の記録のうち、指定の通し番号以降のものの先頭を取得します。
+		* @param _transition 対象の組。
+		* @param _sequence 通し番号。
+		* @return std::vector<Event>::const_iterator 先頭。
+		*/
+		static std::vector<Event>::const_iterator FindFrom(const Transition& _transition, const Sequence _sequence)
+		{
+			return std::partition_point(_transition.m_Events.begin(), _transition.m_Events.end(),
+				[_sequence](const Event& _event) { return _event.m_Sequence < _sequence; });
+		}
+
+		/**
+		* @brief 指定の通し番号より前の記録を捨てます。
+		* @param _sequence 残す記録の最小の通し番号。
+		*/
+		void Trim(const Sequence _sequence)
+		{
+			for (auto&& transition : m_Transitions)
+				transition.m_Events.erase(transition.m_Events.begin(), FindFrom(transition, _sequence));
+		}
+
+		/**
+		* @brief 全ての記録を捨てます。通し番号は戻さない。
+		*/
+		void Clear()
+		{
+			m_TransitionIndices.clear();
+			m_Transitions.clear();
+			m_LastTransitionIndex = 0;
+		}
+
+		/**
+		* @brief 確保しているメモリ量を取得します。
+		* @return std::size_t メモリ量[byte]。
+		*/
+		std::size_t GetMemorySize() const noexcept
+		{
+			std::size_t size = m_Transitions.capacity() * sizeof(Transition);
+			for (auto&& transition : m_Transitions)
+				size += transition.m_Events.capacity() * sizeof(Event);
+			return size;
+		}
+
+	private:
+		//! 移動元と移動先のアーキタイプのインデックスを詰めたキーから、組の位置への対応。
+		std::unordered_map<std::uint64_t, std::uint32_t> m_TransitionIndices;
+		//! 組ごとの記録。
+		std::vector<Transition> m_Transitions;
+		//! 前回記録した組の位置。
+		std::uint32_t m_LastTransitionIndex = 0;
+		//! 次に記録する通し番号。0は未読を表すので1から始める。
+		Sequence m_NextSequence = 1;
+		//! 記録が有効かどうか。
+		bool m_bEnabled = false;
+	};
+}
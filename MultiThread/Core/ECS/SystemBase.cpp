@@ -4,6 +4,7 @@
 #include "EntityManager.h"
 #include "Chunk.h"
 
+#include <algorithm>
 
 namespace ECS
 {
@@ -11,4 +12,54 @@ namespace ECS
 	{
 		return m_pWorld->GetEntityManager();
 	}
+
+	void SystemBase::SelectSlice(std::vector<Chunk*>& _pChunkList)
+	{
+		const std::size_t chunkCount = _pChunkList.size();
+		m_SliceProcessedCount = chunkCount;
+		if (m_SliceCount <= 1 || chunkCount == 0)
+		{
+			m_SliceRotationCount = 1;
+			return;
+		}
+
+		// 予算がある場合は計測した処理時間から、ない場合は分割数から今回の数を決める
+		std::size_t count = (chunkCount + m_SliceCount - 1) / m_SliceCount;
+		if (m_SliceBudgetMilliseconds > 0.0f && m_ChunkMilliseconds > 0.0f)
+			count = static_cast<std::size_t>(m_SliceBudgetMilliseconds / m_ChunkMilliseconds);
+		count = std::clamp<std::size_t>(count, 1, chunkCount);
+
+		// チャンクが減った場合は先頭から巡り直す
+		if (m_SliceCursor >= chunkCount)
+			m_SliceCursor = 0;
+
+		// 前回の続きが先頭に来るように回して、今回の分だけ残す
+		std::rotate(_pChunkList.begin(), _pChunkList.begin() + m_SliceCursor, _pChunkList.end());
+		_pChunkList.resize(count);
+		m_SliceProcessedCount = count;
+
+		m_SliceExecuteCount++;
+		m_SliceCursor += count;
+		if (m_SliceCursor >= chunkCount)
+		{
+			m_SliceCursor -= chunkCount;
+			m_SliceRotationCount = m_SliceExecuteCount;
+			m_SliceExecuteCount = 0;
+		}
+	}
+
+	void SystemBase::RecordSliceTime(const std::chrono::steady_clock::time_point& _startTime)
+	{
+		if (m_SliceBudgetMilliseconds <= 0.0f || m_SliceProcessedCount == 0)
+			return;
+
+		const float milliseconds = std::chrono::duration<float, std::milli>(
+			std::chrono::steady_clock::now() - _startTime).count();
+		const float chunkMilliseconds = milliseconds / static_cast<float>(m_SliceProcessedCount);
+
+		// 1フレームの揺れで処理数が暴れないように、移動平均でならす
+		m_ChunkMilliseconds = m_ChunkMilliseconds > 0.0f ?
+			m_ChunkMilliseconds + (chunkMilliseconds - m_ChunkMilliseconds) * mc_ChunkTimeSmoothing :
+			chunkMilliseconds;
+	}
 }
@@ -2,24 +2,34 @@
 
 #include "Archetype.h"
 #include "Chunk.h"
+#include "StaticArchetype.h"
 #include "World.h"
 #include "EntityManager.h"
+#include "ComponentLookup.h"
 
 #include "../../AsyncFunctionManager.h"
+#include <array>
+#include <memory>
+#include <tuple>
+#include <cstddef>
+#include <type_traits>
+#include <chrono>
+#include <limits>
+#include <utility>
 
 namespace ECS
 {
 	/**
 	* @class SystemBase
-	* @brief VXex[XNXBSẴVXe͂pB
+	* @brief システムベースクラス。全てのシステムはこれを継承する。
 	*/
 	class SystemBase
 	{
 	public:
 		/**
-		* @brief RXgN^B
-		* @param _pWorld 郏[hւ̃|C^B
-		* @param _Id VXeʂӂIDB
+		* @brief コンストラクタ。
+		* @param _pWorld 属するワールドへのポインタ。
+		* @param _Id システムを識別する一意のID。
 		*/
 		SystemBase(World* _pWorld, std::size_t _Id)
 			: m_pWorld(_pWorld)
@@ -27,24 +37,26 @@ namespace ECS
 		{}
 
 		/**
-		* @brief ŏɈx̂ݏs܂B
+		* @brief 最初に一度のみ処理を実行します。
 		*/
 		virtual void Init() {}
 
 		/**
-		* @brief s܂B
-		* @param _deltaTime Ot[Ƃ̍[ms]
+		* @brief 処理を実行します。
+		* @param _deltaTime 前フレームとの差[ms]
 		*/
 		virtual void Update(float _deltaTime, std::shared_ptr<AsyncFunctionManager> _pAsyncManager) {}
 
 		/**
-		* @brief `s܂B
+		* @brief 描画を実行します。
+		* @param _renderState Updateの最後に抽出された描画用の複製。
+		* @note Updateと並行して呼ばれることがあるので、ワールドのチャンクには触れないこと。
 		*/
-		virtual void Draw() {}
+		virtual void Draw(const RenderState& _renderState) {}
 
 		/**
-		* @brief ŝɕKvƂA[L^Cv擾܂B
-		* @return const Archetype& ŝɕKvȃA[L^CvB
+		* @brief 実行するのに必要とするアーキタイプを取得します。
+		* @return const Archetype& 実行するのに必要なアーキタイプ。
 		*/
 		inline const Archetype& GetArchetype() const noexcept
 		{
@@ -52,8 +64,8 @@ namespace ECS
 		}
 
 		/**
-		* @brief ŝɕKvƂA[L^Cv擾܂B
-		* @return Archetype* ŝɕKvȃA[L^CvB
+		* @brief 実行するのに必要とするアーキタイプを取得します。
+		* @return Archetype* 実行するのに必要なアーキタイプ。
 		*/
 		inline Archetype* GetArchetype()
 		{
@@ -61,57 +73,508 @@ namespace ECS
 		}
 
 		/**
-		* @brief Ă郏[h̃GeBeB}l[W[擾܂B
-		* @return std::shared_ptr<EntityManager> Ă郏[h̃GeBeB}l[W[B
+		* @brief 属しているワールドのエンティティマネージャーを取得します。
+		* @return std::shared_ptr<EntityManager> 属しているワールドのエンティティマネージャー。
 		*/
 		std::shared_ptr<EntityManager> GetEntityManager();
 
 		/**
-		* @brief VXeʂӂID擾܂B
-		* @return std::size_t ӂID
+		* @brief システムを識別する一意のIDを取得します。
+		* @return std::size_t 一意のID
 		*/
 		std::size_t GetSystemId() const noexcept
 		{
 			return m_SystemId;
 		}
 
+		/**
+		* @brief 対象のチャンクを複数フレームに分けて処理するように設定します。
+		* @param _sliceCount 1周にかけるフレーム数。1回の実行で対象のチャンクの1/_sliceCountを処理する。1で分割しない。
+		* @param _budgetMilliseconds 1回の実行にかける時間の目安[ms]。0より大きい場合は、これまでの
+		*		 1チャンクあたりの処理時間から、目安に収まる数のチャンクを処理する(最低1チャンク)。
+		* @note チャンクは前回の続きから順に巡るので、全てのチャンクが公平に処理される。
+		*		 AIや経路探索、LODのように毎フレーム全てのエンティティを更新しなくてよい処理に使う。
+		*/
+		void SetTimeSlice(const std::uint32_t _sliceCount, const float _budgetMilliseconds = 0.0f) noexcept
+		{
+			m_SliceCount = _sliceCount == 0 ? 1 : _sliceCount;
+			m_SliceBudgetMilliseconds = _budgetMilliseconds;
+		}
+
+		/**
+		* @brief 前回、対象のチャンクを1周するのにかかった実行回数を取得します。
+		* @return std::uint32_t 実行回数。分割しない場合は1。
+		* @note 分割した場合、各エンティティは前回の処理からこの回数分のフレームが経っている。
+		*/
+		std::uint32_t GetSliceRotationCount() const noexcept
+		{
+			return m_SliceRotationCount;
+		}
+
+		/**
+		* @brief 構成の変化の記録を、どこまで読んだかを取得します。
+		* @return StructuralEventLog::Sequence 前回読んだ通し番号の最小値。記録を読んでいない場合は最大値。
+		* @note ワールドは全てのシステムが読み終えた記録を捨てる。
+		*/
+		StructuralEventLog::Sequence GetStructuralEventCursor() const noexcept
+		{
+			StructuralEventLog::Sequence cursor = (std::numeric_limits<StructuralEventLog::Sequence>::max)();
+			if (m_AddedEventCursor != 0)
+				cursor = m_AddedEventCursor;
+			if (m_RemovedEventCursor != 0)
+				cursor = (std::min)(cursor, m_RemovedEventCursor);
+			return cursor;
+		}
+
 	protected:
 		/**
-		* @brief KvȃA[L^Cv܂łGeBeBɊ֐s܂B
-		* @tparam Components R|[lǧ^̃XgB
-		* @param _func s֐B
+		* @brief エンティティから特定のコンポーネントを引くためのキャッシュを作成します。
+		* @tparam CompT 引くコンポーネントの型。読み取りのみの場合はconstを付ける。
+		* @return ComponentLookup<CompT> 作成したキャッシュ。
+		* @note ターゲットや親など、エンティティの参照をたどる処理に使う。
+		*/
+		template <typename CompT>
+		ComponentLookup<CompT> GetComponentLookup()
+		{
+			return ComponentLookup<CompT>(*m_pWorld);
+		}
+
+		/**
+		* @brief 必要なアーキタイプを含んでいるエンティティに関数を実行します。
+		* @tparam Components コンポーネントの型のリスト。
+		* @param _func 実行する関数。
+		* @note ロックが有効な場合は、実行の間だけ対象のアーキタイプのロックを読み取りで取るので、
+		*		 他のアーキタイプの構成の変更と並行できる。関数の中で対象のアーキタイプの構成を変えないこと。
 		*/
 		template <class... Components, typename Func>
 		void ExecuteForEntitiesMatching(std::shared_ptr<AsyncFunctionManager> _pAsyncManager, Func&& _func)
 		{
-			// A[L^Cv܂܂Ă`NXg擾
-			auto pChunkList = m_pWorld->GetEntityManager()->GetContainChunkList(m_Archetype);
+			// 疎な集合に格納する型を含む場合は、エンティティごとに集合と突き合わせる
+			if constexpr ((SparseComponent<Components> || ...))
+			{
+				ExecuteForJoinedEntities<Components...>(std::move(_pAsyncManager), _func);
+			}
+			else
+			{
+				// アーキタイプが含まれているチャンクリストを取得
+				ArchetypeReadScope readScope(*m_pWorld, m_Archetype, m_pChunkListCache, m_QueryCache, m_pReadLockCache);
+				SelectSlice(m_pChunkListCache);
+
+				//=== 非同期処理
+				// チャンクごとに必要なコンポーネント群を抜き出して、処理を並列に実行する。
+				const auto startTime = std::chrono::steady_clock::now();
+				_pAsyncManager->ParallelFor(m_pChunkListCache.size(), 1, [this, &_func](std::size_t _index) {
+					Chunk* pChunk = m_pChunkListCache[_index];
+					ExecuteForEntitiesMatchingImpl(pChunk, _func, pChunk->GetComponentList<Components>()...); });
+				RecordSliceTime(startTime);
+			}
+		}
+
+		/**
+		* @brief 必要なアーキタイプを含んでいるエンティティから値を求め、1つに畳み込みます。
+		* @tparam Components 関数に渡すコンポーネントの型のリスト。読み取りのみの場合はconstを付ける。
+		* @param _init 畳み込みの初期値。_combineの単位元である必要がある(和なら0、最小値なら最大値など)。
+		* @param _map エンティティごとの値を求める関数。(Components&...)を受け取り、Tを返す。
+		* @param _combine 2つの値をまとめる関数。(const T&, const T&)を受け取り、Tを返す。結合的である必要がある。
+		* @return T 畳み込んだ値。該当するエンティティがない場合は_init。
+		* @note チャンク内は行をmc_ReduceLaneCount個の独立した部分に振り分けて畳み込むので、
+		*		 内側のループはベクトル化できる。チャンクごとの結果はキャッシュラインを共有しないように
+		*		 分けて置き、最後にチャンクの順に固定の二分木で畳み込む。スレッド数や実行順によらず
+		*		 まとめる順序が同じなので、浮動小数点の和でも毎回同じ結果になる。時間分割の設定は使わない。
+		*		 ロックが有効な場合は、ExecuteForEntitiesMatchingと同じく対象のアーキタイプのロックを取る。
+		*/
+		template <class... Components, typename T, typename MapFunc, typename CombineFunc>
+		T ReduceForEntitiesMatching(std::shared_ptr<AsyncFunctionManager> _pAsyncManager,
+			const T& _init, MapFunc&& _map, CombineFunc&& _combine)
+		{
+			static_assert((!SparseComponent<Components> && ...),
+				"ReduceForEntitiesMatching only supports components stored in chunks.");
 
-			//=== 񓯊
-			std::vector<std::future<void>> futures;
+			ArchetypeReadScope readScope(*m_pWorld, m_Archetype, m_pChunkListCache, m_QueryCache, m_pReadLockCache);
+			if (m_pChunkListCache.empty())
+				return _init;
 
-			for (auto&& pChunk : pChunkList)
+			//=== 非同期処理
+			// チャンクごとの結果は、チャンクの位置で決まる場所に書く
+			// 結果の置き場は呼び出しごとに確保せず、システムの作業領域をTとして使う
+			const std::size_t slotCount = m_pChunkListCache.size();
+			ReduceSlot<T>* pSlots = AcquireReduceScratch<T>(slotCount);
+			std::uninitialized_fill_n(pSlots, slotCount, ReduceSlot<T>{ _init });
+			_pAsyncManager->ParallelFor(slotCount, 1, [&](std::size_t _index) {
+				Chunk* pChunk = m_pChunkListCache[_index];
+				pSlots[_index].m_Value = ReduceChunk<T>(pChunk->GetSize(), _init, _map, _combine,
+					pChunk->GetComponentList<Components>().Begin()...); });
+
+			T result = CombineTree<T>(slotCount, [pSlots](std::size_t _index) -> T& {
+				return pSlots[_index].m_Value; }, _combine);
+			std::destroy_n(pSlots, slotCount);
+			return result;
+		}
+
+		/**
+		* @brief 静的アーキタイプと構成が一致するチャンクの全エンティティに関数を実行します。
+		* @tparam StaticArchetypeT 対象の静的アーキタイプ。
+		* @param _func 実行する関数。StaticArchetypeTの型リスト順にコンポーネントを受け取る。
+		* @note 列のオフセットはコンパイル時定数なので、チャンク毎のオフセット計算が不要。
+		*/
+		template <class StaticArchetypeT, typename Func>
+		void ExecuteForStaticArchetype(std::shared_ptr<AsyncFunctionManager> _pAsyncManager, Func&& _func)
+		{
+			// 構成が完全に一致するチャンクのみを対象にする
+			m_pWorld->GetEntityManager()->GetContainChunkList(StaticArchetypeT::cArchetype, m_pChunkListCache, m_QueryCache);
+			std::erase_if(m_pChunkListCache, [](const Chunk* _pChunk) {
+				return !(_pChunk->GetArchetype() == StaticArchetypeT::cArchetype); });
+			SelectSlice(m_pChunkListCache);
+
+			//=== 非同期処理
+			const auto startTime = std::chrono::steady_clock::now();
+			_pAsyncManager->ParallelFor(m_pChunkListCache.size(), 1, [this, &_func](std::size_t _index) {
+				StaticArchetypeT::ForEach(*m_pChunkListCache[_index], _func); });
+			RecordSliceTime(startTime);
+		}
+
+		/**
+		* @brief 前回の実行から、必要とするアーキタイプを含むようになったエンティティに関数を実行します。
+		* @tparam Components 関数に渡すコンポーネントの型のリスト。
+		* @param _func 実行する関数。(const Entity&, Components&...)を受け取る。
+		* @note 初回は該当する全てのエンティティに実行する。初期化のように1度だけ行う処理を、
+		*		 毎フレーム全てのエンティティを調べずに済ませるのに使う。呼び出し元のスレッドで順に
+		*		 実行するので、関数の中でエンティティの構成を変えてよい。1回の実行で1度だけ呼ぶこと。
+		*/
+		template <class... Components, typename Func>
+		void ExecuteForAddedEntities(Func&& _func)
+		{
+			static_assert((!SparseComponent<Components> && ...),
+				"Sparse components do not change the archetype and cannot be tracked.");
+
+			m_pWorld->GetEntityManager()->ForEachAddedEntity(m_Archetype, m_AddedEventCursor,
+				[&_func](const Entity& _entity, Chunk& _chunk, const std::uint32_t _chunkIndex) {
+					_func(_entity, _chunk.GetComponentList<Components>()[_chunkIndex]...); });
+		}
+
+		/**
+		* @brief 前回の実行から、必要とするアーキタイプを含まなくなったエンティティに関数を実行します。
+		* @param _func 実行する関数。(const Entity&)を受け取る。破棄されたエンティティも含む。
+		* @note 初回は記録を読み始めるだけで関数は実行しない。後始末の処理に使う。
+		*		 1回の実行で1度だけ呼ぶこと。
+		*/
+		template <typename Func>
+		void ExecuteForRemovedEntities(Func&& _func)
+		{
+			m_pWorld->GetEntityManager()->ForEachRemovedEntity(m_Archetype, m_RemovedEventCursor, _func);
+		}
+
+	private:
+		/**
+		* @struct JoinSourceOf
+		* @brief 突き合わせ処理で、コンポーネントを引く元の型。チャンクに格納する型は列。
+		*/
+		template <class CompT, bool = SparseComponent<CompT>>
+		struct JoinSourceOf
+		{
+			using Type = ComponentArray<CompT>;
+		};
+
+		/**
+		* @struct JoinSourceOf
+		* @brief 疎な集合に格納する型は集合から引く。
+		*/
+		template <class CompT>
+		struct JoinSourceOf<CompT, true>
+		{
+			using Type = SparseSet<std::remove_cvref_t<CompT>>*;
+		};
+
+		//! 突き合わせ処理で、コンポーネントを引く元。
+		template <class CompT>
+		using JoinSource = typename JoinSourceOf<CompT>::Type;
+
+		/**
+		* @struct JoinSetOf
+		* @brief 突き合わせ処理で使う疎な集合の型。チャンクに格納する型は集合を使わない。
+		*/
+		template <class CompT, bool = SparseComponent<CompT>>
+		struct JoinSetOf
+		{
+			using Type = std::nullptr_t;
+		};
+
+		/**
+		* @struct JoinSetOf
+		* @brief 疎な集合に格納する型は、その型の集合。
+		*/
+		template <class CompT>
+		struct JoinSetOf<CompT, true>
+		{
+			using Type = SparseSet<std::remove_cvref_t<CompT>>*;
+		};
+
+		//! 突き合わせ処理で使う疎な集合。チャンクに格納する型はnullptr。
+		template <class CompT>
+		using JoinSet = typename JoinSetOf<CompT>::Type;
+
+		/**
+		* @class JoinSetScope
+		* @brief 突き合わせに使う疎な集合を引き、スコープの間はクエリとして集合を読む。
+		* @note 集合への追加と削除はスコープを抜けるまで保留されるので、ジョブからはロックなしで読める。
+		*/
+		template <class... Components>
+		class JoinSetScope
+		{
+		public:
+			explicit JoinSetScope(const World& _world)
+				: m_Sets(FindJoinSet<Components>(_world)...)
 			{
-				auto func = std::forward<Func>(_func);
-				// AsyncFunctionManagerExecute\bhgpāA
-				// KvȃR|[lgQ𔲂oāA񓯊ɎsB
-				auto future = _pAsyncManager->Execute([this, pChunk, func]() {
-					ExecuteForEntitiesMatchingImpl(pChunk, func, pChunk->GetComponentList<Components>()...); });
-				futures.push_back(std::move(future));
+				std::apply([](auto... _pSets) { (BeginQuery(_pSets), ...); }, m_Sets);
 			}
 
-			// ׂẴ^XN܂őҋ@
-			for (auto& future : futures) {
-				future.get();
+			~JoinSetScope()
+			{
+				std::apply([](auto... _pSets) { (EndQuery(_pSets), ...); }, m_Sets);
 			}
+
+			JoinSetScope(const JoinSetScope&) = delete;
+			JoinSetScope& operator=(const JoinSetScope&) = delete;
+
+			/**
+			* @brief 疎な集合に格納する全ての型の集合に、要素があるかどうかを判定します。
+			* @return bool 全てに要素がある場合はtrue。
+			*/
+			bool HasAllElements() const
+			{
+				return std::apply([](auto... _pSets) { return (HasElements(_pSets) && ...); }, m_Sets);
+			}
+
+			/**
+			* @brief 引いた集合を取得します。
+			* @return const std::tuple<JoinSet<Components>...>& Componentsと同じ順に並ぶ。
+			*/
+			const std::tuple<JoinSet<Components>...>& GetSets() const noexcept
+			{
+				return m_Sets;
+			}
+
+		private:
+			template <class CompT>
+			static JoinSet<CompT> FindJoinSet(const World& _world)
+			{
+				if constexpr (SparseComponent<CompT>)
+					return _world.FindSparseSet<CompT>();
+				else
+					return nullptr;
+			}
+
+			static void BeginQuery(SparseSetBase* _pSet) { if (_pSet) _pSet->BeginQuery(); }
+			static void BeginQuery(std::nullptr_t) {}
+			static void EndQuery(SparseSetBase* _pSet) { if (_pSet) _pSet->EndQuery(); }
+			static void EndQuery(std::nullptr_t) {}
+			static bool HasElements(const SparseSetBase* _pSet) { return _pSet && _pSet->GetSize() > 0; }
+			static bool HasElements(std::nullptr_t) { return true; }
+
+			//! 引いた集合。
+			std::tuple<JoinSet<Components>...> m_Sets;
+		};
+
+		/**
+		* @brief 疎な集合に格納する型を含むエンティティに関数を実行します。
+		* @tparam Components コンポーネントの型のリスト。
+		* @param _func 実行する関数。全てのコンポーネントを持つエンティティだけに実行する。
+		* @note 集合の取得は呼び出し元のスレッドで済ませ、ジョブからは読み取りだけを行う。
+		*		 実行の間は対象の集合への追加と削除を保留し、終わった時点で適用する。
+		*		 ジョブの中や他のスレッドから追加、削除してもよいが、結果は実行の後に見える。
+		*/
+		template <class... Components, typename Func>
+		void ExecuteForJoinedEntities(std::shared_ptr<AsyncFunctionManager> _pAsyncManager, Func& _func)
+		{
+			// どれかの集合が空なら該当するエンティティはない。要素数もクエリを始めてから読む
+			const JoinSetScope<Components...> setScope(*m_pWorld);
+			if (!setScope.HasAllElements())
+				return;
+
+			ArchetypeReadScope readScope(*m_pWorld, m_Archetype, m_pChunkListCache, m_QueryCache, m_pReadLockCache);
+			SelectSlice(m_pChunkListCache);
+
+			const auto startTime = std::chrono::steady_clock::now();
+			_pAsyncManager->ParallelFor(m_pChunkListCache.size(), 1, [this, &_func, &setScope](std::size_t _index) {
+				Chunk* pChunk = m_pChunkListCache[_index];
+				std::apply([&](auto... _pSets) {
+					ExecuteForJoinedEntitiesImpl<Components...>(pChunk, _func, GetJoinSource<Components>(pChunk, _pSets)...); },
+					setScope.GetSets()); });
+			RecordSliceTime(startTime);
 		}
 
-	private:
 		/**
-		* @brief SĂ̊YGeBeBɊ֐s܂B
-		* @param _pChunk Y`NB
-		* @param _func s֐B
-		* @param _args ֐ɈnR|[lgQB
+		* @brief チャンクから突き合わせに使う引き元を取得します。
+		* @tparam CompT コンポーネントの型。
+		* @param _pChunk 対象のチャンク。
+		* @param _pSet 呼び出し元のスレッドで引いた疎な集合。
+		* @return JoinSource<CompT> 引き元。
+		*/
+		template <class CompT>
+		static JoinSource<CompT> GetJoinSource(Chunk* _pChunk, const JoinSet<CompT> _pSet)
+		{
+			if constexpr (SparseComponent<CompT>)
+				return _pSet;
+			else
+				return _pChunk->GetComponentList<CompT>();
+		}
+
+		/**
+		* @brief チャンク内のエンティティを疎な集合と突き合わせて関数を実行します。
+		* @param _pChunk 該当チャンク。
+		* @param _func 実行する関数。
+		* @param _sources 各コンポーネントの引き元。
+		*/
+		template <class... Components, typename Func>
+		static void ExecuteForJoinedEntitiesImpl(Chunk* _pChunk, Func& _func, JoinSource<Components>... _sources)
+		{
+			for (std::uint32_t i = 0; i < _pChunk->GetSize(); ++i)
+			{
+				const Entity& entity = _pChunk->GetEntity(i);
+				[&_func](auto*... _pComponents) {
+					if ((_pComponents && ...))
+						_func(*_pComponents...);
+				}(GetJoinedComponent<Components>(_sources, i, entity)...);
+			}
+		}
+
+		/**
+		* @brief 引き元から1エンティティ分のコンポーネントを取得します。
+		* @param _source 引き元。
+		* @param _chunkIndex チャンク内インデックス。
+		* @param _entity 対象のエンティティ。
+		* @return CompT* コンポーネント。疎な集合に持っていない場合はnullptr。
+		*/
+		template <class CompT>
+		static CompT* GetJoinedComponent(JoinSource<CompT>& _source, const std::uint32_t _chunkIndex, const Entity& _entity)
+		{
+			if constexpr (SparseComponent<CompT>)
+				return _source->Find(_entity);
+			else
+				return &_source[_chunkIndex];
+		}
+
+		//! 畳み込みでチャンク内の行を振り分ける部分の数。
+		static constexpr std::uint32_t mc_ReduceLaneCount = 8;
+
+		/**
+		* @struct ReduceSlot
+		* @brief 畳み込みのチャンクごとの結果。隣の結果とキャッシュラインを共有しないように揃える。
+		*/
+		template <typename T>
+		struct alignas(64) ReduceSlot
+		{
+			//! 結果。
+			T m_Value;
+		};
+
+		/**
+		* @struct ReduceScratchBlock
+		* @brief 畳み込みの作業領域の単位。ReduceSlotと同じ境界に揃える。
+		*/
+		struct alignas(64) ReduceScratchBlock
+		{
+			//! 中身。
+			std::byte m_Bytes[64];
+		};
+
+		/**
+		* @brief 畳み込みの作業領域を、ReduceSlot<T>を_count個置ける大きさにして取得します。
+		* @param _count 置く数。
+		* @return ReduceSlot<T>* 先頭。要素は構築されていないので、使う側で構築と破棄をする。
+		* @note 足りない場合だけ確保し直し、縮めない。型の違う畳み込みでも同じ領域を使い回す。
+		*/
+		template <typename T>
+		ReduceSlot<T>* AcquireReduceScratch(const std::size_t _count)
+		{
+			static_assert(alignof(ReduceSlot<T>) <= alignof(ReduceScratchBlock),
+				"ReduceForEntitiesMatching does not support types aligned beyond a cache line.");
+
+			const std::size_t blockCount =
+				(_count * sizeof(ReduceSlot<T>) + sizeof(ReduceScratchBlock) - 1) / sizeof(ReduceScratchBlock);
+			if (blockCount > m_ReduceScratchBlockCount)
+			{
+				m_pReduceScratch = std::make_unique<ReduceScratchBlock[]>(blockCount);
+				m_ReduceScratchBlockCount = blockCount;
+			}
+			return reinterpret_cast<ReduceSlot<T>*>(m_pReduceScratch.get());
+		}
+
+		/**
+		* @brief チャンク内の全エンティティの値を畳み込みます。
+		* @param _size チャンク内のエンティティ数。
+		* @param _init 畳み込みの初期値。
+		* @param _map エンティティごとの値を求める関数。
+		* @param _combine 2つの値をまとめる関数。
+		* @param _pColumns 各コンポーネントの列の先頭。
+		* @return T 畳み込んだ値。
+		* @note 行iはi % mc_ReduceLaneCount番目の部分に畳み込む。部分同士には依存がないので、
+		*		 レーンの数だけ並べて計算できる。
+		*/
+		template <typename T, typename MapFunc, typename CombineFunc, class... Components>
+		static T ReduceChunk(const std::uint32_t _size, const T& _init, MapFunc& _map, CombineFunc& _combine,
+			Components*... _pColumns)
+		{
+			std::array<T, mc_ReduceLaneCount> lanes = MakeReduceLanes(_init, std::make_index_sequence<mc_ReduceLaneCount>());
+
+			std::uint32_t i = 0;
+			for (; i + mc_ReduceLaneCount <= _size; i += mc_ReduceLaneCount)
+			{
+				for (std::uint32_t lane = 0; lane < mc_ReduceLaneCount; ++lane)
+					lanes[lane] = _combine(lanes[lane], _map(_pColumns[i + lane]...));
+			}
+			for (std::uint32_t lane = 0; i < _size; ++i, ++lane)
+				lanes[lane] = _combine(lanes[lane], _map(_pColumns[i]...));
+
+			return CombineTree<T>(lanes.size(), [&lanes](std::size_t _index) -> T& { return lanes[_index]; }, _combine);
+		}
+
+		/**
+		* @brief 畳み込みの部分を初期値で埋めて作成します。
+		* @param _init 初期値。
+		* @return std::array<T, mc_ReduceLaneCount> 部分。
+		*/
+		template <typename T, std::size_t... Indices>
+		static std::array<T, mc_ReduceLaneCount> MakeReduceLanes(const T& _init, std::index_sequence<Indices...>)
+		{
+			return { { ((void)Indices, _init)... } };
+		}
+
+		/**
+		* @brief 値の列を、隣同士をまとめる固定の二分木の順に畳み込みます。
+		* @param _count 値の数。1以上である必要がある。
+		* @param _get 番号から値の参照を取得する関数。途中の結果の置き場にも使う。
+		* @param _combine 2つの値をまとめる関数。
+		* @return T 畳み込んだ値。
+		*/
+		template <typename T, typename GetFunc, typename CombineFunc>
+		static T CombineTree(const std::size_t _count, GetFunc&& _get, CombineFunc& _combine)
+		{
+			for (std::size_t stride = 1; stride < _count; stride *= 2)
+			{
+				for (std::size_t i = 0; i + stride < _count; i += stride * 2)
+					_get(i) = _combine(_get(i), _get(i + stride));
+			}
+			return _get(0);
+		}
+
+		/**
+		* @brief 時間分割の設定に従って、今回処理するチャンクだけを残します。
+		* @param _pChunkList 対象のチャンクのリスト。前回の続きから今回処理する数だけに絞る。
+		*/
+		void SelectSlice(std::vector<Chunk*>& _pChunkList);
+
+		/**
+		* @brief 今回の処理時間を記録し、予算がある場合は1チャンクあたりの処理時間を更新します。
+		* @param _startTime 処理を始めた時刻。
+		*/
+		void RecordSliceTime(const std::chrono::steady_clock::time_point& _startTime);
+
+		/**
+		* @brief 全ての該当エンティティに関数を実行します。
+		* @param _pChunk 該当チャンク。
+		* @param _func 実行する関数。
+		* @param _args 関数に引き渡すコンポーネント群。
 		*/
 		template <typename Func, class... Args>
 		static void ExecuteForEntitiesMatchingImpl(
@@ -126,13 +589,43 @@ namespace ECS
 		}
 
 	protected:
-		//! ŝɕKvƂA[L^CvB
+		//! 実行するのに必要とするアーキタイプ。
 		Archetype m_Archetype;
 	protected:
-		//! VXeID
+		//! システムID
 		std::size_t m_SystemId;
 	private:
-		//! Ă郏[hւ̃|C^B
+		//! 属しているワールドへのポインタ。
 		World* m_pWorld = nullptr;
+		//! 対象のチャンクのリスト。毎フレームの確保を避けるために使い回す。
+		std::vector<Chunk*> m_pChunkListCache;
+		//! チャンクを探すときの検索用のシグネチャ。同じく使い回す。
+		ArchetypeQuery m_QueryCache;
+		//! 実行中に読み取りで取っているアーキタイプのロック。同じく使い回す。
+		std::vector<ScalableReadWriteLock*> m_pReadLockCache;
+		//! 畳み込みのチャンクごとの結果を置く作業領域。結果の型を問わず使い回すので、バイト列で持つ。
+		std::unique_ptr<ReduceScratchBlock[]> m_pReduceScratch;
+		//! m_pReduceScratchのブロック数。
+		std::size_t m_ReduceScratchBlockCount = 0;
+		//! 1周にかけるフレーム数。1で分割しない。
+		std::uint32_t m_SliceCount = 1;
+		//! 1回の実行にかける時間の目安[ms]。0以下で時間による調整をしない。
+		float m_SliceBudgetMilliseconds = 0.0f;
+		//! 次に処理するチャンクの、対象のチャンクのリスト内での位置。
+		std::size_t m_SliceCursor = 0;
+		//! 今回処理したチャンクの数。
+		std::size_t m_SliceProcessedCount = 0;
+		//! 1チャンクあたりの処理時間の移動平均[ms]。0は未計測。
+		float m_ChunkMilliseconds = 0.0f;
+		//! 今の1周を始めてからの実行回数。
+		std::uint32_t m_SliceExecuteCount = 0;
+		//! 前回1周するのにかかった実行回数。
+		std::uint32_t m_SliceRotationCount = 1;
+		//! ExecuteForAddedEntitiesで前回読んだ構成の変化の通し番号。0は未読。
+		StructuralEventLog::Sequence m_AddedEventCursor = 0;
+		//! ExecuteForRemovedEntitiesで前回読んだ構成の変化の通し番号。0は未読。
+		StructuralEventLog::Sequence m_RemovedEventCursor = 0;
+		//! 1チャンクあたりの処理時間の移動平均で、新しい計測値を混ぜる割合。
+		static constexpr float mc_ChunkTimeSmoothing = 0.25f;
 	};
 }
\ No newline at end of file
@@ -55,25 +55,25 @@ namespace ECS
 		class TestSystem : public SystemBase {
 		public:
 			/**
-			* @brief RXgN^B
-			* @param _pWorld [h|C^B
-			* @param _Id ӂIDB
+			* @brief コンストラクタ。
+			* @param _pWorld ワールドポインタ。
+			* @param _Id 一意のID。
 			*/
 			TestSystem(World* _pWorld, std::size_t _Id)
 				: SystemBase(_pWorld, _Id)
 			{}
 
 			/**
-			* @brief ܂B
+			* @brief 初期化処理をします。
 			*/
 			void Init() override
 			{
-				// A[L^CvɕKvȃR|[lgݒ肷B
+				// アーキタイプに必要なコンポーネントを設定する。
 				ArchetypeSetting();
 			}
 
 			/**
-			* @brief XV܂B
+			* @brief 更新処理をします。
 			*/
 			void Update(float _deltaTime, std::shared_ptr<AsyncFunctionManager> _pAsyncManager) override
 			{
@@ -105,7 +105,7 @@ namespace ECS
 						Component9& _comp9,
 						Component10& _comp10
 						) {
-							// 
+							// 処理
 							_comp10.value =
 								_comp0.value +
 								_comp1.value +
@@ -121,7 +121,7 @@ namespace ECS
 			}
 		private:
 			/**
-			* @brief A[L^CvɕKvȃR|[lgݒ肵܂B
+			* @brief アーキタイプに必要なコンポーネントを設定します。
 			*/
 			void ArchetypeSetting()
 			{
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+
+#include "IComponentData.h"
+#include "Entity.h"
+#include "Utilities/TypeInfo.h"
+
+namespace ECS
+{
+	/**
+	* @struct Matrix4x4
+	* @brief 変換行列。行ベクトル形式で、親への変換は右から掛ける。
+	*/
+	struct Matrix4x4
+	{
+		/**
+		* @brief 単位行列を取得します。
+		*/
+		static constexpr Matrix4x4 Identity() noexcept
+		{
+			return { { {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1} } };
+		}
+
+		/**
+		* @brief 行列の積を求めます。
+		*/
+		constexpr Matrix4x4 operator*(const Matrix4x4& _other) const noexcept
+		{
+			Matrix4x4 result{};
+			for (int row = 0; row < 4; row++)
+			{
+				for (int column = 0; column < 4; column++)
+				{
+					result.m[row][column] =
+						m[row][0] * _other.m[0][column] +
+						m[row][1] * _other.m[1][column] +
+						m[row][2] * _other.m[2][column] +
+						m[row][3] * _other.m[3][column];
+				}
+			}
+			return result;
+		}
+
+		//! 行列の要素。
+		float m[4][4];
+	};
+
+	/**
+	* @struct LocalTransform
+	* @brief 親(親がなければワールド)を基準にした変換。
+	*/
+	struct LocalTransform : public IComponentData
+	{
+		Matrix4x4 m_Matrix = Matrix4x4::Identity();
+	};
+
+	/**
+	* @struct LocalToWorld
+	* @brief ワールドへの変換。TransformSystemが親から順に求める。
+	*/
+	struct LocalToWorld : public IComponentData
+	{
+		Matrix4x4 m_Matrix = Matrix4x4::Identity();
+	};
+
+	/**
+	* @struct Parent
+	* @brief 親のエンティティ。EntityManager::SetParentでのみ設定する。
+	*/
+	struct Parent : public IComponentData
+	{
+		//! 親のエンティティ。
+		Entity m_Entity;
+		//! 階層の深さ。ルートの子が1。
+		std::uint32_t m_Depth;
+	};
+
+	/**
+	* @struct HierarchyDepth
+	* @brief 階層の深さごとにアーキタイプを分けるための、サイズ0のタグ。
+	* @note 型IDはGetTypeIdで深さごとに作る。同じ深さのエンティティが
+	*		 同じチャンクに集まるので、深さ単位で順に並列処理できる。
+	*/
+	struct HierarchyDepth
+	{
+		/**
+		* @brief 深さのタグの型IDを取得します。
+		* @param _depth 階層の深さ。1以上。
+		* @return TypeId 型ID。
+		*/
+		static constexpr TypeId GetTypeId(const std::uint32_t _depth) noexcept
+		{
+			TypeId id = TypeManager::TypeInfo<HierarchyDepth>::GetID();
+			for (int i = 0; i < 4; i++)
+			{
+				id ^= (_depth >> (i * 8)) & 0xFF;
+				id *= 1099511628211ull;
+			}
+			return id;
+		}
+	};
+}
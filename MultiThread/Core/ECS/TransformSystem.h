@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+
+#include "SystemBase.h"
+#include "Transform.h"
+#include "ComponentLookup.h"
+#include "Common/ChangeVersion.h"
+
+namespace ECS
+{
+	/**
+	* @class TransformSystem
+	* @brief LocalTransformからLocalToWorldを求めるシステム。
+	* @note 親子関係は深さごとに別のアーキタイプに分かれているので、ルートから深さ順に
+	*		 1段ずつ処理し、同じ深さのチャンクは並列に処理する。
+	*		 LocalTransformかParentが書き込まれたチャンクと、親のLocalToWorldをこの更新で
+	*		 書き換えたエンティティだけを計算し直す。
+	*/
+	class TransformSystem : public SystemBase
+	{
+	public:
+		/**
+		* @brief コンストラクタ。
+		* @param _pWorld ワールドポインタ。
+		* @param _Id 一意のID。
+		*/
+		TransformSystem(World* _pWorld, std::size_t _Id)
+			: SystemBase(_pWorld, _Id)
+		{}
+
+		/**
+		* @brief 初期化処理をします。
+		*/
+		void Init() override
+		{
+			m_Archetype.AddType<LocalTransform>();
+			m_Archetype.AddType<LocalToWorld>();
+		}
+
+		/**
+		* @brief 更新処理をします。
+		*/
+		void Update(float _deltaTime, std::shared_ptr<AsyncFunctionManager> _pAsyncManager) override
+		{
+			// 前回の更新以降の書き込みと、この更新での書き込みを区別できるようにバージョンを進める
+			const ChangeVersion lastVersion = m_LastVersion;
+			m_LastVersion = GlobalChangeVersion::Advance();
+			const ChangeVersion currentVersion = GlobalChangeVersion::Get();
+
+			auto pEntityManager = GetEntityManager();
+
+			//=== ルート
+			std::vector<Chunk*> pRootChunkList;
+			for (auto&& pChunk : pEntityManager->GetContainChunkList(m_Archetype))
+			{
+				if (!pChunk->GetArchetype().HasType<Parent>())
+					pRootChunkList.push_back(pChunk);
+			}
+			ExecuteForChunks(_pAsyncManager, pRootChunkList, [lastVersion](Chunk* _pChunk) {
+				UpdateRootChunk(*_pChunk, lastVersion); });
+
+			//=== 深さ順に子。親の深さは処理済み
+			auto parentLookup = GetComponentLookup<const LocalToWorld>();
+			for (std::uint32_t depth = 1; depth <= pEntityManager->GetMaxHierarchyDepth(); depth++)
+			{
+				Archetype levelArchetype = m_Archetype;
+				levelArchetype.AddType<Parent>();
+				levelArchetype.AddType(HierarchyDepth::GetTypeId(depth), 0, 1);
+
+				ExecuteForChunks(_pAsyncManager, pEntityManager->GetContainChunkList(levelArchetype),
+					[&parentLookup, lastVersion, currentVersion](Chunk* _pChunk) {
+						UpdateChildChunk(*_pChunk, parentLookup, lastVersion, currentVersion); });
+			}
+		}
+
+	private:
+		/**
+		* @brief チャンクごとに関数を並列に実行し、全て完了するまで待ちます。
+		*/
+		template <typename Func>
+		static void ExecuteForChunks(std::shared_ptr<AsyncFunctionManager> _pAsyncManager,
+			const std::vector<Chunk*>& _pChunkList, Func _func)
+		{
+			_pAsyncManager->ParallelFor(_pChunkList.size(), 1, [&_pChunkList, &_func](std::size_t _index) {
+				if (_pChunkList[_index]->GetSize() != 0)
+					_func(_pChunkList[_index]); });
+		}
+
+		/**
+		* @brief ルートのチャンクのLocalToWorldを求めます。
+		* @param _chunk 対象のチャンク。
+		* @param _lastVersion 前回の更新時の変更バージョン。
+		*/
+		static void UpdateRootChunk(Chunk& _chunk, const ChangeVersion _lastVersion)
+		{
+			const std::size_t localColumnIndex = _chunk.GetArchetype().GetComponentIndex<LocalTransform>() + 1;
+			if (_chunk.GetColumnVersion(localColumnIndex) <= _lastVersion)
+				return;
+
+			auto locals = _chunk.GetComponentList<const LocalTransform>();
+			auto worlds = _chunk.GetComponentList<LocalToWorld>();
+			for (std::uint32_t i = 0; i < _chunk.GetSize(); i++)
+			{
+				worlds[i].m_Matrix = locals[i].m_Matrix;
+			}
+		}
+
+		/**
+		* @brief 子のチャンクのLocalToWorldを求めます。
+		* @param _chunk 対象のチャンク。
+		* @param _parentLookup 親のLocalToWorldを引くためのキャッシュ。
+		* @param _lastVersion 前回の更新時の変更バージョン。
+		* @param _currentVersion この更新での変更バージョン。
+		*/
+		static void UpdateChildChunk(Chunk& _chunk, const ComponentLookup<const LocalToWorld>& _parentLookup,
+			const ChangeVersion _lastVersion, const ChangeVersion _currentVersion)
+		{
+			const Archetype& archetype = _chunk.GetArchetype();
+			const bool bChunkChanged =
+				_chunk.GetColumnVersion(archetype.GetComponentIndex<LocalTransform>() + 1) > _lastVersion ||
+				_chunk.GetColumnVersion(archetype.GetComponentIndex<Parent>() + 1) > _lastVersion;
+
+			auto parents = _chunk.GetComponentList<const Parent>();
+			auto locals = _chunk.GetComponentList<const LocalTransform>();
+			LocalToWorld* pWorlds = nullptr;
+			for (std::uint32_t i = 0; i < _chunk.GetSize(); i++)
+			{
+				const Entity& parent = parents[i].m_Entity;
+				// 自分も親も変わっていなければ計算しない
+				if (!bChunkChanged && _parentLookup.GetChangeVersion(parent) < _currentVersion)
+					continue;
+
+				// 書き込む場合だけ列を取得して、変更を記録する
+				if (!pWorlds)
+					pWorlds = _chunk.GetComponentList<LocalToWorld>().Begin();
+
+				const LocalToWorld* pParentWorld = _parentLookup.Get(parent);
+				pWorlds[i].m_Matrix = pParentWorld ?
+					locals[i].m_Matrix * pParentWorld->m_Matrix : locals[i].m_Matrix;
+			}
+		}
+
+	private:
+		//! 前回の更新時の変更バージョン。
+		ChangeVersion m_LastVersion = 0;
+	};
+}
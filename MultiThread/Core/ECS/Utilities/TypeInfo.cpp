@@ -1,3 +0,0 @@
-#include "typeinfo.h"
-
-std::size_t TypeManager::m_NextId = 1;
\ No newline at end of file
@@ -1,75 +1,137 @@
 #pragma once
 
-#include <typeinfo>
-#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+//! 型IDの型。型名のハッシュ値なので、実行ごと・プロセスごとに同じ値になる。
+using TypeId = std::uint64_t;
 
 /**
 * @class TypeManager
-* @brief ^ǗNX
+* @brief 型情報を管理するクラス
+* @note 型IDは型名からコンパイル時に求めるため、登録処理やスレッド間の同期は不要。
 */
 class TypeManager
 {
 public:
 	/**
-	* @brief RXgN^
-	* @note R|[lgIDm肳B
+	* @brief コンストラクタ
 	*/
 	TypeManager() {}
 
+private:
 	/**
-	* @class TypeInfo
-	* @brief ̌^̏ێNXB
+	* @brief コンパイラが出力する関数シグネチャから型名を切り出す。
+	* @tparam T 型名を取得する型。
+	* @return std::string_view 型名。
 	*/
 	template <typename T>
-	class TypeInfo
+	static constexpr std::string_view GetTypeName() noexcept
 	{
-	private:
-		//! ^ID
-		static std::size_t m_Id;
-		//! ^
-		static std::string m_szName;
+#if defined(_MSC_VER)
+		// 例: "... TypeManager::GetTypeName<struct ECS::Test::Component0>(void) noexcept"
+		constexpr std::string_view signature = __FUNCSIG__;
+		constexpr std::string_view prefix = "GetTypeName<";
+		constexpr std::size_t begin = signature.find(prefix) + prefix.size();
+		constexpr std::size_t end = signature.rfind('>');
+#else
+		// 例: "... TypeManager::GetTypeName() [with T = ECS::Test::Component0; ...]"
+		constexpr std::string_view signature = __PRETTY_FUNCTION__;
+		constexpr std::string_view prefix = "T = ";
+		constexpr std::size_t begin = signature.find(prefix) + prefix.size();
+		constexpr std::size_t end = signature.find(';', begin) != std::string_view::npos ?
+			signature.find(';', begin) : signature.rfind(']');
+#endif
+		return signature.substr(begin, end - begin);
+	}
 
-	private:
-		/**
-		* @brief ^o^B
-		*/
-		static inline void Register()
+	/**
+	* @brief 指定位置から始まる、ハッシュに含めない文字数を取得する。
+	* @param _name 型名。
+	* @param _pos 調べる位置。
+	* @return std::size_t 読み飛ばす文字数。読み飛ばさない場合は0。
+	* @note コンパイラ間の表記揺れ("struct "の有無や空白)を吸収するためのもの。
+	*/
+	static constexpr std::size_t GetSkipLength(std::string_view _name, std::size_t _pos) noexcept
+	{
+		if (_name[_pos] == ' ')
+			return 1;
+
+		// 識別子の途中であればキーワードではない
+		if (_pos > 0)
 		{
-			TypeInfo<T>::m_Id = TypeManager::m_NextId++;
-			TypeInfo<T>::m_szName = typeid(T).name();
+			const char prev = _name[_pos - 1];
+			if ((prev >= 'a' && prev <= 'z') || (prev >= 'A' && prev <= 'Z') ||
+				(prev >= '0' && prev <= '9') || prev == '_')
+				return 0;
 		}
 
-	public:
+		for (std::string_view keyword : { std::string_view("struct "),
+			std::string_view("class "), std::string_view("enum ") })
+		{
+			if (_name.substr(_pos, keyword.size()) == keyword)
+				return keyword.size();
+		}
+		return 0;
+	}
+
+	/**
+	* @brief 型名からFNV-1a(64bit)で型IDを求める。
+	* @param _name 型名。
+	* @return TypeId 型ID。
+	*/
+	static constexpr TypeId Hash(std::string_view _name) noexcept
+	{
+		TypeId hash = 14695981039346656037ull;
+		for (std::size_t i = 0; i < _name.size();)
+		{
+			if (const std::size_t skip = GetSkipLength(_name, i))
+			{
+				i += skip;
+				continue;
+			}
+			hash ^= static_cast<unsigned char>(_name[i]);
+			hash *= 1099511628211ull;
+			++i;
+		}
+		return hash;
+	}
+
+public:
+	/**
+	* @class TypeInfo
+	* @brief 特定の型の情報を保持するクラス。
+	* @note const/参照修飾は取り除いた型として扱う。
+	*/
+	template <typename T>
+	class TypeInfo
+	{
+	private:
+		//! 型名
+		static constexpr std::string_view mc_szName =
+			TypeManager::GetTypeName<std::remove_cvref_t<T>>();
+		//! 型ID
+		static constexpr TypeId mc_Id = TypeManager::Hash(mc_szName);
 
+	public:
 		/**
-		* @brief ^ID擾B
-		* @return const std::size_t& ^ID
+		* @brief 型IDを取得する。
+		* @return TypeId 型ID
 		*/
-		static inline const std::size_t& GetID()
+		static constexpr TypeId GetID() noexcept
 		{
-			if (TypeInfo<T>::m_Id == 0) Register();
-
-			return m_Id;
+			return mc_Id;
 		}
 
 		/**
-		* @brief ^擾B
-		* @return const std::string& ^
+		* @brief 型名を取得する。
+		* @return std::string_view 型名
 		*/
-		static inline const std::string& GetName()
+		static constexpr std::string_view GetName() noexcept
 		{
-			if (TypeInfo<T>::m_Id == 0) Register();
-			return m_szName;
+			return mc_szName;
 		}
 	};
-
-private:
-	//! Ɋ蓖Ă^ID
-	static std::size_t m_NextId;
 };
-
-template <typename T>
-std::size_t TypeManager::TypeInfo<T>::m_Id = 0;
-
-template <typename T>
-std::string TypeManager::TypeInfo<T>::m_szName;
\ No newline at end of file
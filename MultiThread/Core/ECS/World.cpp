@@ -2,11 +2,16 @@
 
 #include "EntityManager.h"
 #include "SystemBase.h"
+#include "ArchetypeLocks.h"
+#include "WorldFork.h"
 
 #include "EntityManager.h"
 
 #include "../../AsyncFunctionManager.h"
 #include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace ECS
 {
@@ -27,17 +32,197 @@ namespace ECS
 	}
 
 	/**
-	* @brief XVs܂B
-	* @param _deltaTime Ot[̌oߎԁB
+	* @brief 更新処理を行います。
+	* @param _deltaTime 前フレームからの経過時間。
 	*/
 	void World::Update(float _deltaTime)
 	{
-		for (auto systems : m_SystemList)
+		// このフレームの書き込みを前フレームと区別できるように変更バージョンを進める
+		GlobalChangeVersion::Advance();
+
+		for (std::size_t order = 0; order < m_SystemList.size(); order++)
+		{
+			SystemGroup& group = m_SystemGroups[order];
+			if (group.m_TickInterval <= 0.0f)
+			{
+				for (auto&& system : m_SystemList[order])
+				{
+					system->Update(_deltaTime, m_pAsyncFunctionManager);
+				}
+				continue;
+			}
+
+			// 固定の間隔で、積算した経過時間に追いつくまで更新する
+			group.m_Accumulator += _deltaTime;
+			std::uint32_t stepCount = 0;
+			while (group.m_Accumulator >= group.m_TickInterval && stepCount < group.m_MaxStepsPerUpdate)
+			{
+				for (auto&& system : m_SystemList[order])
+				{
+					system->Update(group.m_TickInterval, m_pAsyncFunctionManager);
+				}
+				group.m_Accumulator -= group.m_TickInterval;
+				stepCount++;
+			}
+
+			// 追いつけなかった分は捨てて、重いフレームの後に更新が連鎖しないようにする
+			if (group.m_Accumulator >= group.m_TickInterval)
+				group.m_Accumulator = std::fmod(group.m_Accumulator, group.m_TickInterval);
+		}
+
+		// 全てのシステムが読み終えた構成の変化の記録を捨てる
+		StructuralEventLog::Sequence eventCursor = (std::numeric_limits<StructuralEventLog::Sequence>::max)();
+		for (auto&& systems : m_SystemList)
+		{
+			for (auto&& system : systems)
+				eventCursor = (std::min)(eventCursor, system->GetStructuralEventCursor());
+		}
+		m_pEntityManager->TrimStructuralEvents(eventCursor);
+
+		ExtractRenderState();
+		CompressColdChunks();
+	}
+
+	/**
+	* @brief 描画処理を行います。
+	*/
+	void World::Draw()
+	{
+		const std::size_t frontIndex = m_FrontRenderStateIndex.load(std::memory_order_acquire);
+
+		m_RenderStateLocks[frontIndex].LockRead();
+		for (auto&& systems : m_SystemList)
 		{
 			for (auto&& system : systems)
 			{
-				system->Update(_deltaTime, m_pAsyncFunctionManager);
+				system->Draw(m_RenderStates[frontIndex]);
 			}
 		}
+		m_RenderStateLocks[frontIndex].UnlockRead();
+	}
+
+	/**
+	* @brief 描画用コンポーネントの列を、描画で読まれていない方の複製へ抽出して公開します。
+	*/
+	void World::ExtractRenderState()
+	{
+		if (m_RenderArchetype.GetArchetypeSize() == 0)
+			return;
+
+		// 抽出するのは描画で読まれていない方。描画中であれば終わるまで待つ
+		const std::size_t backIndex = 1 - m_FrontRenderStateIndex.load(std::memory_order_relaxed);
+
+		m_RenderStateLocks[backIndex].LockWrite();
+		m_RenderStates[backIndex].Extract(m_ChunkList, m_RenderArchetype, m_StateEpoch, *m_pAsyncFunctionManager);
+		m_RenderStateLocks[backIndex].UnlockWrite();
+
+		m_FrontRenderStateIndex.store(backIndex, std::memory_order_release);
+	}
+
+	void World::SetColdArchetype(const Archetype& _archetype, const bool _bCold)
+	{
+		auto it = std::find(m_ColdArchetypes.begin(), m_ColdArchetypes.end(), _archetype);
+		if (_bCold)
+		{
+			if (it == m_ColdArchetypes.end())
+				m_ColdArchetypes.push_back(_archetype);
+			return;
+		}
+		if (it == m_ColdArchetypes.end())
+			return;
+		m_ColdArchetypes.erase(it);
+
+		// 他の設定で対象のままのチャンクも一度展開し、触れられないままなら改めて圧縮する
+		m_ArchetypeTable.ForEachMatch(m_ArchetypeTable.CreateQuery(_archetype),
+			[this](ArchetypeTable::ArchetypeIndex _archetypeIndex)
+			{
+				for (auto&& chunkIndex : m_ArchetypeTable.GetChunkIndices(_archetypeIndex))
+					m_ChunkList[chunkIndex].Decompress();
+			});
+	}
+
+	void World::CompressColdChunks()
+	{
+		if (m_ColdArchetypes.empty())
+			return;
+
+		// 圧縮の対象のアーキタイプのチャンクから、しばらく触れられていないものを集める
+		const ChangeVersion version = GlobalChangeVersion::Get();
+		m_pColdChunkCache.clear();
+		for (auto&& coldArchetype : m_ColdArchetypes)
+		{
+			m_ArchetypeTable.ForEachMatch(m_ArchetypeTable.CreateQuery(coldArchetype),
+				[this, version](ArchetypeTable::ArchetypeIndex _archetypeIndex)
+				{
+					for (auto&& chunkIndex : m_ArchetypeTable.GetChunkIndices(_archetypeIndex))
+					{
+						Chunk& chunk = m_ChunkList[chunkIndex];
+						if (m_pColdChunkCache.size() < mc_ColdCompressChunksPerUpdate && !chunk.IsCompressed() &&
+							version - chunk.GetLastTouchedVersion() >= mc_ColdIdleUpdateCount)
+							m_pColdChunkCache.push_back(&chunk);
+					}
+				});
+		}
+
+		// 複数の設定に一致したチャンクは1度だけ圧縮する
+		std::sort(m_pColdChunkCache.begin(), m_pColdChunkCache.end());
+		m_pColdChunkCache.erase(std::unique(m_pColdChunkCache.begin(), m_pColdChunkCache.end()), m_pColdChunkCache.end());
+
+		m_pAsyncFunctionManager->ParallelFor(m_pColdChunkCache.size(), 1, [this](std::size_t _index) {
+			m_pColdChunkCache[_index]->Compress(); });
+	}
+
+	WorldFork World::Fork() const
+	{
+		WorldFork fork;
+		fork.Capture(*this);
+		return fork;
+	}
+
+	void World::Rollback(const WorldFork& _fork)
+	{
+		_fork.Restore(*this);
+	}
+
+	ArchetypeReadScope::ArchetypeReadScope(World& _world, const Archetype& _archetype)
+	{
+		ArchetypeQuery query;
+		Acquire(_world, _archetype, query);
+	}
+
+	ArchetypeReadScope::ArchetypeReadScope(World& _world, const Archetype& _archetype,
+		std::vector<Chunk*>& _chunkList, ArchetypeQuery& _query, std::vector<ScalableReadWriteLock*>& _readLocks)
+		: m_pReadLocks(&_readLocks), m_pResult(&_chunkList)
+	{
+		Acquire(_world, _archetype, _query);
+	}
+
+	void ArchetypeReadScope::Acquire(World& _world, const Archetype& _archetype, ArchetypeQuery& _query)
+	{
+		ArchetypeLocks& locks = _world.m_ArchetypeLocks;
+		const ArchetypeTable& table = _world.m_ArchetypeTable;
+		m_pResult->clear();
+		m_pReadLocks->clear();
+
+		// アーキタイプ表を引く間だけ構成ロックを取る。対象のロックを取った後は他の構成の変更を妨げない
+		if (locks.m_bEnabled)
+			locks.m_StructureLock.LockRead();
+
+		// 一致するアーキタイプはインデックスの昇順に来るので、書き込み側と同じ順にロックを取れる
+		table.CreateQuery(_archetype, _query);
+		table.ForEachMatch(_query, [&](ArchetypeTable::ArchetypeIndex _archetypeIndex)
+			{
+				if (locks.m_bEnabled)
+				{
+					ScalableReadWriteLock& lock = locks.GetLock(_archetypeIndex);
+					lock.LockRead();
+					m_pReadLocks->push_back(&lock);
+				}
+				for (auto&& chunkIndex : table.GetChunkIndices(_archetypeIndex))
+					m_pResult->push_back(&_world.m_ChunkList[chunkIndex]);
+			});
+
+		if (locks.m_bEnabled)
+			locks.m_StructureLock.UnlockRead();
 	}
-}
\ No newline at end of file
+}
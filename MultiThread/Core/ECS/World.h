@@ -2,7 +2,16 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
 #include "Chunk.h"
+#include "ArchetypeTable.h"
+#include "RenderState.h"
+#include "ArchetypeLocks.h"
+#include "SparseSet.h"
+#include "../../ReadWriteLock.h"
 
 class AsyncFunctionManager;
 
@@ -10,44 +19,120 @@ namespace ECS
 {
 	class SystemBase;
 	class EntityManager;
+	class WorldSnapshot;
+	class MemoryReport;
+	class WorldSection;
+	class WorldFork;
+	class DeltaEncoder;
+	class DeltaDecoder;
+	class EntitySpawner;
+	template <typename> class ComponentLookup;
 
 	class World
 	{
 		friend EntityManager;
+		friend WorldSnapshot;
+		friend MemoryReport;
+		friend WorldSection;
+		friend WorldFork;
+		friend DeltaEncoder;
+		friend DeltaDecoder;
+		friend ArchetypeReadScope;
+		template <typename> friend class ComponentLookup;
 	public:
 		World();
 		~World();
 
 		/**
-		* @brief s܂B
+		* @brief 初期化処理を行います。
 		*/
 		virtual void Init();
 
 		/**
-		* @brief XVs܂B
-		* @param _deltaTime Ot[̌oߎԁB
+		* @brief 更新処理を行います。
+		* @param _deltaTime 前フレームからの経過時間。
 		*/
 		void Update(float _deltaTime);
 
 		/**
-		* @brief `揈s܂B
+		* @brief 描画処理を行います。
+		* @note 最後に抽出された描画用の複製を読むので、別スレッドから次のUpdateと並行して呼び出せる。
 		*/
 		void Draw();
 
+		/**
+		* @brief Updateの最後に描画用の複製へ抽出するコンポーネントを登録します。
+		* @tparam CompTs 描画で読み取るコンポーネントの型。
+		* @note Updateと並行して呼び出さないこと。
+		*/
+		template <typename... CompTs>
+		void AddRenderComponents()
+		{
+			static_assert((std::is_trivially_copyable_v<CompTs> && ...),
+				"Render components must be trivially copyable.");
+			(m_RenderArchetype.AddType<CompTs>(), ...);
+		}
+
 		template <typename SystemT>
 		void AddSystem(const std::size_t& _updateOrder)
 		{
-			std::size_t size = _updateOrder - m_SystemList.size();
-			if (size > 0 || !m_SystemList.size())
+			if (_updateOrder >= m_SystemList.size())
 			{
 				m_SystemList.resize(_updateOrder + 1);
+				m_SystemGroups.resize(_updateOrder + 1);
 			}
 
 			m_SystemList[_updateOrder].push_back(std::make_shared<SystemT>(this,
-				TypeManager::TypeInfo<SystemT>().GetID()));
+				TypeManager::TypeInfo<SystemT>::GetID()));
 			m_SystemList[_updateOrder].back()->Init();
 		}
 
+		/**
+		* @brief 追加済みのシステムを取得します。
+		* @tparam SystemT 取得するシステムの型。
+		* @return SystemT* システムのポインタ。追加されていない場合はnullptr。
+		* @note 他のシステムが提供するデータ(空間インデックスなど)を参照するときに使う。
+		*/
+		template <typename SystemT>
+		SystemT* GetSystem()
+		{
+			for (auto&& systems : m_SystemList)
+			{
+				for (auto&& system : systems)
+				{
+					if (system->GetSystemId() == TypeManager::TypeInfo<SystemT>::GetID())
+						return static_cast<SystemT*>(system.get());
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		* @brief 更新順が同じシステムのグループを、固定の間隔で更新するように設定します。
+		* @param _updateOrder 対象のグループの更新順。
+		* @param _tickInterval 更新の間隔。Updateに渡す経過時間と同じ単位。0以下で毎回更新する。
+		* @param _maxStepsPerUpdate 1回のUpdateで追いつくために更新する最大の回数。超えた分の遅れは捨てる。
+		* @note 経過時間を積算し、間隔に達するたびに間隔を経過時間として渡して更新する。
+		*		 同じ間隔のグループが同じフレームに重ならないように、設定した順に位相をずらす。
+		*/
+		void SetSystemGroupRate(const std::size_t _updateOrder, const float _tickInterval,
+			const std::uint32_t _maxStepsPerUpdate = 4)
+		{
+			if (_updateOrder >= m_SystemList.size())
+			{
+				m_SystemList.resize(_updateOrder + 1);
+				m_SystemGroups.resize(_updateOrder + 1);
+			}
+
+			SystemGroup& group = m_SystemGroups[_updateOrder];
+			group.m_TickInterval = _tickInterval;
+			group.m_MaxStepsPerUpdate = _maxStepsPerUpdate == 0 ? 1 : _maxStepsPerUpdate;
+
+			// 黄金比の倍数の小数部で位相を決めると、グループがいくつでも間隔の中に均等に散らばる
+			const float phase = static_cast<float>(m_RateGroupCount++) * 0.6180339887f;
+			group.m_Accumulator = (phase - std::floor(phase)) * (std::max)(_tickInterval, 0.0f);
+		}
+
 		void ChangeUpdateOrder(
 			const std::size_t& _oldUpdateOrder,
 			const int& _oldVecIndex,
@@ -66,10 +151,130 @@ namespace ECS
 			return m_pEntityManager;
 		}
 
+		/**
+		* @brief アーキタイプごとのロックを取得します。
+		* @return ArchetypeLocks& ロック。有効にすると、構成の変更とArchetypeReadScopeの読み取りが並行できる。
+		*/
+		ArchetypeLocks& GetArchetypeLocks() noexcept
+		{
+			return m_ArchetypeLocks;
+		}
+
+		/**
+		* @brief 疎な集合に格納するコンポーネントの集合を取得します。なければ作る。
+		* @tparam CompT コンポーネントの型。
+		* @return SparseSet<CompT>& 集合。
+		* @note 集合の作成と変更はスレッドセーフではない。システムのジョブからは読み取りと、
+		*		 エンティティごとのコンポーネントの書き換えだけを行うこと。
+		*/
+		template <SparseComponent CompT>
+		SparseSet<std::remove_cvref_t<CompT>>& GetSparseSet()
+		{
+			using SetT = SparseSet<std::remove_cvref_t<CompT>>;
+			auto& pSet = m_SparseSets[TypeManager::TypeInfo<CompT>::GetID()];
+			if (!pSet)
+				pSet = std::make_unique<SetT>();
+			return static_cast<SetT&>(*pSet);
+		}
+
+		/**
+		* @brief 疎な集合に格納するコンポーネントの集合を取得します。
+		* @tparam CompT コンポーネントの型。
+		* @return SparseSet<CompT>* 集合。まだ作られていない場合はnullptr。
+		*/
+		template <SparseComponent CompT>
+		SparseSet<std::remove_cvref_t<CompT>>* FindSparseSet() const
+		{
+			auto it = m_SparseSets.find(TypeManager::TypeInfo<CompT>::GetID());
+			return it != m_SparseSets.end() ?
+				static_cast<SparseSet<std::remove_cvref_t<CompT>>*>(it->second.get()) : nullptr;
+		}
+
+		/**
+		* @brief アーキタイプを含むチャンクを、使われていない間は圧縮するように設定します。
+		* @param _archetype 対象のアーキタイプ。全ての型を含むアーキタイプのチャンクが対象で、後から作られるチャンクも含む。
+		* @param _bCold trueで圧縮の対象にする。falseで対象から外し、圧縮済みのチャンクを展開する。
+		* @note 圧縮はUpdateの最後に、mc_ColdIdleUpdateCount回のUpdateの間書き込みも展開もされなかった
+		*		 チャンクに対してジョブで行う。圧縮したチャンクはクエリや参照で触れたときに展開する。
+		*		 毎フレーム触れるシステムがあるアーキタイプは圧縮されない。Updateと並行して呼び出さないこと。
+		*		 ForkやRollbackRingで保持している状態とメモリ領域を共有しているチャンクも圧縮されないので、
+		*		 毎フレーム状態を保持している間は、保持より前から書き込まれていないチャンクは圧縮されない。
+		*/
+		void SetColdArchetype(const Archetype& _archetype, const bool _bCold);
+
+		/**
+		* @brief ワールドの今の状態を分岐させます。
+		* @return WorldFork 分岐した状態。チャンクのメモリ領域は複製せずに共有し、書き込んだ側で複製する。
+		* @note 毎フレーム保持する場合は、RollbackRingかWorldFork::Captureで保持場所を使い回す。
+		*		 Updateと並行して呼び出さないこと。
+		*/
+		WorldFork Fork() const;
+
+		/**
+		* @brief ワールドを分岐した時点の状態に戻します。
+		* @param _fork 戻す状態。戻した後も残るので、同じ状態に何度でも戻せる。
+		* @note Updateと並行して呼び出さないこと。
+		*/
+		void Rollback(const WorldFork& _fork);
+
+	private:
+		/**
+		* @brief 描画用コンポーネントの列を、描画で読まれていない方の複製へ抽出して公開します。
+		*/
+		void ExtractRenderState();
+
+		/**
+		* @brief 圧縮の対象のアーキタイプで、しばらく触れられていないチャンクを圧縮します。
+		*/
+		void CompressColdChunks();
+
+		/**
+		* @struct SystemGroup
+		* @brief 更新順が同じシステムのグループの更新間隔。
+		*/
+		struct SystemGroup
+		{
+			//! 更新の間隔。0以下で毎回更新する。
+			float m_TickInterval = 0.0f;
+			//! 前回の更新から積算した経過時間。
+			float m_Accumulator = 0.0f;
+			//! 1回のUpdateで更新する最大の回数。
+			std::uint32_t m_MaxStepsPerUpdate = 4;
+		};
+
 	protected:
-		std::vector<Chunk> m_ChunkList;
+		ChunkList m_ChunkList;
+		ArchetypeTable m_ArchetypeTable;
+		//! アーキタイプごとのロック。
+		ArchetypeLocks m_ArchetypeLocks;
+		//! 型IDごとの、疎な集合に格納するコンポーネントの集合。
+		std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>> m_SparseSets;
+		//! 使われていない間は圧縮するアーキタイプ。
+		std::vector<Archetype> m_ColdArchetypes;
+		//! 圧縮するチャンクのリスト。毎フレームの確保を避けるために使い回す。
+		std::vector<Chunk*> m_pColdChunkCache;
+		//! 次に取り込むセクションに割り当てる識別ID。
+		SectionId m_NextSectionId = 1;
+		//! アーキタイプとチャンクを丸ごと置き換えた回数。それらのインデックスを持つキャッシュが古くなったかの判定に使う。
+		std::uint64_t m_StateEpoch = 0;
 		std::vector<std::vector<std::shared_ptr<SystemBase>>> m_SystemList;
+		//! 更新順ごとのグループの更新間隔。m_SystemListと同じ数。
+		std::vector<SystemGroup> m_SystemGroups;
+		//! 間隔を設定したグループの数。位相をずらすのに使う。
+		std::uint32_t m_RateGroupCount = 0;
 		std::shared_ptr<EntityManager> m_pEntityManager;
 		std::shared_ptr<AsyncFunctionManager> m_pAsyncFunctionManager;
+		//! 描画用に抽出するコンポーネント。
+		Archetype m_RenderArchetype;
+		//! 描画用の複製。抽出と描画で交互に使う。
+		RenderState m_RenderStates[2];
+		//! 描画用の複製ごとのロック。描画中の複製には抽出しない。
+		ReadWriteLock m_RenderStateLocks[2];
+		//! 描画で読む複製のインデックス。
+		std::atomic<std::size_t> m_FrontRenderStateIndex = 0;
+		//! 圧縮するまでに、チャンクが触れられずに経過する必要があるUpdateの回数。
+		static constexpr ChangeVersion mc_ColdIdleUpdateCount = 120;
+		//! 1回のUpdateで圧縮するチャンクの最大数。
+		static constexpr std::size_t mc_ColdCompressChunksPerUpdate = 256;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "WorldFork.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <numeric>
+
+#include "World.h"
+#include "EntityManager.h"
+#include "ArchetypeLocks.h"
+
+namespace ECS
+{
+	void WorldFork::Capture(const World& _world)
+	{
+		// チャンクはメモリ領域を共有するので、複製するのは管理情報だけ
+		m_ChunkList = _world.m_ChunkList;
+		m_ArchetypeTable = _world.m_ArchetypeTable;
+		CopySparseSets(_world.m_SparseSets, m_SparseSets);
+		m_NextSectionId = _world.m_NextSectionId;
+
+		const EntityManager& entityManager = *_world.m_pEntityManager;
+		m_EntityDirectory.CopyFrom(entityManager.m_EntityDirectory);
+		m_vRecycleEntityIndices = entityManager.m_vRecycleEntityIndices;
+		m_NextEntityIndex = entityManager.m_NextEntityIndex.load();
+		CopyChildren(entityManager.m_Children, m_Children);
+		m_MaxHierarchyDepth = entityManager.m_MaxHierarchyDepth;
+		m_bValid = true;
+	}
+
+	void WorldFork::Restore(World& _world) const
+	{
+		if (!m_bValid)
+			std::abort();
+
+		StructureWriteScope structureScope(_world.m_ArchetypeLocks);
+		_world.m_ChunkList = m_ChunkList;
+		_world.m_ArchetypeTable = m_ArchetypeTable;
+		CopySparseSets(m_SparseSets, _world.m_SparseSets);
+		_world.m_NextSectionId = m_NextSectionId;
+		// 分岐後に作られたアーキタイプとチャンクのインデックスは、戻した後に別のものが使う
+		_world.m_StateEpoch++;
+
+		// 戻した内容は分岐後に書き込まれた内容と異なるので、全て変更として拾わせる。
+		// 描画の抽出などが記録済みのバージョンと重ならないよう、先にバージョンを進める
+		GlobalChangeVersion::Advance();
+		for (auto&& chunk : _world.m_ChunkList)
+			chunk.MarkStructureChanged();
+
+		EntityManager& entityManager = *_world.m_pEntityManager;
+		entityManager.m_EntityDirectory.CopyFrom(m_EntityDirectory);
+		entityManager.m_vRecycleEntityIndices = m_vRecycleEntityIndices;
+		// 分岐後の記録は戻した内容と食い違うので、全ての要素を変更として記録し直す
+		std::vector<EntityIndex>& changedEntities = entityManager.m_vChangedEntityIndices;
+		changedEntities.clear();
+		if (entityManager.m_bRecordEntityChanges)
+		{
+			changedEntities.resize(entityManager.m_EntityDirectory.GetSize());
+			std::iota(changedEntities.begin(), changedEntities.end(), EntityIndex(0));
+		}
+		CopyChildren(m_Children, entityManager.m_Children);
+		entityManager.m_MaxHierarchyDepth = m_MaxHierarchyDepth;
+		entityManager.m_NextEntityIndex.store(m_NextEntityIndex);
+
+		// 記録は戻す前のエンティティを指しているので使えない
+		entityManager.m_StructuralEvents.Clear();
+	}
+
+	void WorldFork::Clear()
+	{
+		m_ChunkList.clear();
+		m_ArchetypeTable = ArchetypeTable();
+		m_EntityDirectory.Clear();
+		m_vRecycleEntityIndices.clear();
+		m_NextEntityIndex = 0;
+		m_Children.clear();
+		m_MaxHierarchyDepth = 0;
+		m_SparseSets.clear();
+		m_NextSectionId = 1;
+		m_bValid = false;
+	}
+
+	void WorldFork::CopySparseSets(const std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>>& _source,
+		std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>>& _destination)
+	{
+		for (auto&& [typeId, pSet] : _destination)
+		{
+			if (!_source.contains(typeId))
+				pSet->Clear();
+		}
+		for (auto&& [typeId, pSet] : _source)
+		{
+			auto it = _destination.find(typeId);
+			if (it == _destination.end())
+				_destination.emplace(typeId, pSet->Clone());
+			else
+				it->second->CopyFrom(*pSet);
+		}
+	}
+
+	void WorldFork::CopyChildren(const std::unordered_map<EntityIndex, std::vector<Entity>>& _source,
+		std::unordered_map<EntityIndex, std::vector<Entity>>& _destination)
+	{
+		// 子を持たない親を残すと子を持つ扱いになるので、複製元にない親は取り除く
+		std::erase_if(_destination, [&_source](const auto& _pair) { return !_source.contains(_pair.first); });
+		for (auto&& [parentIndex, children] : _source)
+			_destination[parentIndex] = children;
+	}
+
+	RollbackRing::RollbackRing(const std::size_t _frameCount)
+		: m_Slots((std::max)(_frameCount, std::size_t(1)))
+	{
+	}
+
+	void RollbackRing::Save(const World& _world, const Frame _frame)
+	{
+		Slot& slot = m_Slots[_frame % m_Slots.size()];
+		slot.m_Fork.Capture(_world);
+		slot.m_Frame = _frame;
+	}
+
+	bool RollbackRing::Rollback(World& _world, const Frame _frame)
+	{
+		if (!Contains(_frame))
+			return false;
+
+		m_Slots[_frame % m_Slots.size()].m_Fork.Restore(_world);
+
+		// 戻したフレームより後は再計算で保持し直すので、古い方の状態を残さない
+		for (auto&& slot : m_Slots)
+		{
+			if (slot.m_Fork.IsValid() && slot.m_Frame > _frame)
+				slot.m_Fork.Clear();
+		}
+		return true;
+	}
+
+	bool RollbackRing::Contains(const Frame _frame) const noexcept
+	{
+		const Slot& slot = m_Slots[_frame % m_Slots.size()];
+		return slot.m_Fork.IsValid() && slot.m_Frame == _frame;
+	}
+
+	void RollbackRing::Clear()
+	{
+		for (auto&& slot : m_Slots)
+			slot.m_Fork.Clear();
+	}
+}
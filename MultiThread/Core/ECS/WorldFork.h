@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "Common/Id.h"
+#include "Entity.h"
+#include "Chunk.h"
+#include "ArchetypeTable.h"
+#include "EntityDirectory.h"
+#include "SparseSet.h"
+
+namespace ECS
+{
+	class World;
+
+	/**
+	* @class WorldFork
+	* @brief ワールドのある時点の状態を、チャンクのメモリ領域を共有したまま保持するクラス。
+	* @note 複製するのはチャンクの管理情報とエンティティ配列などの管理情報だけで、コンポーネントは
+	*		 複製しない。分岐後にワールドかこの状態のどちらかが書き込んだチャンクだけが、
+	*		 書き込む側で複製される。疎な集合に格納するコンポーネントは丸ごと複製する。
+	*		 システムと描画用の複製は含まない。
+	*/
+	class WorldFork
+	{
+	public:
+		/**
+		* @brief 状態を保持しているかどうかを取得します。
+		* @return bool 保持している場合はtrue。
+		*/
+		bool IsValid() const noexcept
+		{
+			return m_bValid;
+		}
+
+		/**
+		* @brief 保持しているチャンクの数を取得します。
+		* @return std::size_t チャンクの数。
+		*/
+		std::size_t GetChunkCount() const noexcept
+		{
+			return m_ChunkList.size();
+		}
+
+		/**
+		* @brief ワールドの今の状態を保持します。保持していた状態は捨てる。
+		* @param _world 対象のワールド。Updateと並行して呼び出さないこと。
+		* @note 保持していた状態の配列は使い回すので、毎フレーム同じ状態に上書きしても確保はほとんど起きない。
+		*/
+		void Capture(const World& _world);
+
+		/**
+		* @brief ワールドを保持している状態に戻します。保持している状態はそのまま残る。
+		* @param _world 対象のワールド。Updateと並行して呼び出さないこと。
+		* @note 戻した後のチャンクは全て構成が変わった扱いにするので、変更を見るシステムや描画用の抽出は
+		*		 戻した分を拾い直す。構成の変化の記録は捨てる。
+		*/
+		void Restore(World& _world) const;
+
+		/**
+		* @brief 保持している状態を捨てます。共有していたメモリ領域は、他から参照されていなければ解放される。
+		*/
+		void Clear();
+
+	private:
+		/**
+		* @brief 疎な集合を複製します。
+		* @param _source 複製元。
+		* @param _destination 複製先。中身は置き換える。
+		* @note 複製先にある集合は使い回し、複製元にない型の集合は空にして残す。
+		*/
+		static void CopySparseSets(const std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>>& _source,
+			std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>>& _destination);
+
+		/**
+		* @brief 親のインデックスから子への対応を複製します。
+		* @param _source 複製元。
+		* @param _destination 複製先。中身は置き換える。
+		* @note 両方にある親の子の配列は使い回す。
+		*/
+		static void CopyChildren(const std::unordered_map<EntityIndex, std::vector<Entity>>& _source,
+			std::unordered_map<EntityIndex, std::vector<Entity>>& _destination);
+
+	private:
+		//! チャンク。メモリ領域は分岐元と共有する。
+		ChunkList m_ChunkList;
+		//! アーキタイプとチャンクの対応。
+		ArchetypeTable m_ArchetypeTable;
+		//! エンティティの管理情報。
+		EntityDirectory m_EntityDirectory;
+		//! 再利用するエンティティのインデックス。
+		std::vector<std::uint32_t> m_vRecycleEntityIndices;
+		//! 次に割り当てるエンティティのインデックス。
+		EntityIndex m_NextEntityIndex = 0;
+		//! 親のインデックスから子への対応。
+		std::unordered_map<EntityIndex, std::vector<Entity>> m_Children;
+		//! 階層の最大の深さ。
+		std::uint32_t m_MaxHierarchyDepth = 0;
+		//! 型IDごとの疎な集合。
+		std::unordered_map<TypeId, std::unique_ptr<SparseSetBase>> m_SparseSets;
+		//! 次に取り込むセクションに割り当てる識別ID。
+		SectionId m_NextSectionId = 1;
+		//! 状態を保持しているかどうか。
+		bool m_bValid = false;
+	};
+
+	/**
+	* @class RollbackRing
+	* @brief 直近の一定フレーム数分のワールドの状態を保持し、過去のフレームに巻き戻すクラス。
+	* @note ロールバック方式の通信で、遅れて届いた入力を反映するために使う。毎フレームSaveで
+	*		 状態を保持し、入力の食い違いが分かったらRollbackで戻して再計算する。
+	*		 チャンクはWorldForkで共有するので、1フレーム分の保持にかかるのは管理情報の複製と、
+	*		 そのフレームで書き込んだチャンクの複製だけ。
+	*		 保持している間は、書き込まれていないチャンクのメモリ領域が共有されたままなので、
+	*		 World::SetColdArchetypeによる圧縮の対象にならない。
+	*/
+	class RollbackRing
+	{
+	public:
+		//! フレーム番号の型。
+		using Frame = std::uint64_t;
+
+	public:
+		/**
+		* @brief コンストラクタ
+		* @param _frameCount 保持するフレーム数。0の場合は1として扱う。
+		*/
+		explicit RollbackRing(const std::size_t _frameCount);
+
+		/**
+		* @brief ワールドの今の状態を、フレーム番号に対応付けて保持します。
+		* @param _world 対象のワールド。
+		* @param _frame フレーム番号。保持するフレーム数だけ前の状態は上書きされる。
+		*/
+		void Save(const World& _world, const Frame _frame);
+
+		/**
+		* @brief ワールドを指定のフレームの状態に戻します。
+		* @param _world 対象のワールド。
+		* @param _frame 戻すフレーム番号。
+		* @return bool 戻した場合はtrue。保持していないフレームの場合はfalseで、ワールドは変えない。
+		* @note 戻したフレームより後の状態は捨てる。戻したフレームの状態は残るので、何度でも戻せる。
+		*/
+		bool Rollback(World& _world, const Frame _frame);
+
+		/**
+		* @brief 指定のフレームの状態を保持しているかどうかを取得します。
+		* @param _frame フレーム番号。
+		* @return bool 保持している場合はtrue。
+		*/
+		bool Contains(const Frame _frame) const noexcept;
+
+		/**
+		* @brief 保持している状態を全て捨てます。
+		*/
+		void Clear();
+
+		/**
+		* @brief 保持するフレーム数を取得します。
+		* @return std::size_t フレーム数。
+		*/
+		std::size_t GetFrameCount() const noexcept
+		{
+			return m_Slots.size();
+		}
+
+	private:
+		/**
+		* @struct Slot
+		* @brief 1フレーム分の保持場所。
+		*/
+		struct Slot
+		{
+			//! 保持している状態のフレーム番号。
+			Frame m_Frame = 0;
+			//! 保持している状態。
+			WorldFork m_Fork;
+		};
+
+		//! フレーム番号を保持するフレーム数で割った余りの位置に保持する。
+		std::vector<Slot> m_Slots;
+	};
+}
@@ -0,0 +1,225 @@
+#include "WorldSection.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "World.h"
+#include "EntityManager.h"
+#include "EntityDirectory.h"
+#include "Chunk.h"
+#include "Transform.h"
+
+namespace ECS
+{
+	SectionId WorldSection::Merge(World& _world, World& _staging)
+	{
+		std::vector<std::uint32_t> chunkIndices(_staging.m_ChunkList.size());
+		std::iota(chunkIndices.begin(), chunkIndices.end(), 0u);
+
+		std::unordered_map<EntityIndex, Entity> remap;
+		const SectionId sectionId = _world.m_NextSectionId;
+		const std::size_t count = TransferChunks(_staging, chunkIndices, _world, sectionId, remap);
+
+		// チャンクのメモリ領域は取り込み先に移ったので、作業用のワールドには空のチャンクだけが残る
+		ClearWorld(_staging);
+		if (count == 0)
+			return 0;
+
+		_world.m_NextSectionId++;
+		return sectionId;
+	}
+
+	std::size_t WorldSection::Detach(World& _world, const SectionId _sectionId, World& _destination)
+	{
+		if (_sectionId == 0)
+			return 0;
+
+		EntityManager& entityManager = *_world.m_pEntityManager;
+		StructureWriteScope structureScope(_world.m_ArchetypeLocks);
+
+		std::vector<std::uint32_t> chunkIndices;
+		for (std::uint32_t i = 0; i < _world.m_ChunkList.size(); i++)
+		{
+			if (_world.m_ChunkList[i].GetSectionId() == _sectionId && _world.m_ChunkList[i].GetSize() > 0)
+				chunkIndices.push_back(i);
+		}
+		if (chunkIndices.empty())
+			return 0;
+
+		// Entityの列は移すときに書き換わるので、インデックスは先に集めておく
+		std::vector<EntityIndex> entityIndices;
+		for (const std::uint32_t chunkIndex : chunkIndices)
+		{
+			const Chunk& chunk = _world.m_ChunkList[chunkIndex];
+			for (std::uint32_t row = 0; row < chunk.GetSize(); row++)
+				entityIndices.push_back(GetIndex(chunk.GetEntity(row).m_Identifier));
+		}
+
+		//=== 親子関係を切る。セクション外に残る子はルートにする
+		const auto isInSection = [&](const Entity& _entity)
+			{
+				const std::uint32_t chunkIndex = entityManager.m_EntityDirectory[GetIndex(_entity.m_Identifier)].GetChunkIndex();
+				return _world.m_ChunkList[chunkIndex].GetSectionId() == _sectionId;
+			};
+		for (const EntityIndex entityIndex : entityIndices)
+		{
+			auto it = entityManager.m_Children.find(entityIndex);
+			if (it != entityManager.m_Children.end())
+			{
+				const std::vector<Entity> children = it->second;
+				for (auto&& child : children)
+				{
+					if (!isInSection(child))
+						entityManager.RemoveParent(child);
+				}
+				entityManager.m_Children.erase(entityIndex);
+			}
+			entityManager.DetachFromParent(entityIndex);
+		}
+
+		// 読む側には破棄として見せる
+		for (const std::uint32_t chunkIndex : chunkIndices)
+		{
+			const Chunk& chunk = _world.m_ChunkList[chunkIndex];
+			entityManager.RecordStructuralEvent(_world.m_ArchetypeTable.GetArchetypeIndexOfChunk(chunkIndex),
+				ArchetypeTable::cInvalidIndex, &chunk.GetEntity(0), chunk.GetSize());
+		}
+
+		std::unordered_map<EntityIndex, Entity> remap;
+		const std::size_t count = TransferChunks(_world, chunkIndices, _destination, 0, remap);
+
+		//=== 切り離したエンティティは破棄した扱いにする
+		for (const EntityIndex entityIndex : entityIndices)
+		{
+			EntityDirectory::Record& record = entityManager.m_EntityDirectory[entityIndex];
+			record.SetVersion(EntityDirectory::Record::NextVersion(record.GetVersion()));
+			entityManager.RecordEntityChange(entityIndex);
+			entityManager.m_vRecycleEntityIndices.push_back(entityIndex);
+			for (auto&& [typeId, pSet] : _world.m_SparseSets)
+				pSet->Remove(entityIndex);
+		}
+
+		// チャンクの場所は、同じアーキタイプの空のチャンクで埋めて再利用する
+		for (const std::uint32_t chunkIndex : chunkIndices)
+		{
+			ArchetypeWriteScope archetypeScope(_world.m_ArchetypeLocks,
+				_world.m_ArchetypeTable.GetArchetypeIndexOfChunk(chunkIndex));
+			Chunk& chunk = _world.m_ChunkList[chunkIndex];
+			chunk = Chunk(chunk.GetArchetype());
+		}
+		return count;
+	}
+
+	std::size_t WorldSection::TransferChunks(World& _source, const std::vector<std::uint32_t>& _chunkIndices,
+		World& _destination, const SectionId _sectionId, std::unordered_map<EntityIndex, Entity>& _remap)
+	{
+		const EntityDirectory& sourceDirectory = _source.m_pEntityManager->m_EntityDirectory;
+		EntityManager& entityManager = *_destination.m_pEntityManager;
+		ArchetypeTable& table = _destination.m_ArchetypeTable;
+		StructureWriteScope structureScope(_destination.m_ArchetypeLocks);
+
+		std::size_t rowCount = 0;
+		for (const std::uint32_t chunkIndex : _chunkIndices)
+			rowCount += _source.m_ChunkList[chunkIndex].GetSize();
+		_remap.reserve(rowCount);
+		if (entityManager.m_vRecycleEntityIndices.size() < rowCount)
+		{
+			entityManager.m_EntityDirectory.Reserve(entityManager.m_EntityDirectory.GetSize() +
+				rowCount - entityManager.m_vRecycleEntityIndices.size());
+		}
+
+		//=== チャンクのメモリ領域ごと引き取り、Entityの列をその場で移し先のエンティティに書き換える
+		std::vector<std::uint32_t> adoptedChunkIndices;
+		adoptedChunkIndices.reserve(_chunkIndices.size());
+		for (const std::uint32_t sourceChunkIndex : _chunkIndices)
+		{
+			Chunk& sourceChunk = _source.m_ChunkList[sourceChunkIndex];
+			if (sourceChunk.GetSize() == 0)
+				continue;
+
+			const ArchetypeTable::ArchetypeIndex archetypeIndex =
+				table.GetOrCreateArchetype(sourceChunk.GetArchetype());
+			ArchetypeWriteScope archetypeScope(_destination.m_ArchetypeLocks, archetypeIndex);
+			const std::uint32_t chunkIndex = static_cast<std::uint32_t>(_destination.m_ChunkList.size());
+			// 共有したまま書き換えると複製が起きるので、移し元からは手放させる
+			_destination.m_ChunkList.push_back(std::move(sourceChunk));
+			table.AddChunk(archetypeIndex, chunkIndex);
+
+			Chunk& chunk = _destination.m_ChunkList.back();
+			chunk.SetSectionId(_sectionId);
+			Entity* pEntities = reinterpret_cast<Entity*>(chunk.GetBuffer());
+			for (std::uint32_t row = 0; row < chunk.GetSize(); row++)
+			{
+				const auto [entityIndex, version] = entityManager.m_vRecycleEntityIndices.empty() ?
+					entityManager.CreateNewEntity() : entityManager.CreateRecycleEntity();
+				entityManager.m_EntityDirectory[entityIndex].SetLocation(chunkIndex, row);
+				entityManager.RecordEntityChange(entityIndex);
+
+				const Entity entity(entityIndex, version);
+				_remap.emplace(GetIndex(pEntities[row].m_Identifier), entity);
+				pEntities[row] = entity;
+			}
+			chunk.MarkStructureChanged();
+			entityManager.RecordStructuralEvent(ArchetypeTable::cInvalidIndex, archetypeIndex, pEntities, chunk.GetSize());
+			adoptedChunkIndices.push_back(chunkIndex);
+		}
+
+		//=== 親のハンドルを付け替え、子の一覧を作る。移していない親は無効なハンドルにする
+		for (const std::uint32_t chunkIndex : adoptedChunkIndices)
+		{
+			Chunk& chunk = _destination.m_ChunkList[chunkIndex];
+			if (!chunk.GetArchetype().HasType<Parent>())
+				continue;
+
+			auto parents = chunk.GetComponentList<Parent>();
+			for (std::uint32_t row = 0; row < chunk.GetSize(); row++)
+			{
+				Parent& parent = parents[row];
+				auto it = _remap.find(GetIndex(parent.m_Entity.m_Identifier));
+				if (it == _remap.end() || !sourceDirectory.IsAlive(parent.m_Entity))
+				{
+					parent.m_Entity = Entity(0, EntityDirectory::Record::cReservedVersion);
+					continue;
+				}
+
+				parent.m_Entity = it->second;
+				entityManager.m_Children[GetIndex(it->second.m_Identifier)].push_back(chunk.GetEntity(row));
+				entityManager.m_MaxHierarchyDepth = (std::max)(entityManager.m_MaxHierarchyDepth, parent.m_Depth);
+			}
+		}
+
+		//=== 疎な集合のコンポーネントを複製する
+		for (auto&& [typeId, pSourceSet] : _source.m_SparseSets)
+		{
+			auto& pDestinationSet = _destination.m_SparseSets[typeId];
+			if (!pDestinationSet)
+				pDestinationSet = pSourceSet->CreateEmpty();
+			for (const Entity& entity : pSourceSet->GetEntities())
+			{
+				auto it = _remap.find(GetIndex(entity.m_Identifier));
+				if (it != _remap.end())
+					pSourceSet->CopyEntryTo(GetIndex(entity.m_Identifier), *pDestinationSet, it->second);
+			}
+		}
+
+		return _remap.size();
+	}
+
+	void WorldSection::ClearWorld(World& _world)
+	{
+		StructureWriteScope structureScope(_world.m_ArchetypeLocks);
+		_world.m_ChunkList.clear();
+		_world.m_ArchetypeTable = ArchetypeTable();
+		_world.m_SparseSets.clear();
+		_world.m_StateEpoch++;
+
+		EntityManager& entityManager = *_world.m_pEntityManager;
+		entityManager.m_EntityDirectory.Clear();
+		entityManager.m_vRecycleEntityIndices.clear();
+		entityManager.m_vChangedEntityIndices.clear();
+		entityManager.m_StructuralEvents.Clear();
+		entityManager.m_Children.clear();
+		entityManager.m_MaxHierarchyDepth = 0;
+		entityManager.m_NextEntityIndex.store(0);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "Common/Id.h"
+#include "Entity.h"
+
+namespace ECS
+{
+	class World;
+	class DeltaDecoder;
+
+	/**
+	* @class WorldSection
+	* @brief 別のワールドで作ったエンティティを、チャンクごとワールドに取り込み、切り離すクラス。
+	* @note チャンクのメモリ領域は引き取るだけで、行は複製しない。書き換えるのはEntityの列と
+	*		 Parentの親のハンドルだけ。レベルの区画を作業スレッドの別のワールドで組み立て、
+	*		 メインスレッドで取り込むといった用途に使う。
+	*		 コンポーネントが持つParent以外のエンティティのハンドルは付け替えない。
+	*/
+	class WorldSection
+	{
+		friend DeltaDecoder;
+
+	public:
+		/**
+		* @brief 作業用のワールドの全てのチャンクを取り込みます。作業用のワールドは空になる。
+		* @param _world 取り込み先のワールド。
+		* @param _staging 作業用のワールド。取り込み中は他から触らないこと。
+		* @return SectionId 取り込んだチャンクの識別ID。エンティティがない場合は0。
+		* @note アーキタイプは取り込み先で引き直し、エンティティには取り込み先のインデックスを割り当てる。
+		*		 取り込んだチャンクには新しいエンティティを追加しないので、エンティティが
+		*		 アーキタイプを移ると、そのエンティティはセクションから外れる。
+		*/
+		static SectionId Merge(World& _world, World& _staging);
+
+		/**
+		* @brief セクションのチャンクを切り離し、別のワールドに移します。
+		* @param _world 切り離すワールド。切り離したエンティティは破棄した扱いになる。
+		* @param _sectionId 切り離すセクション。
+		* @param _destination 移し先のワールド。既存のエンティティはそのまま残る。
+		* @return std::size_t 移したエンティティの数。
+		* @note セクション外の親を持つエンティティは、移し先では親のハンドルが無効になる。
+		*		 セクション外に残る子はルートになる。
+		*/
+		static std::size_t Detach(World& _world, const SectionId _sectionId, World& _destination);
+
+	private:
+		/**
+		* @brief チャンクを別のワールドに移し、エンティティに移し先のインデックスを割り当てます。
+		* @param _source 移し元のワールド。移したチャンクはメモリ領域を手放して空になる。
+		* @param _chunkIndices 移すチャンクのインデックス。空のチャンクは飛ばす。
+		* @param _destination 移し先のワールド。
+		* @param _sectionId 移し先のチャンクに設定するセクションの識別ID。
+		* @param _remap 移し元のエンティティのインデックスから移し先のエンティティへの対応を書き込む。
+		* @return std::size_t 移したエンティティの数。
+		*/
+		static std::size_t TransferChunks(World& _source, const std::vector<std::uint32_t>& _chunkIndices,
+			World& _destination, const SectionId _sectionId, std::unordered_map<EntityIndex, Entity>& _remap);
+
+		/**
+		* @brief ワールドのエンティティとチャンクを全て取り除きます。
+		* @note 他のワールドと共有しているチャンクのメモリ領域は、そちらが参照している間は残る。
+		* @param _world 対象のワールド。
+		*/
+		static void ClearWorld(World& _world);
+	};
+}
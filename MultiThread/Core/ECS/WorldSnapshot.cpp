@@ -0,0 +1,401 @@
+#include "WorldSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+#include <Windows.h>
+
+#include "World.h"
+#include "EntityManager.h"
+#include "Chunk.h"
+#include "ComponentRegistry.h"
+#include "Transform.h"
+
+namespace ECS
+{
+	namespace
+	{
+		//! ファイルの識別子("ECSW")。
+		constexpr std::uint32_t cMagic = 0x57534345;
+		//! ファイル形式のバージョン。
+		constexpr std::uint32_t cFormatVersion = 2;
+		//! チャンクデータの配置境界。マップ時の割り当て粒度に合わせる。
+		constexpr std::uint64_t cChunkDataAlignment = 65536;
+
+		/**
+		* @struct SnapshotHeader
+		* @brief ファイル先頭のヘッダ。各セクションの位置と要素数を持つ。
+		*/
+		struct SnapshotHeader
+		{
+			std::uint32_t m_Magic;
+			std::uint32_t m_Version;
+			std::uint32_t m_ChunkCapacity;
+			std::uint32_t m_ArchetypeCount;
+			std::uint32_t m_ChunkCount;
+			std::uint32_t m_EntityCount;
+			std::uint32_t m_RecycleCount;
+			std::uint32_t m_Reserved;
+			std::uint64_t m_ArchetypeOffset;
+			std::uint64_t m_ChunkTableOffset;
+			std::uint64_t m_EntityOffset;
+			std::uint64_t m_RecycleOffset;
+			std::uint64_t m_ChunkDataOffset;
+			std::uint64_t m_FileSize;
+		};
+
+		//! アーキタイプ内の1コンポーネントの情報。
+		struct ComponentRecord
+		{
+			std::uint64_t m_Id;
+			std::uint32_t m_Size;
+			std::uint32_t m_Alignment;
+		};
+
+		//! 1チャンクの情報。
+		struct ChunkRecord
+		{
+			std::uint32_t m_ArchetypeIndex;
+			std::uint32_t m_Size;
+		};
+
+		//! エンティティ配列の1要素。
+		struct EntityRecord
+		{
+			std::uint32_t m_ChunkIndex;
+			std::uint32_t m_ChunkInIndex;
+			std::uint64_t m_Identifier;
+		};
+
+		/**
+		* @struct MappedFile
+		* @brief メモリマップしたファイル。チャンクから共有され、最後の参照で解放される。
+		*/
+		struct MappedFile
+		{
+			~MappedFile()
+			{
+				if (m_pView) UnmapViewOfFile(m_pView);
+				if (m_hMapping) CloseHandle(m_hMapping);
+				if (m_hFile != INVALID_HANDLE_VALUE) CloseHandle(m_hFile);
+			}
+
+			HANDLE m_hFile = INVALID_HANDLE_VALUE;
+			HANDLE m_hMapping = nullptr;
+			std::byte* m_pView = nullptr;
+			std::uint64_t m_Size = 0;
+		};
+
+		/**
+		* @brief 値をそのままストリームに書き込む。
+		*/
+		template <typename T>
+		void Write(std::ofstream& _stream, const T& _value)
+		{
+			_stream.write(reinterpret_cast<const char*>(&_value), sizeof(T));
+		}
+
+		/**
+		* @brief ストリームを指定の境界までゼロで埋める。
+		*/
+		void Pad(std::ofstream& _stream, std::uint64_t _alignment)
+		{
+			const std::uint64_t position = static_cast<std::uint64_t>(_stream.tellp());
+			const std::uint64_t padding = (_alignment - position % _alignment) % _alignment;
+			static const char zero[256] = {};
+			for (std::uint64_t i = 0; i < padding; i += sizeof(zero))
+				_stream.write(zero, static_cast<std::streamsize>((std::min)(padding - i, std::uint64_t(sizeof(zero)))));
+		}
+
+		/**
+		* @brief 範囲がファイル内に収まっているかを判定する。
+		*/
+		bool IsInRange(const MappedFile& _file, std::uint64_t _offset, std::uint64_t _size)
+		{
+			return _offset <= _file.m_Size && _size <= _file.m_Size - _offset;
+		}
+
+		/**
+		* @brief 読み込んだアーキタイプの型が、このプログラムに登録された同じ型IDの型と食い違っていないかを判定する。
+		* @param _archetypes 読み込んだアーキタイプ。
+		* @param _entityCount エンティティ数。階層の深さはこれを超えない。
+		* @note 登録されていない型や、サイズやアライメントが違う型、トリビアルにコピーできない型がある場合は
+		*		 別のプログラムか古いファイルとみなす。階層の深さのタグは型IDを実行時に作るので、
+		*		 いずれかの深さの型IDと一致するかで判定する。
+		*/
+		bool MatchesRegisteredTypes(const std::vector<Archetype>& _archetypes, const std::uint32_t _entityCount)
+		{
+			std::unordered_set<TypeId> depthTags;
+			for (auto&& archetype : _archetypes)
+			{
+				for (std::size_t j = 0; j < archetype.GetArchetypeSize(); j++)
+				{
+					const TypeId id = archetype.GetComponentIdByIndex(j);
+					const std::size_t size = archetype.GetMemorySizeByIndex(j);
+					const std::size_t alignment = archetype.GetAlignmentByIndex(j);
+
+					ComponentRegistry::Entry entry;
+					if (ComponentRegistry::Find(id, entry))
+					{
+						if (entry.m_Size != size || entry.m_Alignment != alignment || !entry.m_bTriviallyCopyable)
+							return false;
+						continue;
+					}
+					if (size != 0 || alignment != 1)
+						return false;
+					depthTags.insert(id);
+				}
+			}
+
+			for (std::uint32_t depth = 1; depth <= _entityCount && !depthTags.empty(); depth++)
+				depthTags.erase(HierarchyDepth::GetTypeId(depth));
+			return depthTags.empty();
+		}
+	}
+
+	bool WorldSnapshot::Save(const World& _world, const std::filesystem::path& _path)
+	{
+		const ArchetypeTable& table = _world.m_ArchetypeTable;
+		const EntityManager& entityManager = *_world.m_pEntityManager;
+
+		// コンポーネントはメモリの内容をそのまま書き出すので、トリビアルにコピー可能である必要がある
+		for (std::size_t i = 0; i < table.GetArchetypeCount(); i++)
+		{
+			if (!table.GetArchetype(static_cast<ArchetypeTable::ArchetypeIndex>(i)).IsTriviallyCopyable())
+				return false;
+		}
+
+		// 疎な集合は書き出さないので、要素がある場合は保存すると失われる
+		for (auto&& [typeId, pSet] : _world.m_SparseSets)
+		{
+			if (pSet->GetSize() != 0)
+				return false;
+		}
+
+		std::ofstream stream(_path, std::ios::binary | std::ios::trunc);
+		if (!stream)
+			return false;
+
+		SnapshotHeader header = {};
+		header.m_Magic = cMagic;
+		header.m_Version = cFormatVersion;
+		header.m_ChunkCapacity = Chunk::GetCapacity();
+		header.m_ArchetypeCount = static_cast<std::uint32_t>(table.GetArchetypeCount());
+		header.m_ChunkCount = static_cast<std::uint32_t>(_world.m_ChunkList.size());
+		header.m_EntityCount = static_cast<std::uint32_t>(entityManager.m_EntityDirectory.GetSize());
+		header.m_RecycleCount = static_cast<std::uint32_t>(entityManager.m_vRecycleEntityIndices.size());
+		Write(stream, header);
+
+		//=== アーキタイプ
+		header.m_ArchetypeOffset = static_cast<std::uint64_t>(stream.tellp());
+		for (std::size_t i = 0; i < table.GetArchetypeCount(); i++)
+		{
+			const Archetype& archetype = table.GetArchetype(static_cast<ArchetypeTable::ArchetypeIndex>(i));
+			Write(stream, static_cast<std::uint64_t>(archetype.GetArchetypeSize()));
+			for (std::size_t j = 0; j < archetype.GetArchetypeSize(); j++)
+			{
+				Write(stream, ComponentRecord{ archetype.GetComponentIdByIndex(j),
+					static_cast<std::uint32_t>(archetype.GetMemorySizeByIndex(j)),
+					static_cast<std::uint32_t>(archetype.GetAlignmentByIndex(j)) });
+			}
+		}
+
+		//=== チャンクの情報
+		header.m_ChunkTableOffset = static_cast<std::uint64_t>(stream.tellp());
+		for (std::size_t i = 0; i < _world.m_ChunkList.size(); i++)
+		{
+			Write(stream, ChunkRecord{
+				table.GetArchetypeIndexOfChunk(static_cast<std::uint32_t>(i)), _world.m_ChunkList[i].GetSize() });
+		}
+
+		//=== エンティティ配列
+		header.m_EntityOffset = static_cast<std::uint64_t>(stream.tellp());
+		for (EntityIndex i = 0; i < entityManager.m_EntityDirectory.GetSize(); i++)
+		{
+			const auto& record = entityManager.m_EntityDirectory[i];
+			Write(stream, EntityRecord{ record.GetChunkIndex(), record.GetChunkInIndex(),
+				entityManager.m_EntityDirectory.GetEntity(i).m_Identifier });
+		}
+
+		header.m_RecycleOffset = static_cast<std::uint64_t>(stream.tellp());
+		for (auto&& index : entityManager.m_vRecycleEntityIndices)
+		{
+			Write(stream, index);
+		}
+
+		//=== チャンクの内容をそのまま書き出す。圧縮中のチャンクは作業領域に展開して書き出し、圧縮したまま残す
+		Pad(stream, cChunkDataAlignment);
+		header.m_ChunkDataOffset = static_cast<std::uint64_t>(stream.tellp());
+		std::unique_ptr<std::byte[]> pScratch;
+		for (auto&& chunk : _world.m_ChunkList)
+		{
+			if (chunk.IsCompressed() && !pScratch)
+				pScratch = std::make_unique<std::byte[]>(Chunk::GetCapacity());
+			stream.write(reinterpret_cast<const char*>(chunk.PeekBuffer(pScratch.get())), Chunk::GetCapacity());
+		}
+		header.m_FileSize = static_cast<std::uint64_t>(stream.tellp());
+
+		stream.seekp(0);
+		Write(stream, header);
+		return static_cast<bool>(stream);
+	}
+
+	bool WorldSnapshot::Load(World& _world, const std::filesystem::path& _path)
+	{
+		//=== ファイルをコピーオンライトでマップする
+		auto pFile = std::make_shared<MappedFile>();
+		pFile->m_hFile = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (pFile->m_hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(pFile->m_hFile, &fileSize) || fileSize.QuadPart < sizeof(SnapshotHeader))
+			return false;
+		pFile->m_Size = static_cast<std::uint64_t>(fileSize.QuadPart);
+
+		pFile->m_hMapping = CreateFileMappingW(pFile->m_hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (!pFile->m_hMapping)
+			return false;
+		pFile->m_pView = static_cast<std::byte*>(MapViewOfFile(pFile->m_hMapping, FILE_MAP_COPY, 0, 0, 0));
+		if (!pFile->m_pView)
+			return false;
+
+		//=== ヘッダの検証
+		SnapshotHeader header;
+		std::memcpy(&header, pFile->m_pView, sizeof(header));
+		if (header.m_Magic != cMagic || header.m_Version != cFormatVersion ||
+			header.m_ChunkCapacity != Chunk::GetCapacity() || header.m_FileSize != pFile->m_Size ||
+			!IsInRange(*pFile, header.m_ChunkTableOffset, std::uint64_t(header.m_ChunkCount) * sizeof(ChunkRecord)) ||
+			!IsInRange(*pFile, header.m_EntityOffset, std::uint64_t(header.m_EntityCount) * sizeof(EntityRecord)) ||
+			!IsInRange(*pFile, header.m_RecycleOffset, std::uint64_t(header.m_RecycleCount) * sizeof(std::uint32_t)) ||
+			!IsInRange(*pFile, header.m_ChunkDataOffset, std::uint64_t(header.m_ChunkCount) * Chunk::GetCapacity()) ||
+			header.m_ChunkDataOffset % cChunkDataAlignment != 0)
+			return false;
+
+		//=== アーキタイプの復元
+		std::vector<Archetype> archetypes;
+		archetypes.reserve(header.m_ArchetypeCount);
+		std::uint64_t offset = header.m_ArchetypeOffset;
+		for (std::uint32_t i = 0; i < header.m_ArchetypeCount; i++)
+		{
+			std::uint64_t componentCount = 0;
+			if (!IsInRange(*pFile, offset, sizeof(componentCount)))
+				return false;
+			std::memcpy(&componentCount, pFile->m_pView + offset, sizeof(componentCount));
+			offset += sizeof(componentCount);
+
+			if (componentCount > cMaxComponentSize ||
+				!IsInRange(*pFile, offset, componentCount * sizeof(ComponentRecord)))
+				return false;
+
+			Archetype archetype;
+			for (std::uint64_t j = 0; j < componentCount; j++)
+			{
+				ComponentRecord record;
+				std::memcpy(&record, pFile->m_pView + offset, sizeof(record));
+				offset += sizeof(record);
+				if (!Archetype::IsValidAlignment(record.m_Alignment))
+					return false;
+				archetype.AddType(record.m_Id, record.m_Size, record.m_Alignment);
+			}
+			archetypes.push_back(archetype);
+		}
+
+		const ChunkRecord* pChunkRecords =
+			reinterpret_cast<const ChunkRecord*>(pFile->m_pView + header.m_ChunkTableOffset);
+		// チャンクのインデックスと行は管理情報のビット幅に収まる必要がある
+		if (header.m_ChunkCount > (std::uint64_t(1) << EntityDirectory::Record::cChunkIndexBits))
+			return false;
+		for (std::uint32_t i = 0; i < header.m_ChunkCount; i++)
+		{
+			if (pChunkRecords[i].m_ArchetypeIndex >= archetypes.size() ||
+				pChunkRecords[i].m_Size > Chunk::CalculateMaxSize(archetypes[pChunkRecords[i].m_ArchetypeIndex]) ||
+				pChunkRecords[i].m_Size > (std::uint32_t(1) << EntityDirectory::Record::cChunkInIndexBits))
+				return false;
+		}
+		if (!MatchesRegisteredTypes(archetypes, header.m_EntityCount))
+			return false;
+
+		//=== エンティティ配列の検証。再利用待ちと予約済み以外は、指す行に同じハンドルが入っている必要がある
+		const EntityRecord* pEntityRecords =
+			reinterpret_cast<const EntityRecord*>(pFile->m_pView + header.m_EntityOffset);
+		const std::uint32_t* pRecycleIndices =
+			reinterpret_cast<const std::uint32_t*>(pFile->m_pView + header.m_RecycleOffset);
+		std::vector<bool> recycled(header.m_EntityCount, false);
+		for (std::uint32_t i = 0; i < header.m_RecycleCount; i++)
+		{
+			if (pRecycleIndices[i] >= header.m_EntityCount || recycled[pRecycleIndices[i]])
+				return false;
+			recycled[pRecycleIndices[i]] = true;
+		}
+		std::byte* pChunkData = pFile->m_pView + header.m_ChunkDataOffset;
+		for (std::uint32_t i = 0; i < header.m_EntityCount; i++)
+		{
+			const EntityRecord& record = pEntityRecords[i];
+			// 再利用待ちや予約済みの要素も位置はそのまま管理情報に入れるので、ビット幅を確かめる
+			if (record.m_ChunkIndex >= (std::uint32_t(1) << EntityDirectory::Record::cChunkIndexBits) ||
+				record.m_ChunkInIndex >= (std::uint32_t(1) << EntityDirectory::Record::cChunkInIndexBits))
+				return false;
+			if (recycled[i] || GetVersion(record.m_Identifier) >= EntityDirectory::Record::cReservedVersion)
+				continue;
+			if (GetIndex(record.m_Identifier) != i ||
+				record.m_ChunkIndex >= header.m_ChunkCount || record.m_ChunkInIndex >= pChunkRecords[record.m_ChunkIndex].m_Size)
+				return false;
+
+			const Entity& stored = reinterpret_cast<const Entity*>(
+				pChunkData + std::uint64_t(record.m_ChunkIndex) * Chunk::GetCapacity())[record.m_ChunkInIndex];
+			if (stored.m_Identifier != record.m_Identifier)
+				return false;
+		}
+
+		//=== ここから先は失敗しないので、既存のワールドを置き換える
+		_world.m_ChunkList.clear();
+		_world.m_ArchetypeTable = ArchetypeTable();
+		_world.m_StateEpoch++;
+		// 疎な集合は保存されていないので、残すと読み込んだ別のエンティティに付いてしまう
+		for (auto&& [typeId, pSet] : _world.m_SparseSets)
+			pSet->Clear();
+		std::vector<ArchetypeTable::ArchetypeIndex> archetypeIndices;
+		archetypeIndices.reserve(archetypes.size());
+		for (auto&& archetype : archetypes)
+		{
+			archetypeIndices.push_back(_world.m_ArchetypeTable.GetOrCreateArchetype(archetype));
+		}
+
+		// チャンクのメモリ領域はマップした領域をそのまま引き取る
+		for (std::uint32_t i = 0; i < header.m_ChunkCount; i++)
+		{
+			const ChunkRecord& record = pChunkRecords[i];
+			std::shared_ptr<std::byte[]> pBuffer(pFile, pChunkData + std::uint64_t(i) * Chunk::GetCapacity());
+			_world.m_ChunkList.push_back(Chunk(archetypes[record.m_ArchetypeIndex], std::move(pBuffer), record.m_Size));
+			_world.m_ArchetypeTable.AddChunk(archetypeIndices[record.m_ArchetypeIndex], i);
+		}
+
+		EntityManager& entityManager = *_world.m_pEntityManager;
+		EntityDirectory& entities = entityManager.m_EntityDirectory;
+		entities.Clear();
+		entities.Grow(header.m_EntityCount, EntityDirectory::Record());
+		for (std::uint32_t i = 0; i < header.m_EntityCount; i++)
+		{
+			// 予約済みの要素は以前の形式では全ビットが立っているので、管理情報の予約用の値に丸める
+			entities[i] = EntityDirectory::Record(pEntityRecords[i].m_ChunkIndex, pEntityRecords[i].m_ChunkInIndex,
+				(std::min)(GetVersion(pEntityRecords[i].m_Identifier), EntityDirectory::Record::cReservedVersion));
+		}
+
+		entityManager.m_vRecycleEntityIndices.assign(pRecycleIndices, pRecycleIndices + header.m_RecycleCount);
+		entityManager.m_NextEntityIndex.store(header.m_EntityCount);
+
+		// 記録はアーキタイプのインデックスで引くので、置き換えた後は使えない
+		entityManager.m_StructuralEvents.Clear();
+
+		// 子の一覧と階層の深さは保存しないので、Parentから作り直す
+		entityManager.RebuildHierarchy();
+
+		return true;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+
+namespace ECS
+{
+	class World;
+
+	/**
+	* @class WorldSnapshot
+	* @brief ワールドをチャンク単位のバイナリ形式で保存、復元するクラス。
+	* @note チャンクの内容はそのまま書き出し、読み込み時はファイルをメモリマップして
+	*		 チャンクのメモリ領域として直接引き取る。コピーするのはエンティティ配列などの
+	*		 管理情報のみ。コンポーネントの識別には実行ごとに変わらない型IDを使う。
+	*/
+	class WorldSnapshot
+	{
+	public:
+		/**
+		* @brief ワールドをファイルに保存します。
+		* @param _world 保存するワールド。
+		* @param _path 保存先のファイルパス。
+		* @return bool 成功した場合はtrue。トリビアルにコピーできないコンポーネントを含む場合と、
+		*		  疎な集合に格納するコンポーネントを持つエンティティがある場合はfalse。
+		*/
+		static bool Save(const World& _world, const std::filesystem::path& _path);
+
+		/**
+		* @brief ファイルからワールドを復元します。既存のエンティティとチャンクは破棄される。
+		* @param _world 復元先のワールド。
+		* @param _path 読み込むファイルパス。
+		* @return bool 成功した場合はtrue。ファイルが壊れている場合や、ワールドで使われている型と
+		*		 サイズが食い違う場合はfalseで、ワールドは変えない。
+		* @note マップはコピーオンライト。チャンクへの書き込みはファイルに反映されず、
+		*		 書き込まれたページだけが複製される。
+		*/
+		static bool Load(World& _world, const std::filesystem::path& _path);
+	};
+}
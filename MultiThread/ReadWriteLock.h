@@ -5,11 +5,11 @@
 
 /**
  * @class ReadWriteLock
- * @brief ǂݎƏ݃ANZX𓯊邽߂̃bN@\񋟂܂B
+ * @brief 読み取りと書き込みアクセスを同期するためのロック機構を提供します。
  *
- * ̃NX́A̓ǂݎANZXɍs邱ƂȂA
- * ݃ANZXrIɍs邱Ƃۏ؂܂BɂA
- * ǂݎANZX݃ANZXȂViIł̐\サ܂B
+ * このクラスは、複数の読み取りアクセスが同時に行われることを許可しながら、
+ * 書き込みアクセスが排他的に行われることを保証します。これにより、
+ * 読み取りアクセスが多いが書き込みアクセスが少ないシナリオでの性能が向上します。
  */
 class ReadWriteLock {
 public:
@@ -17,10 +17,10 @@ public:
         : m_RefCount(0), m_bExistsWriter(false) {}
 
     /**
-     * @brief ǂݎANZXp̃bN擾܂B
+     * @brief 読み取りアクセス用のロックを取得します。
      *
-     * ̃XbhݒłȂꍇɂ̂݁AǂݎANZX܂B
-     * ݃Xbh݂ꍇÃXbhbN܂őҋ@܂B
+     * 他のスレッドが書き込み中でない場合にのみ、読み取りアクセスを許可します。
+     * 書き込みスレッドが存在する場合、そのスレッドがロックを解放するまで待機します。
      */
     void LockRead() {
         std::unique_lock<std::mutex> lock(m_Mutex);
@@ -30,10 +30,10 @@ public:
     }
 
     /**
-     * @brief ǂݎANZXp̃bN܂B
+     * @brief 読み取りアクセス用のロックを解放します。
      *
-     * ǂݎJE^fNgȀݑ҂XbhꍇA
-     * ̈N܂B
+     * 読み取りカウンタをデクリメントし、他の書き込み待ちスレッドがある場合、
+     * その一つを起こします。
      */
     void UnlockRead() {
         std::unique_lock<std::mutex> lock(m_Mutex);
@@ -43,10 +43,10 @@ public:
     }
 
     /**
-     * @brief ݃ANZXp̃bN擾܂B
+     * @brief 書き込みアクセス用のロックを取得します。
      *
-     * ̃Xbh݂܂͓ǂݎ蒆łȂꍇɂ̂݁A݃ANZX܂B
-     * ̏ȂꍇA܂őҋ@܂B
+     * 他のスレッドが書き込みまたは読み取り中でない場合にのみ、書き込みアクセスを許可します。
+     * これらの条件が満たされない場合、条件が満たされるまで待機します。
      */
     void LockWrite() {
         std::unique_lock<std::mutex> lock(m_Mutex);
@@ -56,24 +56,24 @@ public:
     }
 
     /**
-     * @brief ݃ANZXp̃bN܂B
+     * @brief 書き込みアクセス用のロックを解放します。
      *
-     * ݃tOZbgAҋ@݂̏܂͓ǂݎXbhN܂B
+     * 書き込みフラグをリセットし、待機中の書き込みまたは読み取りスレッドを起こします。
      */
     void UnlockWrite() {
         std::unique_lock<std::mutex> lock(m_Mutex);
         m_bExistsWriter = false;
 
-        // ݑ҂̃Xbh΁AN܂B
+        // 書き込み待ちのスレッドがあれば、一つだけを起こします。
         m_WriteCondition.notify_one();
-        // ǂݎ҂̃Xbh΁ASĂN܂B
+        // 読み取り待ちのスレッドがあれば、全てを起こします。
         m_ReadCondition.notify_all();
     }
 
 private:
-    std::mutex m_Mutex;  ///< bNԂ̓邽߂̃~[ebNXB
-    std::condition_variable m_ReadCondition;  ///< ǂݎXbh̑ҋ@ϐB
-    std::condition_variable m_WriteCondition; ///< ݃Xbh̑ҋ@ϐB
-    int m_RefCount;  ///< ݂̓ǂݎXbh̐B
-    bool m_bExistsWriter;  ///< ݏ݂sĂXbh݂邩ǂB
+    std::mutex m_Mutex;  ///< ロック状態の同期を取るためのミューテックス。
+    std::condition_variable m_ReadCondition;  ///< 読み取りスレッドの待機条件変数。
+    std::condition_variable m_WriteCondition; ///< 書き込みスレッドの待機条件変数。
+    int m_RefCount;  ///< 現在の読み取りスレッドの数。
+    bool m_bExistsWriter;  ///< 現在書き込みを行っているスレッドが存在するかどうか。
 };
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @class ScalableReadWriteLock
+ * @brief 読み取りが多い場面向けの、ミューテックスを使わない読み書きロック。
+ *
+ * 読み取り側はスレッドごとに割り当てたスロット(キャッシュライン単位)のカウンタを増やすだけなので、
+ * 読み取り同士は同じキャッシュラインを取り合わない。書き込み側はフラグを立ててから
+ * 全スロットのカウンタが0になるのを待つ。書き込みフラグが立っている間は新しい読み取りが
+ * 後退するので、書き込みは飢餓状態にならない。
+ * 待ちは短いスピンの後にyieldするので、長時間保持する用途には向かない。
+ * 再入はできない。
+ */
+class ScalableReadWriteLock {
+public:
+    /**
+     * @struct Statistics
+     * @brief 取得回数と競合の統計。
+     */
+    struct Statistics {
+        std::uint64_t m_ReadCount = 0;            ///< 読み取りロックの取得回数。
+        std::uint64_t m_ReadContendedCount = 0;   ///< 読み取りロックで待ちが発生した回数。
+        std::uint64_t m_WriteCount = 0;           ///< 書き込みロックの取得回数。
+        std::uint64_t m_WriteContendedCount = 0;  ///< 書き込みロックで待ちが発生した回数。
+        std::uint64_t m_WaitNanoseconds = 0;      ///< 待ちに費やした時間の合計[ns]。
+
+        /**
+         * @brief 統計を加算します。
+         */
+        Statistics& operator+=(const Statistics& _other) noexcept {
+            m_ReadCount += _other.m_ReadCount;
+            m_ReadContendedCount += _other.m_ReadContendedCount;
+            m_WriteCount += _other.m_WriteCount;
+            m_WriteContendedCount += _other.m_WriteContendedCount;
+            m_WaitNanoseconds += _other.m_WaitNanoseconds;
+            return *this;
+        }
+    };
+
+    ScalableReadWriteLock() = default;
+    ScalableReadWriteLock(const ScalableReadWriteLock&) = delete;
+    ScalableReadWriteLock& operator=(const ScalableReadWriteLock&) = delete;
+
+    /**
+     * @brief 読み取りアクセス用のロックを取得します。書き込み中であれば解放まで待機します。
+     */
+    void LockRead() {
+        Slot& slot = m_Slots[GetSlotIndex()];
+        slot.m_ReadCount.fetch_add(1, std::memory_order_relaxed);
+
+        std::chrono::steady_clock::time_point waitStart;
+        bool bContended = false;
+        while (true) {
+            // カウンタを増やしてから書き込みフラグを見る。書き込み側は逆の順で見るので、どちらかが必ず気付く
+            slot.m_ReaderCount.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_bWriter.load(std::memory_order_seq_cst)) {
+                break;
+            }
+            slot.m_ReaderCount.fetch_sub(1, std::memory_order_release);
+
+            if (!bContended) {
+                bContended = true;
+                waitStart = std::chrono::steady_clock::now();
+            }
+            for (std::uint32_t spin = 0; m_bWriter.load(std::memory_order_relaxed); spin++) {
+                Backoff(spin);
+            }
+        }
+
+        if (bContended) {
+            slot.m_ReadContendedCount.fetch_add(1, std::memory_order_relaxed);
+            AddWaitTime(waitStart);
+        }
+    }
+
+    /**
+     * @brief 読み取りアクセス用のロックを解放します。取得したスレッドから呼ぶ必要があります。
+     */
+    void UnlockRead() {
+        m_Slots[GetSlotIndex()].m_ReaderCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief 書き込みアクセス用のロックを取得します。他の書き込みと全ての読み取りが終わるまで待機します。
+     */
+    void LockWrite() {
+        std::chrono::steady_clock::time_point waitStart;
+        bool bContended = false;
+
+        bool bExpected = false;
+        for (std::uint32_t spin = 0;
+            !m_bWriter.compare_exchange_weak(bExpected, true, std::memory_order_seq_cst); spin++) {
+            bExpected = false;
+            if (!bContended) {
+                bContended = true;
+                waitStart = std::chrono::steady_clock::now();
+            }
+            Backoff(spin);
+        }
+
+        for (auto& slot : m_Slots) {
+            for (std::uint32_t spin = 0; slot.m_ReaderCount.load(std::memory_order_seq_cst) != 0; spin++) {
+                if (!bContended) {
+                    bContended = true;
+                    waitStart = std::chrono::steady_clock::now();
+                }
+                Backoff(spin);
+            }
+        }
+
+        m_WriteCount.fetch_add(1, std::memory_order_relaxed);
+        if (bContended) {
+            m_WriteContendedCount.fetch_add(1, std::memory_order_relaxed);
+            AddWaitTime(waitStart);
+        }
+    }
+
+    /**
+     * @brief 書き込みアクセス用のロックを解放します。
+     */
+    void UnlockWrite() {
+        m_bWriter.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief 統計を取得します。
+     * @return Statistics 取得回数と競合の統計。他のスレッドが更新中でも取得できるが、値は概算になる。
+     */
+    Statistics GetStatistics() const {
+        Statistics result;
+        for (auto& slot : m_Slots) {
+            result.m_ReadCount += slot.m_ReadCount.load(std::memory_order_relaxed);
+            result.m_ReadContendedCount += slot.m_ReadContendedCount.load(std::memory_order_relaxed);
+        }
+        result.m_WriteCount = m_WriteCount.load(std::memory_order_relaxed);
+        result.m_WriteContendedCount = m_WriteContendedCount.load(std::memory_order_relaxed);
+        result.m_WaitNanoseconds = m_WaitNanoseconds.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    /**
+     * @brief 統計を0に戻します。
+     */
+    void ResetStatistics() {
+        for (auto& slot : m_Slots) {
+            slot.m_ReadCount.store(0, std::memory_order_relaxed);
+            slot.m_ReadContendedCount.store(0, std::memory_order_relaxed);
+        }
+        m_WriteCount.store(0, std::memory_order_relaxed);
+        m_WriteContendedCount.store(0, std::memory_order_relaxed);
+        m_WaitNanoseconds.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t cSlotCount = 16;  ///< 読み取りカウンタのスロット数。
+
+    /**
+     * @struct Slot
+     * @brief 読み取りカウンタのスロット。他のスロットとキャッシュラインを共有しない。
+     */
+    struct alignas(64) Slot {
+        std::atomic<std::int32_t> m_ReaderCount = 0;         ///< 読み取り中の数。
+        std::atomic<std::uint64_t> m_ReadCount = 0;          ///< 読み取りロックの取得回数。
+        std::atomic<std::uint64_t> m_ReadContendedCount = 0; ///< 読み取りロックで待ちが発生した回数。
+    };
+
+    /**
+     * @brief 現在のスレッドのスロットのインデックスを取得します。スレッドの初回呼び出し時に順に割り当てる。
+     */
+    static std::size_t GetSlotIndex() {
+        static std::atomic<std::size_t> s_NextSlotIndex = 0;
+        thread_local const std::size_t slotIndex =
+            s_NextSlotIndex.fetch_add(1, std::memory_order_relaxed) % cSlotCount;
+        return slotIndex;
+    }
+
+    /**
+     * @brief 待機中のスピンを行います。しばらく回っても解放されなければ他のスレッドに譲る。
+     */
+    static void Backoff(const std::uint32_t _spin) {
+        if (_spin >= 64) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief 待ち時間を統計に加えます。
+     */
+    void AddWaitTime(const std::chrono::steady_clock::time_point& _waitStart) {
+        const auto waitTime = std::chrono::steady_clock::now() - _waitStart;
+        m_WaitNanoseconds.fetch_add(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime).count()), std::memory_order_relaxed);
+    }
+
+private:
+    Slot m_Slots[cSlotCount];                                   ///< 読み取りカウンタのスロット。
+    alignas(64) std::atomic<bool> m_bWriter = false;            ///< 書き込み中、または書き込み待ちかどうか。
+    std::atomic<std::uint64_t> m_WriteCount = 0;                ///< 書き込みロックの取得回数。
+    std::atomic<std::uint64_t> m_WriteContendedCount = 0;       ///< 書き込みロックで待ちが発生した回数。
+    std::atomic<std::uint64_t> m_WaitNanoseconds = 0;           ///< 待ちに費やした時間の合計[ns]。
+};
@@ -11,15 +11,15 @@ constexpr std::size_t TEST_NUM = 1000000;
 int main(void) {
     Profiler m_Profiler;
     
-    // CS݌v
+    // CS設計
     {
-        //=== 
+        //=== 初期化
         std::vector<CS::GameObject> vCSObjects;
         vCSObjects.reserve(TEST_NUM);
         for (std::size_t i = 0; i < TEST_NUM; i++) {
-            // IuWFNgǉ
+            // オブジェクト追加
             vCSObjects.emplace_back();
-            // R|[lgǉ
+            // コンポーネント追加
             vCSObjects.back().AddComponent<CS::Test::TestComponent0>();
             vCSObjects.back().AddComponent<CS::Test::TestComponent1>();
             vCSObjects.back().AddComponent<CS::Test::TestComponent2>();
@@ -33,42 +33,43 @@ int main(void) {
             vCSObjects.back().AddComponent<CS::Test::TestComponent10>();
         }
 
-        //=== v
-        std::cout << "y{IȃR|[lgwz\n";
+        //=== 処理計測
+        std::cout << "【基本的なコンポーネント指向】\n";
 
         for (int i = 0; i < 5; i++)
         {
-            m_Profiler.ProfileStart(); // vJn
+            m_Profiler.ProfileStart(); // 計測開始
             for (auto&& obj : vCSObjects)
             {
                 obj.Update();
             }
-            m_Profiler.OutputElapsedTime(); // oߎԏo
+            m_Profiler.OutputElapsedTime(); // 経過時間出力
         }
     }
 
-    //=== ECS݌v
+    //=== ECS設計
     {
-        //=== 
+        //=== 初期化
         using namespace ECS;
         World world;
         auto manager = world.GetEntityManager();
-        Archetype archetype;
-        archetype.AddType<Test::Component0>();
-        archetype.AddType<Test::Component1>();
-        archetype.AddType<Test::Component2>();
-        archetype.AddType<Test::Component3>();
-        archetype.AddType<Test::Component4>();
-        archetype.AddType<Test::Component5>();
-        archetype.AddType<Test::Component6>();
-        archetype.AddType<Test::Component7>();
-        archetype.AddType<Test::Component8>();
-        archetype.AddType<Test::Component9>();
-        archetype.AddType<Test::Component10>();
+        // 型リストが固定なのでコンパイル時に構築する
+        constexpr Archetype archetype = Archetype::Create<
+            Test::Component0,
+            Test::Component1,
+            Test::Component2,
+            Test::Component3,
+            Test::Component4,
+            Test::Component5,
+            Test::Component6,
+            Test::Component7,
+            Test::Component8,
+            Test::Component9,
+            Test::Component10>();
         for (std::size_t i = 0; i < TEST_NUM; i++) {
-            // IuWFNgǉ
+            // オブジェクト追加
             auto entity = manager->CreateEntity(archetype);
-            // 
+            // 初期化
             manager->SetComponent(entity, Test::Component0());
             manager->SetComponent(entity, Test::Component1());
             manager->SetComponent(entity, Test::Component2());
@@ -84,14 +85,14 @@ int main(void) {
 
         world.AddSystem<Test::TestSystem>(0);
 
-        //=== v
-        std::cout << "y`N^ECS݌vz        \n";
+        //=== 処理計測
+        std::cout << "【チャンク型ECS設計】        \n";
 
         for (int i = 0; i < 5; i++)
         {
-            m_Profiler.ProfileStart(); // vJn
+            m_Profiler.ProfileStart(); // 計測開始
             world.Update(NULL);
-            m_Profiler.OutputElapsedTime(); // oߎԏo
+            m_Profiler.OutputElapsedTime(); // 経過時間出力
         }
     }
 